@@ -0,0 +1,51 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Animation
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+
+namespace cheesemap
+{
+
+struct Animation
+{
+	TileIdType id{ 0u }; // tiles that use this (texture atlas) id are animated
+	struct Frame
+	{
+		TileIdType id{ 0u }; // the texture atlas id that is shown during this frame
+		float duration{ 1.f }; // in the same units as Map::animate's time step
+	};
+	std::vector<Frame> frames{};
+};
+
+} // namespace cheesemap
@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Atlas Packer
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+#include "Map.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+namespace cheesemap
+{
+
+// packs images into atlas images (texture pages) and gives the rectangle of each image so they can be used as a map's texture atlas.
+// each image's id is its index in the list of images so ids don't change when other images change size. images are packed with a skyline (largest first) and start a new page when they don't fit on any page.
+// each image's edge pixels are extruded around it (and images are separated by padding) so that filtering and rounding sample the image's own edge instead of its neighbours (without using texInset)
+class AtlasPacker
+{
+public:
+	AtlasPacker();
+
+	void setMaxPageSize(sf::Vector2u maxPageSize); // pages are only as large as their content requires up to this size (which should be no larger than sf::Texture::getMaximumSize()). default is 4096 x 4096
+	void setExtrusion(unsigned int extrusion); // the number of times each image's edge pixels are repeated around it. default is 1
+	void setPadding(unsigned int padding); // the number of transparent pixels between extruded images. default is 1
+	void setNumberOfThreads(std::size_t numberOfThreads); // images are copied into their pages on this many threads (0 uses the number of hardware threads). default is 1
+
+	// packs the images (replacing any previous pack). throws Exception if an image (with its extrusion) is larger than a page
+	void pack(const std::vector<sf::Image>& images);
+	void pack(const std::vector<const sf::Image*>& images);
+
+	const std::vector<sf::Image>& getPages() const; // the texture of each texture page
+	const std::vector<sf::FloatRect>& getTextureAtlas() const; // the rectangle of each image (within its page)
+	const std::vector<std::size_t>& getTextureAtlasPages() const; // the texture page of each image
+
+	// these complete any asynchronous update that is being built first. each page's texture must then be set on the map (with Map::setTexture) as the texture page given for it
+	void apply(Map& map) const; // replaces the map's texture atlas (and its texture pages) so that each image's id is its index. each page is its own texture page (page p is texture page p)
+	void apply(Map& map, std::size_t firstId, std::size_t firstPage) const; // sets the map's texture atlas (and its texture pages) from firstId, leaving its other rectangles unchanged. each image's id is firstId plus its index and page p is texture page firstPage + p
+
+private:
+	struct SkylineNode
+	{
+		unsigned int x{ 0u };
+		unsigned int y{ 0u };
+		unsigned int width{ 0u };
+	};
+	struct Page
+	{
+		std::vector<SkylineNode> skyline{};
+		sf::Vector2u size{ 0u, 0u }; // the extent of its images (including their extrusion)
+	};
+
+	sf::Vector2u m_maxPageSize;
+	unsigned int m_extrusion;
+	unsigned int m_padding;
+	std::size_t m_numberOfThreads;
+	std::vector<sf::Image> m_pages;
+	std::vector<sf::FloatRect> m_textureAtlas;
+	std::vector<std::size_t> m_textureAtlasPages;
+
+	bool priv_place(Page& page, sf::Vector2u slotSize, sf::Vector2u& position) const;
+	void priv_copy(const sf::Image& image, sf::Vector2u position, sf::Vector2u pageSize, std::uint8_t* pagePixels) const;
+};
+
+} // namespace cheesemap
+#include "AtlasPacker.inl"
@@ -0,0 +1,269 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Atlas Packer
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AtlasPacker.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace cheesemap
+{
+
+inline AtlasPacker::AtlasPacker()
+	: m_maxPageSize{ 4096u, 4096u }
+	, m_extrusion{ 1u }
+	, m_padding{ 1u }
+	, m_numberOfThreads{ 1u }
+	, m_pages{}
+	, m_textureAtlas{}
+	, m_textureAtlasPages{}
+{
+
+}
+
+inline void AtlasPacker::setMaxPageSize(const sf::Vector2u maxPageSize)
+{
+	m_maxPageSize = maxPageSize;
+}
+
+inline void AtlasPacker::setExtrusion(const unsigned int extrusion)
+{
+	m_extrusion = extrusion;
+}
+
+inline void AtlasPacker::setPadding(const unsigned int padding)
+{
+	m_padding = padding;
+}
+
+inline void AtlasPacker::setNumberOfThreads(std::size_t numberOfThreads)
+{
+	if (numberOfThreads == 0u)
+		numberOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	m_numberOfThreads = numberOfThreads;
+}
+
+inline void AtlasPacker::pack(const std::vector<sf::Image>& images)
+{
+	std::vector<const sf::Image*> imagePointers(images.size());
+	for (std::size_t i{ 0u }, numberOfImages{ images.size() }; i < numberOfImages; ++i)
+		imagePointers[i] = &images[i];
+	pack(imagePointers);
+}
+
+inline void AtlasPacker::pack(const std::vector<const sf::Image*>& images)
+{
+	// every image is placed before any pixels are copied so that each page's pixels are allocated once. empty images are given an empty rectangle on page 0
+	const std::size_t numberOfImages{ images.size() };
+	std::vector<sf::FloatRect> textureAtlas(numberOfImages);
+	std::vector<std::size_t> textureAtlasPages(numberOfImages, 0u);
+	std::vector<sf::Vector2u> positions(numberOfImages);
+
+	std::vector<std::size_t> order{};
+	for (std::size_t i{ 0u }; i < numberOfImages; ++i)
+	{
+		if ((images[i] != nullptr) && (images[i]->getSize().x > 0u) && (images[i]->getSize().y > 0u))
+			order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](const std::size_t lhs, const std::size_t rhs)
+		{ return (images[lhs]->getSize().y > images[rhs]->getSize().y) || ((images[lhs]->getSize().y == images[rhs]->getSize().y) && (images[lhs]->getSize().x > images[rhs]->getSize().x)); });
+
+	std::vector<Page> pages{};
+	const unsigned int border{ (m_extrusion * 2u) + m_padding };
+	for (const std::size_t i : order)
+	{
+		const sf::Vector2u size{ images[i]->getSize() };
+		if ((size.x + (m_extrusion * 2u) > m_maxPageSize.x) || (size.y + (m_extrusion * 2u) > m_maxPageSize.y))
+			throw Exception("Image is too large for an atlas page: " + std::to_string(i));
+
+		const sf::Vector2u slotSize{ size.x + border, size.y + border };
+		sf::Vector2u position{ 0u, 0u };
+		std::size_t p{ 0u };
+		while ((p < pages.size()) && !priv_place(pages[p], slotSize, position))
+			++p;
+		if (p == pages.size())
+		{
+			pages.emplace_back();
+			pages.back().skyline.push_back({ 0u, 0u, m_maxPageSize.x + m_padding });
+			priv_place(pages.back(), slotSize, position);
+		}
+		positions[i] = position;
+		textureAtlasPages[i] = p;
+		textureAtlas[i] = { { static_cast<float>(position.x + m_extrusion), static_cast<float>(position.y + m_extrusion) }, { static_cast<float>(size.x), static_cast<float>(size.y) } };
+	}
+
+	// each image writes only its own (extruded) pixels so images can be copied together
+	std::vector<std::vector<std::uint8_t>> pagePixels(pages.size());
+	for (std::size_t p{ 0u }, numberOfPages{ pages.size() }; p < numberOfPages; ++p)
+		pagePixels[p].assign(static_cast<std::size_t>(pages[p].size.x) * pages[p].size.y * 4u, 0u);
+	auto copy = [&](const std::size_t o)
+	{
+		const std::size_t i{ order[o] };
+		priv_copy(*images[i], positions[i], pages[textureAtlasPages[i]].size, pagePixels[textureAtlasPages[i]].data());
+	};
+	if ((m_numberOfThreads > 1u) && (order.size() > 1u))
+		ThreadPool{ std::min(m_numberOfThreads, order.size()) }.run(order.size(), copy);
+	else
+	{
+		for (std::size_t o{ 0u }, numberOfPackedImages{ order.size() }; o < numberOfPackedImages; ++o)
+			copy(o);
+	}
+
+	m_pages.clear();
+	m_pages.reserve(pages.size());
+	for (std::size_t p{ 0u }, numberOfPages{ pages.size() }; p < numberOfPages; ++p)
+		m_pages.emplace_back(pages[p].size, pagePixels[p].data());
+	m_textureAtlas.swap(textureAtlas);
+	m_textureAtlasPages.swap(textureAtlasPages);
+}
+
+inline const std::vector<sf::Image>& AtlasPacker::getPages() const
+{
+	return m_pages;
+}
+
+inline const std::vector<sf::FloatRect>& AtlasPacker::getTextureAtlas() const
+{
+	return m_textureAtlas;
+}
+
+inline const std::vector<std::size_t>& AtlasPacker::getTextureAtlasPages() const
+{
+	return m_textureAtlasPages;
+}
+
+inline void AtlasPacker::apply(Map& map) const
+{
+	map.waitForAsyncUpdate();
+	map.textureAtlas = m_textureAtlas;
+	map.textureAtlasPages = m_textureAtlasPages;
+	map.update();
+}
+
+inline void AtlasPacker::apply(Map& map, const std::size_t firstId, const std::size_t firstPage) const
+{
+	map.waitForAsyncUpdate();
+	const std::size_t numberOfTextureAtlasRectangles{ std::max(map.textureAtlas.size(), firstId + m_textureAtlas.size()) };
+	map.textureAtlas.resize(numberOfTextureAtlasRectangles);
+	map.textureAtlasPages.resize(numberOfTextureAtlasRectangles, 0u);
+	std::copy(m_textureAtlas.begin(), m_textureAtlas.end(), map.textureAtlas.begin() + firstId);
+	std::transform(m_textureAtlasPages.begin(), m_textureAtlasPages.end(), map.textureAtlasPages.begin() + firstId, [firstPage](const std::size_t page) { return firstPage + page; });
+	map.update();
+}
+
+
+
+// PRIVATE
+
+inline bool AtlasPacker::priv_place(Page& page, const sf::Vector2u slotSize, sf::Vector2u& position) const
+{
+	// places the slot at the lowest position along the page's skyline (the leftmost of those). the padding after the last slot of a row or column can be outside of the page
+	const sf::Vector2u skylineSize{ m_maxPageSize.x + m_padding, m_maxPageSize.y + m_padding };
+	std::vector<SkylineNode>& skyline{ page.skyline };
+	std::size_t bestNode{ skyline.size() };
+	unsigned int bestTop{ std::numeric_limits<unsigned int>::max() };
+	for (std::size_t n{ 0u }, numberOfNodes{ skyline.size() }; n < numberOfNodes; ++n)
+	{
+		if (skyline[n].x + slotSize.x > skylineSize.x)
+			break;
+
+		// the slot rests on the highest of the nodes it spans
+		unsigned int y{ 0u };
+		for (std::size_t s{ n }, remainingWidth{ slotSize.x }; remainingWidth > 0u; ++s)
+		{
+			y = std::max(y, skyline[s].y);
+			remainingWidth -= std::min<std::size_t>(remainingWidth, skyline[s].width);
+		}
+		if ((y + slotSize.y <= skylineSize.y) && (y + slotSize.y < bestTop))
+		{
+			bestNode = n;
+			bestTop = y + slotSize.y;
+		}
+	}
+	if (bestNode == skyline.size())
+		return false;
+
+	position = { skyline[bestNode].x, bestTop - slotSize.y };
+	page.size = { std::max(page.size.x, position.x + slotSize.x - m_padding), std::max(page.size.y, position.y + slotSize.y - m_padding) };
+
+	// the slot's top becomes a node and the nodes it covers are removed (or shortened). neighbouring nodes at the same height are merged
+	skyline.insert(skyline.begin() + bestNode, { position.x, bestTop, slotSize.x });
+	const unsigned int slotEnd{ position.x + slotSize.x };
+	for (std::size_t n{ bestNode + 1u }; (n < skyline.size()) && (skyline[n].x < slotEnd);)
+	{
+		const unsigned int overlap{ slotEnd - skyline[n].x };
+		if (skyline[n].width > overlap)
+		{
+			skyline[n].x += overlap;
+			skyline[n].width -= overlap;
+			break;
+		}
+		skyline.erase(skyline.begin() + n);
+	}
+	for (std::size_t n{ (bestNode > 0u) ? bestNode - 1u : 0u }; (n + 1u < skyline.size()) && (n <= bestNode + 1u);)
+	{
+		if (skyline[n].y == skyline[n + 1u].y)
+		{
+			skyline[n].width += skyline[n + 1u].width;
+			skyline.erase(skyline.begin() + n + 1u);
+		}
+		else
+			++n;
+	}
+	return true;
+}
+
+inline void AtlasPacker::priv_copy(const sf::Image& image, const sf::Vector2u position, const sf::Vector2u pageSize, std::uint8_t* const pagePixels) const
+{
+	// copies the image's rows (with their first and last pixels repeated for the extrusion) to its slot. the first and last rows are repeated for the extrusion above and below
+	constexpr std::size_t bytesPerPixel{ 4u };
+	const sf::Vector2u size{ image.getSize() };
+	const std::uint8_t* const pixels{ image.getPixelsPtr() };
+	const std::size_t rowBytes{ size.x * bytesPerPixel };
+	for (unsigned int row{ 0u }, numberOfRows{ size.y + (m_extrusion * 2u) }; row < numberOfRows; ++row)
+	{
+		const unsigned int sourceRow{ std::min(std::max(row, m_extrusion) - m_extrusion, size.y - 1u) };
+		const std::uint8_t* const source{ pixels + (sourceRow * rowBytes) };
+		std::uint8_t* destination{ pagePixels + ((((static_cast<std::size_t>(position.y) + row) * pageSize.x) + position.x) * bytesPerPixel) };
+		for (unsigned int e{ 0u }; e < m_extrusion; ++e, destination += bytesPerPixel)
+			std::memcpy(destination, source, bytesPerPixel);
+		std::memcpy(destination, source, rowBytes);
+		destination += rowBytes;
+		for (unsigned int e{ 0u }; e < m_extrusion; ++e, destination += bytesPerPixel)
+			std::memcpy(destination, source + rowBytes - bytesPerPixel, bytesPerPixel);
+	}
+}
+
+} // namespace cheesemap
@@ -34,12 +34,32 @@
 
 #include <exception>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+// SSE2 is used where it's available (it always is on x86-64). define CHEESEMAP_NO_SIMD to only use scalar code
+#if !defined(CHEESEMAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CHEESEMAP_SSE2
+#endif // CHEESEMAP_NO_SIMD
+
+// tile ids (of grids, tiles and tile templates) are stored as this type. define CHEESEMAP_TILE_ID_TYPE as a smaller unsigned integer type (e.g. std::uint16_t) to store them more compactly
+#ifndef CHEESEMAP_TILE_ID_TYPE
+#define CHEESEMAP_TILE_ID_TYPE std::size_t
+#endif // CHEESEMAP_TILE_ID_TYPE
+
+// define CHEESEMAP_PROFILE_ZONE(name) to mark the stages of updating and drawing for a profiler (as a zone for the rest of the scope it's in). by default it does nothing
+#ifndef CHEESEMAP_PROFILE_ZONE
+#define CHEESEMAP_PROFILE_ZONE(name)
+#endif // CHEESEMAP_PROFILE_ZONE
+
+// define CHEESEMAP_NO_UPDATE_STATS to remove the code that counts and times updates (Map's update stats are then always empty)
+
 namespace cheesemap
 {
 
+using TileIdType = CHEESEMAP_TILE_ID_TYPE;
+
 class Exception : public std::exception
 {
 public:
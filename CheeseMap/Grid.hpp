@@ -51,9 +51,11 @@ struct Grid
 	std::size_t rowWidth{ 1u };
 	sf::Vector2f texInset{ 0.f, 0.f };
 	sf::Vector2f tileExpand{ 0.f, 0.f };
-	std::size_t invisibleId{ 0u };
+	TileIdType invisibleId{ 0u };
 	sf::Color color{ sf::Color::White };
-	std::vector<std::size_t> tileIds{};
+	std::vector<TileIdType> tileIds{};
+	const TileIdType* externalTileIds{ nullptr }; // if set, the grid's tile ids are read from here (instead of tileIds) and are not owned by the grid (e.g. a grid loaded by MapFile)
+	std::size_t numberOfExternalTileIds{ 0u };
 	struct TileTextureTransform
 	{
 		std::size_t tileIndex{ 0u };
@@ -61,6 +63,9 @@ struct Grid
 		TextureTransform textureTransform{};
 	};
 	std::vector<TileTextureTransform> tileTextureTransforms{};
+
+	const TileIdType* getTileIds() const { return (externalTileIds != nullptr) ? externalTileIds : tileIds.data(); }
+	std::size_t getNumberOfTiles() const { return (externalTileIds != nullptr) ? numberOfExternalTileIds : tileIds.size(); }
 };
 
 } // namespace cheesemap
@@ -49,6 +49,7 @@ struct Layer
 	sf::Vector2f texInset{ 0.f, 0.f };
 	sf::Vector2f tileExpand{ 0.f, 0.f };
 	sf::Color color{ sf::Color::White };
+	bool useSpatialIndex{ false }; // when using a spatial index, any changes to tiles must be followed by Map::updateLayer() (or Map::update())
 	std::vector<Tile> tiles{};
 };
 
@@ -34,15 +34,27 @@
 
 #include "Common.hpp"
 #include "Grid.hpp"
+#include "SparseGrid.hpp"
 #include "Layer.hpp"
 #include "Tile.hpp"
+#include "Animation.hpp"
+#include "SpatialIndex.hpp"
+#include "ThreadPool.hpp"
 
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Transformable.hpp>
+#include <SFML/Graphics/Transform.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/View.hpp>
 #include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexBuffer.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <future>
+#include <functional>
+#include <chrono>
 
 namespace cheesemap
 {
@@ -52,9 +64,19 @@ class Map : public sf::Drawable, public sf::Transformable
 {
 public:
 	std::vector<Grid> grids;
+	std::vector<SparseGrid> sparseGrids;
 	std::vector<Layer> layers;
 	std::vector<sf::FloatRect> textureAtlas;
+	std::vector<std::size_t> textureAtlasPages; // the texture page of each texture atlas rectangle (rectangles without one are on page 0). animated tiles use the page of their animation's id. grid cells are grouped by page; layer tiles (and expanded cells) stay in order so each change of page adds a draw
 	std::vector<TileTemplate> tileTemplates;
+	std::vector<Animation> animations;
+
+	enum class GroupType
+	{
+		Layer,
+		Grid,
+		SparseGrid,
+	};
 
 	struct GridTileId
 	{
@@ -68,18 +90,103 @@ public:
 		std::size_t tileIndex{};
 	};
 
+	struct SparseGridTileId
+	{
+		std::size_t sparseGridIndex{};
+		std::size_t tileIndex{};
+	};
+
+	struct ChunkInfo
+	{
+		std::size_t numberOfChunks{};
+		std::size_t numberOfVisibleChunks{};
+		std::size_t numberOfChunksBuilt{}; // during the most recent update
+		std::size_t numberOfChunksRequiringUpload{};
+		std::size_t numberOfVerticesRequiringUpload{};
+		std::size_t numberOfVerticesUploaded{}; // during the most recent draw
+	};
+
+	struct UpdateStats
+	{
+		bool isFullUpdate{};
+		std::size_t numberOfGroupsConsidered{}; // every group during a full update (otherwise, only the groups that changed)
+		std::size_t numberOfGroupsSkipped{}; // not drawn (inactive, outside of the z order or depth range, or behind the camera)
+		std::size_t numberOfGroupsCulled{};
+		std::size_t numberOfTilesTested{}; // tiles of chunks that were built are all included (chunks aren't culled by tile)
+		std::size_t numberOfTilesCulled{};
+		std::size_t numberOfQuads{}; // quads built (including those built into chunks)
+		std::size_t numberOfVertexBytes{}; // the size of the vertices of those quads
+		float sortTime{}; // in seconds
+		float cullTime{}; // includes building chunks
+		float emitTime{};
+		float totalTime{};
+	};
+
+	struct VertexRun // built vertices (triangles; six for each quad) of one group (or one of its chunks) that use one texture page
+	{
+		GroupType groupType{ GroupType::Layer };
+		std::size_t groupIndex{}; // index of layer, grid or sparse grid
+		const sf::Vertex* vertices{};
+		std::size_t numberOfVertices{};
+		const std::size_t* quadTiles{}; // the index (within the group) of each quad's tile
+		std::size_t texturePage{}; // drawn with the texture of this page
+		sf::Transform transform{}; // drawn with this transform (as well as the map's transform). only used with depth transforms
+	};
+
 	Map();
 
-	void update();
-	void update(const sf::View& view);
+	void update(); // call after changing map data (any grid, layer, tile template, texture atlas or animation)
+	void update(const sf::View& view); // call after changing the view (nothing is updated if it's the same view as the selected view slot's)
+	void updateGrid(std::size_t gridIndex); // call after changing a grid when only that grid has changed
+	void updateGridTile(std::size_t gridIndex, std::size_t tileIndex); // call after changing a grid's tile id (or its texture transform) when only that tile has changed
+	void updateLayer(std::size_t layerIndex); // call after changing a layer (or its tiles) when only that layer has changed
+	void updateLayerTile(std::size_t layerIndex, std::size_t tileIndex); // call after changing a layer's tile when only that tile has changed (adding or removing tiles requires updateLayer)
+	void updateSparseGrid(std::size_t sparseGridIndex); // call after changing a sparse grid (or its tiles) when only that sparse grid has changed
+
+	void animate(float timeStep); // advances the animations. only the texture coordinates of tiles that use an animated id are changed (nothing is culled or rebuilt)
 
 	void setRangeZ(std::size_t min, std::size_t max);
 	void setRangeDepth(float min, float max);
 	void setRangeZ(); // resets range to all
 	void setRangeDepth(); // resets range to all
 	
-	void setTexture(const sf::Texture& texture);
-	void setTexture();
+	void setTexture(const sf::Texture& texture); // the texture of page 0
+	void setTexture(const sf::Texture& texture, std::size_t texturePage); // each group's quads are drawn together for each page (in page order) so using more pages only adds a draw for each page that a group uses
+	void setTexture(); // removes all textures
+
+	void setChunkSize(sf::Vector2f chunkSize); // grids, sparse grids and layers that are not affected by depth are built in chunks (of this size; sparse grids use their own stored chunks) that are only rebuilt when they change and are drawn from vertex buffers
+	void setChunkSize(); // resets to not using chunks
+	ChunkInfo getChunkInfo() const;
+
+	void setNumberOfThreads(std::size_t numberOfThreads); // culling and building vertices is shared between this many threads (0 uses the number of hardware threads). default is 1
+	std::size_t getNumberOfThreads() const;
+
+	void setViewMargin(sf::Vector2f viewMargin); // geometry is built for the view plus this margin (on each side) so that moving the view within it (with the same size and rotation) only updates grids and layers that are affected by depth
+	void setViewMargin(); // resets to no margin
+
+	void setDepthTransforms(bool useDepthTransforms); // grids and layers that are affected by depth are built without it and drawn with a transform instead so that moving the view (within the view margin) only updates transforms. default is false
+
+	// grids whose tiles would be drawn smaller than minTileSize pixels (when the view is drawn to a target of targetSize pixels) are drawn in blocks of 2x2 tiles (or 4x4, 8x8 and so on) so that the number of quads depends on the target's size instead of the grid's.
+	// each block is drawn as its most common tile (chosen from its four smaller blocks). blocks are precomputed when they're first required and are kept until their grid changes. grids drawn in blocks are not built in chunks
+	void setGridLevelOfDetail(sf::Vector2f targetSize, float minTileSize);
+	void setGridLevelOfDetail(); // resets to always drawing every tile
+
+	void setAsyncUpdate(bool isAsync); // updates are built on a worker thread while the most recently completed update is drawn. map data must not be changed while an update is being built
+	bool isUpdateComplete() const; // false if an update is required or is being built
+	void waitForUpdate() const; // completes any required update (so that the next draw is up to date)
+	void waitForAsyncUpdate() const; // completes an asynchronous update that is being built without starting another (so that map data can then be replaced without building the old data)
+
+	// view slots: each has its own view and its own built geometry (including chunks) so that drawing a map with several views (e.g. split-screen and a minimap) only rebuilds a view's geometry when its view or the map changes.
+	// update(view), drawing and headless building use the selected view slot. changes to the map (and its settings) are applied to every view slot
+	void setNumberOfViewSlots(std::size_t numberOfViewSlots); // at least 1. default is 1. if the selected view slot is removed, view slot 0 is selected
+	std::size_t getNumberOfViewSlots() const;
+	void setViewSlot(std::size_t viewSlot); // selects a view slot (without updating it)
+	std::size_t getViewSlot() const;
+
+	void setUpdateStats(bool collectUpdateStats); // the counts and times of each update are collected. default is false. has no effect if CHEESEMAP_NO_UPDATE_STATS is defined
+	void setUpdateStatsCallback(std::function<void(const UpdateStats&)> updateStatsCallback); // called with the stats of each update (while collecting them). asynchronous updates call it when they are swapped in (on the thread that draws)
+	void setUpdateStatsCallback();
+	UpdateStats getUpdateStats() const; // of the most recent update (while collecting them)
 
 	void setDepthScale(float depthScale);
 
@@ -97,11 +204,32 @@ public:
 	LayerTileId getLayerTileIdAtLocalCoord(sf::Vector2f localCoord) const;
 	std::vector<LayerTileId> getLayerTileIdsAtLocalCoord(sf::Vector2f localCoord) const;
 
+	// sparse grids have their own queries (rather than being included in the grid queries) so that a GridTileId's gridIndex always refers to grids. sparse grids only include cells that have a (visible) tile
+	SparseGridTileId getSparseGridTileIdAtLocalCoord(sf::Vector2f localCoord) const;
+	std::vector<SparseGridTileId> getSparseGridTileIdsAtLocalCoord(sf::Vector2f localCoord) const;
+
+	// batched queries: results are written to the provided vector (which is cleared first) so that its storage can be reused between queries
+	void getGridTileIdsInLocalRectangle(sf::FloatRect localRectangle, std::vector<GridTileId>& gridTileIds) const; // every grid tile whose cell intersects the rectangle
+	void getLayerTileIdsInLocalRectangle(sf::FloatRect localRectangle, std::vector<LayerTileId>& layerTileIds) const; // every active layer tile that intersects the rectangle
+	void getGridTileIdsAtLocalCoords(const sf::Vector2f* localCoords, std::size_t numberOfLocalCoords, std::vector<GridTileId>& gridTileIds) const; // one for each coord (the same as getGridTileIdAtLocalCoord)
+	void getLayerTileIdsAtLocalCoords(const sf::Vector2f* localCoords, std::size_t numberOfLocalCoords, std::vector<LayerTileId>& layerTileIds) const; // one for each coord (the same as getLayerTileIdAtLocalCoord)
+	void getSparseGridTileIdsInLocalRectangle(sf::FloatRect localRectangle, std::vector<SparseGridTileId>& sparseGridTileIds) const; // every (visible) sparse grid tile whose cell intersects the rectangle
+	void getSparseGridTileIdsAtLocalCoords(const sf::Vector2f* localCoords, std::size_t numberOfLocalCoords, std::vector<SparseGridTileId>& sparseGridTileIds) const; // one for each coord (the same as getSparseGridTileIdAtLocalCoord)
+
 	std::size_t getGridTileIndexAtGridLocation(std::size_t gridIndex, sf::Vector2<std::size_t> location) const;
 	std::size_t getGridHeight(std::size_t gridIndex) const;
+	std::size_t getSparseGridTileIndexAtGridLocation(std::size_t sparseGridIndex, sf::Vector2<std::size_t> location) const;
 
 	bool doesGridBoundsContainCoord(std::size_t gridIndex, sf::Vector2f localCoord) const;
 
+	// headless building: the vertices that would be drawn (in drawing order) without a render target or texture. runs are only valid until the map is next updated or drawn
+	template <class VertexRunFunction>
+	void forEachVertexRun(VertexRunFunction vertexRunFunction) const; // completes any required update and then calls vertexRunFunction(const VertexRun&) for each (non-empty) run
+	void getVertices(std::vector<sf::Vertex>& vertices) const; // every run's vertices (with their transforms applied) in one vertex array (which is cleared first)
+	template <class VertexRunFunction>
+	void build(const sf::View& view, VertexRunFunction vertexRunFunction); // updates for the view and then calls forEachVertexRun
+	void build(const sf::View& view, std::vector<sf::Vertex>& vertices); // updates for the view and then calls getVertices
+
 
 
 
@@ -117,8 +245,8 @@ public:
 
 
 private:
-	const sf::Texture* m_texture;
-	sf::View m_view;
+	std::vector<const sf::Texture*> m_textures; // one for each texture page
+	mutable sf::View m_view; // the view of the update being built (if updating asynchronously)
 	float m_depthMultiplier;
 	sf::Vector2f m_vanishingPointOffsetFromCenter;
 	bool m_useRangeZ;
@@ -128,15 +256,266 @@ private:
 	float m_rangeMinDepth;
 	float m_rangeMaxDepth;
 	float m_depthOffset;
+	bool m_useChunks;
+	sf::Vector2f m_chunkSize;
+	std::shared_ptr<ThreadPool> m_threadPool; // only when using more than one thread
+	sf::Vector2f m_viewMargin;
+	bool m_useDepthTransforms;
+	bool m_useGridLevelOfDetail;
+	sf::Vector2f m_levelOfDetailTargetSize;
+	float m_levelOfDetailMinTileSize;
+	bool m_isAsync;
+	bool m_isCollectingUpdateStats;
+	std::function<void(const UpdateStats&)> m_updateStatsCallback;
+
+	static constexpr std::size_t numberOfVerticesPerQuad{ 6u };
+	static constexpr std::size_t noQuad{ static_cast<std::size_t>(-1) };
+	static constexpr std::size_t sparseGridNumberOfChunksPerRow{ SparseGrid::rowWidth / SparseGrid::chunkSize };
+	static constexpr std::size_t numberOfTilesPerTask{ 4096u }; // when using multiple threads, the vertices of large groups are built in parts of this many tiles
+
+	struct GroupId
+	{
+		GroupType groupType{ GroupType::Layer };
+		std::size_t groupIndex{ 0u }; // index of layer, grid or sparse grid
+		bool operator==(const GroupId& other) const { return (groupType == other.groupType) && (groupIndex == other.groupIndex); }
+	};
+	struct PageRun // consecutive quads that use the same texture page
+	{
+		std::size_t texturePage{ 0u };
+		std::size_t numberOfQuads{ 0u };
+	};
+	struct GroupGeometry
+	{
+		GroupId groupId{};
+		std::size_t zOrder{ 0u };
+		bool isChunked{ false }; // chunked groups have no vertices in the vertex array (they are drawn from their chunks)
+		float depthRatio{ 1.f }; // the depth ratio that the group is drawn with as a transform (1 if depth is built into its vertices)
+		sf::FloatRect culledRectangle{}; // the rectangle that the group was culled with (without depth if it is drawn with a transform)
+		std::size_t startVertex{ 0u };
+		std::size_t numberOfVertices{ 0u };
+		std::size_t vertexCapacity{ 0u }; // the vertices reserved for the group in the vertex array (partial updates can grow into them without moving any other group)
+		// grids only: the range of cells that were tested and the quad (within the group) that each one uses (or noQuad)
+		sf::Vector2<std::size_t> firstCell{ 0u, 0u };
+		sf::Vector2<std::size_t> numberOfCells{ 0u, 0u };
+		std::vector<std::size_t> cellQuads{};
+		std::vector<std::size_t> quadTiles{}; // the tile that each quad uses
+		std::vector<PageRun> pageRuns{}; // empty if every texture atlas rectangle is on page 0
+	};
+	struct Chunk
+	{
+		bool isBuildRequired{ true }; // grids and sparse grids: their chunks are built when they are first near the view. layers: a tile in the chunk has changed
+		bool isUploadRequired{ false };
+		sf::FloatRect bounds{};
+		std::vector<sf::Vertex> vertices{};
+		std::vector<std::size_t> quadTiles{};
+		std::vector<PageRun> pageRuns{};
+		sf::VertexBuffer vertexBuffer{ sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static };
+	};
+	struct GroupChunks
+	{
+		GroupId groupId{};
+		bool isValid{ false }; // if false, all chunks are rebuilt (and, for grids, the chunks are laid out again)
+		sf::Vector2<std::size_t> chunkSize{ 0u, 0u }; // grids only: in cells
+		sf::Vector2<std::size_t> numberOfChunks{ 0u, 0u }; // grids only
+		std::unordered_map<std::size_t, std::size_t> sparseGridChunkIndices{}; // sparse grids only: the chunk of each stored chunk (by its location: (y * sparseGridNumberOfChunksPerRow) + x)
+		std::vector<sf::Vector2<long long>> layerChunkLocations{}; // layers only: the location of each chunk (in the same order as the chunks: by row and then by column)
+		std::vector<std::size_t> layerTileChunks{}; // layers only: the chunk of each of the layer's tiles (noQuad if the tile isn't drawn)
+		std::vector<Chunk> chunks{};
+		std::vector<std::size_t> visibleChunks{};
+		std::size_t numberOfChunksBuilt{ 0u }; // during the most recent update
+	};
+	struct SparseGridChunk // a stored chunk of a sparse grid
+	{
+		sf::Vector2<std::size_t> location{ 0u, 0u };
+		const TileIdType* tileIds{ nullptr };
+	};
+	struct TextureCoords // the corners of a texture atlas rectangle
+	{
+		sf::Vector2f topLeft{};
+		sf::Vector2f bottomRight{};
+	};
+	struct TileTextureTransformIndex
+	{
+		std::size_t tileIndex{ 0u };
+		std::size_t transformIndex{ 0u }; // index within the grid's tileTextureTransforms
+	};
+	struct AnimatedQuad
+	{
+		std::size_t groupChunks{ noQuad }; // the index within m_groupChunks (and the chunk) of the quad's vertices (noQuad if they are in the vertex array)
+		std::size_t chunk{ 0u };
+		std::size_t startVertex{ 0u };
+		TextureTransform textureTransform{}; // including the group's texture inset
+	};
+	struct AnimationState
+	{
+		std::size_t frame{ 0u };
+		float frameTime{ 0.f }; // time since the frame started
+		bool isChanged{ true }; // the frame has changed since the animation's quads were last set
+		std::vector<AnimatedQuad> quads{}; // quads that use the animation's id
+	};
+	struct ViewSlot // the state of a view slot while it isn't selected (the selected view slot's state is in the members below)
+	{
+		sf::View view{};
+		bool isUpdateRequired{ false };
+		bool isFullUpdateRequired{ true };
+		std::vector<GroupId> groupsRequiringUpdate{};
+		std::vector<GridTileId> gridTilesRequiringUpdate{};
+		std::vector<GroupGeometry> groupGeometries{};
+		std::vector<sf::Vertex> vertices{};
+		sf::View builtView{};
+		sf::FloatRect builtViewRectangle{};
+		std::vector<GroupGeometry> backGroupGeometries{};
+		std::vector<sf::Vertex> backVertices{};
+		bool isViewPending{ false };
+		sf::View pendingView{};
+		std::vector<GroupChunks> groupChunks{};
+		ChunkInfo chunkInfo{};
+		UpdateStats updateStats{};
+		UpdateStats backUpdateStats{};
+		std::vector<AnimationState> animationStates{};
+		bool isAnimationUpdateRequired{ false };
+		bool isAnimationIndexValid{ false };
+	};
 
 	mutable bool m_isUpdateRequired;
+	mutable bool m_isFullUpdateRequired;
+	mutable std::vector<GroupId> m_groupsRequiringUpdate;
+	mutable std::vector<GridTileId> m_gridTilesRequiringUpdate;
+	mutable std::vector<GroupGeometry> m_groupGeometries; // in drawing order
 	mutable std::vector<sf::Vertex> m_vertices;
+	mutable std::vector<TextureCoords> m_textureCoords; // updated with each full update
+	mutable std::vector<std::size_t> m_texturePages; // the page of each texture atlas rectangle (empty if they're all on page 0). updated with each full update
+	mutable sf::View m_builtView; // the view and rectangle (including the view margin) of the most recent full update
+	mutable sf::FloatRect m_builtViewRectangle;
+	mutable std::vector<GroupGeometry> m_backGroupGeometries; // asynchronous updates are built into these and then swapped
+	mutable std::vector<sf::Vertex> m_backVertices;
+	mutable bool m_isViewPending;
+	mutable sf::View m_pendingView; // a view that was set while an asynchronous update was being built
+	mutable std::vector<GroupChunks> m_groupChunks;
+	mutable ChunkInfo m_chunkInfo;
+	mutable UpdateStats m_updateStats;
+	mutable UpdateStats m_backUpdateStats; // the stats of an asynchronous update being built
+	mutable std::vector<AnimationState> m_animationStates;
+	mutable bool m_isAnimationUpdateRequired;
+	mutable bool m_isAnimationIndexValid; // the animations' quads are found again after any update
+
+	struct LayerSpatialIndex
+	{
+		bool isValid{ false };
+		const Tile* tiles{ nullptr }; // used to detect that the layer's tiles have been replaced, added or removed
+		std::size_t numberOfTiles{ 0u };
+		SpatialIndex spatialIndex{};
+	};
+	mutable std::vector<LayerSpatialIndex> m_layerSpatialIndices;
+
+	struct GridTextureTransformIndex
+	{
+		bool isValid{ false };
+		const Grid::TileTextureTransform* tileTextureTransforms{ nullptr }; // used to detect that the grid's texture transforms have been replaced, added or removed
+		std::size_t numberOfTileTextureTransforms{ 0u };
+		std::vector<TileTextureTransformIndex> tileTextureTransformIndices{};
+	};
+	mutable std::vector<GridTextureTransformIndex> m_gridTextureTransformIndices;
+
+	struct GridLevel // the blocks of one level of detail of a grid (level n has blocks of 2^n x 2^n tiles)
+	{
+		sf::Vector2<std::size_t> numberOfBlocks{ 0u, 0u };
+		std::vector<std::size_t> blockTiles{}; // the tile (index within the grid) that each block is drawn as (noQuad if none of its tiles are drawn)
+	};
+	struct GridLevels
+	{
+		bool isValid{ false };
+		const TileIdType* tileIds{ nullptr }; // used to detect that the grid's tiles have been replaced or resized
+		std::size_t numberOfTiles{ 0u };
+		std::size_t rowWidth{ 0u };
+		std::vector<GridLevel> levels{}; // from level 1
+	};
+	mutable std::vector<GridLevels> m_gridLevels;
+	std::vector<ViewSlot> m_viewSlots; // the selected view slot's entry is unused while it's selected
+	std::size_t m_viewSlot;
+	mutable std::shared_future<void> m_asyncUpdate; // last so that it is destroyed (waiting for any update being built) first
 
 	void draw(sf::RenderTarget&, sf::RenderStates) const override;
 
 	void priv_update() const;
+	void priv_startAsyncUpdate() const;
+	bool priv_finishAsyncUpdate(bool wait) const;
+	void priv_updateTextureCoords() const;
+	void priv_updateAnimatedQuads() const;
+	void priv_updateAnimationIndex() const;
+	TextureCoords priv_getAnimationTextureCoords(std::size_t animationIndex) const;
+	const std::vector<TileTextureTransformIndex>& priv_getTileTextureTransformIndices(std::size_t gridIndex) const;
+	void priv_buildGroups(const sf::FloatRect& effectiveViewRectangle, const std::vector<GroupId>* changedGroups, std::vector<GroupGeometry>& groupGeometries, std::vector<sf::Vertex>& vertices, UpdateStats* updateStats) const;
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	void priv_addCullStats(UpdateStats& updateStats, bool isChunked, std::size_t numberOfTilesTested, std::size_t numberOfActiveTiles) const;
+	float priv_getStageTime(std::chrono::steady_clock::time_point& stageStart) const;
+#endif // CHEESEMAP_NO_UPDATE_STATS
+	template <class TaskFunction>
+	void priv_runTasks(std::size_t numberOfTasks, TaskFunction task) const;
+	bool priv_updateGroup(GroupId groupId, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	bool priv_isVertexArrayPacked() const;
+	void priv_packVertexArray() const;
+	bool priv_updateGridTile(GridTileId gridTileId, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	bool priv_isGroupDrawn(GroupId groupId) const;
+	bool priv_isGroupChunked(GroupId groupId) const;
+	std::size_t priv_getGroupZOrder(GroupId groupId) const;
+	float priv_getGroupDepth(GroupId groupId) const;
+	float priv_getBuiltDepthRatio(GroupId groupId) const;
+	sf::Transform priv_getDepthTransform(float depthRatio) const;
+	bool priv_isViewWithinMargin(const sf::View& view) const;
+	bool priv_isSameView(const sf::View& view, const sf::View& otherView) const;
+	void priv_swapViewSlot(ViewSlot& viewSlot);
+	template <class ViewSlotFunction>
+	void priv_forEachViewSlot(ViewSlotFunction viewSlotFunction);
+	bool priv_isRectangleWithin(const sf::FloatRect& rectangle, const sf::FloatRect& outerRectangle) const;
+	std::size_t priv_cullGroup(GroupGeometry& groupGeometry, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	std::size_t priv_cullLayer(std::size_t layerIndex, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	std::size_t priv_cullGrid(GroupGeometry& groupGeometry, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	std::size_t priv_cullGridBlocks(GroupGeometry& groupGeometry, std::size_t level, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	std::size_t priv_cullSparseGrid(std::size_t sparseGridIndex, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	void priv_getSparseGridChunks(const SparseGrid& sparseGrid, sf::Vector2<std::size_t> firstChunk, sf::Vector2<std::size_t> lastChunk, std::vector<SparseGridChunk>& sparseGridChunks) const;
+	GroupChunks& priv_getGroupChunks(GroupId groupId) const;
+	void priv_invalidateGroupChunks(GroupId groupId);
+	void priv_invalidateGridTileChunk(std::size_t gridIndex, std::size_t tileIndex);
+	void priv_updateGridChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	void priv_invalidateLayerTileChunk(std::size_t layerIndex, std::size_t tileIndex);
+	bool priv_isLayerTileDrawn(const Tile& tile) const;
+	sf::Vector2<long long> priv_getLayerTileChunkLocation(const Layer& layer, const Tile& tile) const;
+	void priv_updateLayerChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	void priv_updateSparseGridChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const;
+	template <class RunFunction>
+	void priv_forEachRun(RunFunction runFunction) const;
+	void priv_drawChunk(sf::RenderTarget& target, const sf::RenderStates& states, Chunk& chunk, std::size_t firstVertex, std::size_t numberOfVertices) const;
+	std::size_t priv_getTileTexturePage(GroupId groupId, std::size_t tileIndex) const;
+	std::size_t priv_getQuadTexturePage(const std::vector<PageRun>& pageRuns, std::size_t quad) const;
+	void priv_sortTilesByTexturePage(GroupId groupId, std::size_t* activeTiles, std::size_t numberOfActiveTiles, std::vector<PageRun>& pageRuns, std::vector<std::size_t>* cellQuads) const;
+	bool priv_canTilesOverlap(GroupId groupId) const;
+	sf::FloatRect priv_getVertexBounds(const std::vector<sf::Vertex>& vertices) const;
+	bool priv_isGridTileVisible(const Grid& grid, sf::Vector2<std::size_t> location, std::size_t tileIndex, float depthRatio, const sf::FloatRect& effectiveViewRectangle) const;
+	void priv_setGroupQuads(GroupId groupId, const std::size_t* activeTiles, std::size_t numberOfActiveTiles, sf::Vertex* vertices) const;
+	void priv_setGridRowQuads(sf::Vertex* vertices, const Grid& grid, std::size_t firstTileIndex, std::size_t numberOfTiles, float depthRatio) const;
+	void priv_setGridBlockQuad(sf::Vertex* vertices, std::size_t gridIndex, std::size_t tileIndex, std::size_t level, const Grid::TileTextureTransform* tileTextureTransform, float depthRatio) const;
+	void priv_setGridTileQuad(sf::Vertex* vertices, std::size_t gridIndex, std::size_t tileIndex, const Grid::TileTextureTransform* tileTextureTransform, float depthRatio) const;
+	void priv_setSparseGridTileQuad(sf::Vertex* vertices, const SparseGrid& sparseGrid, std::size_t tileIndex, TileIdType tileId, float depthRatio) const;
+	void priv_setLayerTileQuad(sf::Vertex* vertices, std::size_t layerIndex, std::size_t tileIndex, float depthRatio) const;
+	void priv_setTileQuad(sf::Vertex* vertices, const Tile& tile, const TextureTransform& textureTransform, sf::Vector2f texInset, sf::Color color, float depthRatio) const;
+	sf::FloatRect priv_getEffectiveViewRectangle(const sf::View& view) const;
+	float priv_getDepthRatio(float depth) const;
+	sf::Vector2f priv_pointWithDepth(sf::Vector2f point, float depthRatio) const;
+	sf::Vector2f priv_pointWithoutDepth(sf::Vector2f point, float depthRatio) const;
+	sf::FloatRect priv_rectangleWithoutDepth(const sf::FloatRect& rectangle, float depthRatio) const;
+	sf::Vector2f priv_pointDepthScale(sf::Vector2f point, float depthRatio) const;
+	sf::Vector2f priv_pointDepthUnscale(sf::Vector2f point, float depthRatio) const;
+	sf::FloatRect priv_getLayerTileBounds(const Tile& tile) const;
+	const SpatialIndex* priv_getLayerSpatialIndex(std::size_t layerIndex) const;
+	std::size_t priv_getGridLevelOfDetail(std::size_t gridIndex) const;
+	const GridLevel& priv_getGridLevel(std::size_t gridIndex, std::size_t level) const;
+	void priv_setGridLevelBlock(const Grid& grid, std::vector<GridLevel>& levels, std::size_t level, sf::Vector2<std::size_t> block) const;
+	std::size_t priv_getLayerTileIndexAtLocalCoord(std::size_t layerIndex, sf::Vector2f localCoord, std::vector<std::size_t>& candidateTiles) const; // candidateTiles is the caller's storage for the spatial index's results
+	std::size_t priv_getGridTileIndexAtLocalCoord(std::size_t gridIndex, sf::Vector2f localCoord) const;
+	std::size_t priv_getSparseGridTileIndexAtLocalCoord(std::size_t sparseGridIndex, sf::Vector2f localCoord) const;
 	void priv_setQuad(
-		const std::size_t startVertex,
+		sf::Vertex* vertices,
 		const sf::Vector2f topLeft,
 		const sf::Vector2f bottomRight,
 		sf::Vector2f textureTopLeft,
@@ -146,6 +525,14 @@ private:
 		const bool flipY,
 		const bool turn
 	) const;
+	void priv_setQuadTextureCoords(
+		sf::Vertex* vertices,
+		sf::Vector2f textureTopLeft,
+		sf::Vector2f textureBottomRight,
+		const bool flipX,
+		const bool flipY,
+		const bool turn
+	) const;
 };
 
 } // namespace cheesemap
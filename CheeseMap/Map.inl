@@ -34,18 +34,30 @@
 
 #include "Map.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <chrono>
+
+#ifdef CHEESEMAP_SSE2
+#include <emmintrin.h>
+#endif // CHEESEMAP_SSE2
 
 namespace cheesemap
 {
 
 inline Map::Map()
 	: grids{}
+	, sparseGrids{}
 	, layers{}
 	, textureAtlas{}
+	, textureAtlasPages{}
 	, tileTemplates{}
+	, animations{}
 
-	, m_texture{ nullptr }
+	, m_textures{}
 	, m_view{}
 	, m_depthMultiplier{ 1.f }
 	, m_vanishingPointOffsetFromCenter{ 0.f, 0.f }
@@ -56,25 +68,221 @@ inline Map::Map()
 	, m_rangeMinDepth{ 0.f }
 	, m_rangeMaxDepth{ 0.f }
 	, m_depthOffset{ 0.f }
+	, m_useChunks{ false }
+	, m_chunkSize{ 0.f, 0.f }
+	, m_threadPool{}
+	, m_viewMargin{ 0.f, 0.f }
+	, m_useDepthTransforms{ false }
+	, m_useGridLevelOfDetail{ false }
+	, m_levelOfDetailTargetSize{ 0.f, 0.f }
+	, m_levelOfDetailMinTileSize{ 0.f }
+	, m_isAsync{ false }
+	, m_isCollectingUpdateStats{ false }
+	, m_updateStatsCallback{}
 	, m_isUpdateRequired{ false }
+	, m_isFullUpdateRequired{ true }
+	, m_groupsRequiringUpdate{}
+	, m_gridTilesRequiringUpdate{}
+	, m_groupGeometries{}
 	, m_vertices{}
+	, m_textureCoords{}
+	, m_texturePages{}
+	, m_builtView{}
+	, m_builtViewRectangle{}
+	, m_backGroupGeometries{}
+	, m_backVertices{}
+	, m_isViewPending{ false }
+	, m_pendingView{}
+	, m_groupChunks{}
+	, m_chunkInfo{}
+	, m_updateStats{}
+	, m_backUpdateStats{}
+	, m_animationStates{}
+	, m_isAnimationUpdateRequired{ false }
+	, m_isAnimationIndexValid{ false }
+	, m_layerSpatialIndices{}
+	, m_gridTextureTransformIndices{}
+	, m_gridLevels{}
+	, m_viewSlots(1u)
+	, m_viewSlot{ 0u }
+	, m_asyncUpdate{}
 {
 
 }
 
 inline void Map::update()
 {
-	m_isUpdateRequired = true;
+	priv_finishAsyncUpdate(true);
+	for (auto& layerSpatialIndex : m_layerSpatialIndices)
+		layerSpatialIndex.isValid = false;
+	for (auto& gridTextureTransformIndex : m_gridTextureTransformIndices)
+		gridTextureTransformIndex.isValid = false;
+	for (auto& gridLevels : m_gridLevels)
+		gridLevels.isValid = false;
+	priv_forEachViewSlot([&]()
+	{
+		m_groupChunks.clear();
+		m_isUpdateRequired = true;
+		m_isFullUpdateRequired = true;
+	});
 }
 
 inline void Map::update(const sf::View& view)
 {
-	m_view = view;
-	update();
+	// moving the view within the margin doesn't require a full update; only the groups that are affected by depth are updated
+	// (groups drawn with a depth transform are only updated if the view, without depth, leaves the rectangle they were culled with)
+	if (!m_isFullUpdateRequired && !m_isViewPending && priv_isSameView(view, m_view))
+		return;
+	if (!m_isAsync && !m_isFullUpdateRequired && priv_isViewWithinMargin(view))
+	{
+		m_view = view;
+		const sf::FloatRect viewRectangle{ priv_getEffectiveViewRectangle(view) };
+		for (const auto& groupGeometry : m_groupGeometries)
+		{
+			if (priv_getDepthRatio(priv_getGroupDepth(groupGeometry.groupId)) == 1.f)
+				continue;
+			if ((groupGeometry.depthRatio != 1.f) && priv_isRectangleWithin(priv_rectangleWithoutDepth(viewRectangle, groupGeometry.depthRatio), groupGeometry.culledRectangle))
+				continue;
+			m_groupsRequiringUpdate.push_back(groupGeometry.groupId);
+			m_isUpdateRequired = true;
+		}
+		return;
+	}
+
+	// the view of an asynchronous update that is being built can't be changed so the new view is used for the next one
+	if (m_asyncUpdate.valid())
+	{
+		m_pendingView = view;
+		m_isViewPending = true;
+	}
+	else
+		m_view = view;
+	m_isUpdateRequired = true;
+	m_isFullUpdateRequired = true;
+	if (m_isAsync)
+		priv_update();
+}
+
+inline void Map::updateGrid(const std::size_t gridIndex)
+{
+	priv_finishAsyncUpdate(true);
+	if (gridIndex < m_gridTextureTransformIndices.size())
+		m_gridTextureTransformIndices[gridIndex].isValid = false;
+	if (gridIndex < m_gridLevels.size())
+		m_gridLevels[gridIndex].isValid = false;
+	priv_forEachViewSlot([&]()
+	{
+		priv_invalidateGroupChunks({ GroupType::Grid, gridIndex });
+		m_isUpdateRequired = true;
+		if (!m_isFullUpdateRequired)
+			m_groupsRequiringUpdate.push_back({ GroupType::Grid, gridIndex });
+	});
+}
+
+inline void Map::updateGridTile(const std::size_t gridIndex, const std::size_t tileIndex)
+{
+	priv_finishAsyncUpdate(true);
+	if (gridIndex < m_gridTextureTransformIndices.size())
+		m_gridTextureTransformIndices[gridIndex].isValid = false;
+
+	// only the blocks that contain the tile are chosen again (if the grid's blocks are still valid)
+	if ((gridIndex < m_gridLevels.size()) && (gridIndex < grids.size()))
+	{
+		const Grid& grid{ grids[gridIndex] };
+		GridLevels& gridLevels{ m_gridLevels[gridIndex] };
+		if (gridLevels.isValid && (gridLevels.tileIds == grid.getTileIds()) && (gridLevels.numberOfTiles == grid.getNumberOfTiles()) && (gridLevels.rowWidth == grid.rowWidth) && (grid.rowWidth != 0u) && (tileIndex < gridLevels.numberOfTiles))
+		{
+			const sf::Vector2<std::size_t> location{ tileIndex % grid.rowWidth, tileIndex / grid.rowWidth };
+			for (std::size_t level{ 1u }, numberOfLevels{ gridLevels.levels.size() }; level <= numberOfLevels; ++level)
+				priv_setGridLevelBlock(grid, gridLevels.levels, level, { location.x >> level, location.y >> level });
+		}
+	}
+	priv_forEachViewSlot([&]()
+	{
+		priv_invalidateGridTileChunk(gridIndex, tileIndex);
+		m_isUpdateRequired = true;
+		if (!m_isFullUpdateRequired)
+			m_gridTilesRequiringUpdate.push_back({ gridIndex, tileIndex });
+	});
+}
+
+inline void Map::updateLayer(const std::size_t layerIndex)
+{
+	priv_finishAsyncUpdate(true);
+	if (layerIndex < m_layerSpatialIndices.size())
+		m_layerSpatialIndices[layerIndex].isValid = false;
+	priv_forEachViewSlot([&]()
+	{
+		priv_invalidateGroupChunks({ GroupType::Layer, layerIndex });
+		m_isUpdateRequired = true;
+		if (!m_isFullUpdateRequired)
+			m_groupsRequiringUpdate.push_back({ GroupType::Layer, layerIndex });
+	});
+}
+
+inline void Map::updateLayerTile(const std::size_t layerIndex, const std::size_t tileIndex)
+{
+	// only the chunks that the tile was in and is now in are rebuilt (the layer isn't culled again unless it is unchunked)
+	priv_finishAsyncUpdate(true);
+	if (layerIndex < m_layerSpatialIndices.size())
+		m_layerSpatialIndices[layerIndex].isValid = false;
+	priv_forEachViewSlot([&]()
+	{
+		priv_invalidateLayerTileChunk(layerIndex, tileIndex);
+		m_isUpdateRequired = true;
+		if (!m_isFullUpdateRequired)
+			m_groupsRequiringUpdate.push_back({ GroupType::Layer, layerIndex });
+	});
+}
+
+inline void Map::updateSparseGrid(const std::size_t sparseGridIndex)
+{
+	priv_finishAsyncUpdate(true);
+	priv_forEachViewSlot([&]()
+	{
+		priv_invalidateGroupChunks({ GroupType::SparseGrid, sparseGridIndex });
+		m_isUpdateRequired = true;
+		if (!m_isFullUpdateRequired)
+			m_groupsRequiringUpdate.push_back({ GroupType::SparseGrid, sparseGridIndex });
+	});
+}
+
+inline void Map::animate(const float timeStep)
+{
+	if (timeStep <= 0.f)
+		return;
+
+	m_animationStates.resize(animations.size());
+	for (std::size_t a{ 0u }, numberOfAnimations{ animations.size() }; a < numberOfAnimations; ++a)
+	{
+		const std::vector<Animation::Frame>& frames{ animations[a].frames };
+		float totalDuration{ 0.f };
+		for (const auto& frame : frames)
+			totalDuration += std::max(frame.duration, 0.f);
+		if (totalDuration <= 0.f)
+			continue;
+
+		// whole cycles are skipped and then the remaining time is stepped through the frames
+		AnimationState& animationState{ m_animationStates[a] };
+		const std::size_t previousFrame{ animationState.frame };
+		animationState.frame %= frames.size();
+		animationState.frameTime = std::fmod(animationState.frameTime + timeStep, totalDuration);
+		while (animationState.frameTime >= std::max(frames[animationState.frame].duration, 0.f))
+		{
+			animationState.frameTime -= std::max(frames[animationState.frame].duration, 0.f);
+			animationState.frame = (animationState.frame + 1u) % frames.size();
+		}
+		if (animationState.frame != previousFrame)
+		{
+			animationState.isChanged = true;
+			m_isAnimationUpdateRequired = true;
+		}
+	}
 }
 
 inline void Map::setRangeZ(const std::size_t min, const std::size_t max)
 {
+	priv_finishAsyncUpdate(true);
 	m_useRangeZ = true;
 	m_rangeMinZ = min;
 	m_rangeMaxZ = max;
@@ -83,6 +291,7 @@ inline void Map::setRangeZ(const std::size_t min, const std::size_t max)
 
 inline void Map::setRangeDepth(const float min, const float max)
 {
+	priv_finishAsyncUpdate(true);
 	m_useRangeDepth = true;
 	m_rangeMinDepth = min;
 	m_rangeMaxDepth = max;
@@ -91,36 +300,232 @@ inline void Map::setRangeDepth(const float min, const float max)
 
 inline void Map::setRangeZ()
 {
+	priv_finishAsyncUpdate(true);
 	m_useRangeDepth = false;
 	update();
 }
 
 inline void Map::setRangeDepth()
 {
+	priv_finishAsyncUpdate(true);
 	m_useRangeZ = false;
 	update();
 }
 
 inline void Map::setTexture(const sf::Texture& texture)
 {
-	m_texture = &texture;
+	setTexture(texture, 0u);
+}
+
+inline void Map::setTexture(const sf::Texture& texture, const std::size_t texturePage)
+{
+	priv_finishAsyncUpdate(true);
+	if (texturePage >= m_textures.size())
+		m_textures.resize(texturePage + 1u, nullptr);
+	m_textures[texturePage] = &texture;
 	update();
 }
 
 inline void Map::setTexture()
 {
-	m_texture = nullptr;
+	priv_finishAsyncUpdate(true);
+	m_textures.clear();
+	update();
+}
+
+inline void Map::setChunkSize(const sf::Vector2f chunkSize)
+{
+	priv_finishAsyncUpdate(true);
+	m_useChunks = (chunkSize.x > 0.f) && (chunkSize.y > 0.f);
+	m_chunkSize = chunkSize;
+	update();
+}
+
+inline void Map::setChunkSize()
+{
+	priv_finishAsyncUpdate(true);
+	m_useChunks = false;
+	update();
+}
+
+inline Map::ChunkInfo Map::getChunkInfo() const
+{
+	if (m_isUpdateRequired)
+		priv_update();
+
+	ChunkInfo chunkInfo{ m_chunkInfo };
+	for (const auto& groupChunks : m_groupChunks)
+	{
+		chunkInfo.numberOfChunksBuilt += groupChunks.numberOfChunksBuilt;
+		chunkInfo.numberOfChunks += groupChunks.chunks.size();
+		chunkInfo.numberOfVisibleChunks += groupChunks.visibleChunks.size();
+		for (const auto& chunk : groupChunks.chunks)
+		{
+			if (!chunk.isUploadRequired)
+				continue;
+			++chunkInfo.numberOfChunksRequiringUpload;
+			chunkInfo.numberOfVerticesRequiringUpload += chunk.vertices.size();
+		}
+	}
+	return chunkInfo;
+}
+
+inline void Map::setNumberOfThreads(std::size_t numberOfThreads)
+{
+	priv_finishAsyncUpdate(true);
+	if (numberOfThreads == 0u)
+		numberOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	if (numberOfThreads == getNumberOfThreads())
+		return;
+
+	if (numberOfThreads > 1u)
+		m_threadPool = std::make_shared<ThreadPool>(numberOfThreads);
+	else
+		m_threadPool.reset();
+}
+
+inline std::size_t Map::getNumberOfThreads() const
+{
+	return m_threadPool ? m_threadPool->getNumberOfThreads() : 1u;
+}
+
+inline void Map::setViewMargin(const sf::Vector2f viewMargin)
+{
+	priv_finishAsyncUpdate(true);
+	m_viewMargin = { std::max(viewMargin.x, 0.f), std::max(viewMargin.y, 0.f) };
+	update();
+}
+
+inline void Map::setViewMargin()
+{
+	setViewMargin({ 0.f, 0.f });
+}
+
+inline void Map::setDepthTransforms(const bool useDepthTransforms)
+{
+	priv_finishAsyncUpdate(true);
+	m_useDepthTransforms = useDepthTransforms;
 	update();
 }
 
+inline void Map::setGridLevelOfDetail(const sf::Vector2f targetSize, const float minTileSize)
+{
+	priv_finishAsyncUpdate(true);
+	m_useGridLevelOfDetail = (targetSize.x > 0.f) && (targetSize.y > 0.f) && (minTileSize > 0.f);
+	m_levelOfDetailTargetSize = targetSize;
+	m_levelOfDetailMinTileSize = minTileSize;
+	update();
+}
+
+inline void Map::setGridLevelOfDetail()
+{
+	setGridLevelOfDetail({ 0.f, 0.f }, 0.f);
+}
+
+inline void Map::setAsyncUpdate(const bool isAsync)
+{
+	priv_finishAsyncUpdate(true);
+	m_isAsync = isAsync;
+	update();
+}
+
+inline bool Map::isUpdateComplete() const
+{
+	return !m_isUpdateRequired && (!m_asyncUpdate.valid() || (m_asyncUpdate.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
+}
+
+inline void Map::waitForUpdate() const
+{
+	while (m_isUpdateRequired || m_asyncUpdate.valid())
+	{
+		priv_finishAsyncUpdate(true);
+		if (m_isUpdateRequired)
+			priv_update();
+	}
+}
+
+inline void Map::waitForAsyncUpdate() const
+{
+	priv_finishAsyncUpdate(true);
+}
+
+inline void Map::setNumberOfViewSlots(std::size_t numberOfViewSlots)
+{
+	numberOfViewSlots = std::max(numberOfViewSlots, static_cast<std::size_t>(1u));
+	if (m_viewSlot >= numberOfViewSlots)
+		setViewSlot(0u);
+	m_viewSlots.resize(numberOfViewSlots);
+}
+
+inline std::size_t Map::getNumberOfViewSlots() const
+{
+	return m_viewSlots.size();
+}
+
+inline void Map::setViewSlot(const std::size_t viewSlot)
+{
+	if ((viewSlot == m_viewSlot) || (viewSlot >= m_viewSlots.size()))
+		return;
+
+	priv_finishAsyncUpdate(true);
+	priv_swapViewSlot(m_viewSlots[m_viewSlot]);
+	priv_swapViewSlot(m_viewSlots[viewSlot]);
+
+	// animations are timed for the map (not for each view slot) so the selected view slot's animated quads are only set again if their frame has changed since they were last set
+	const std::vector<AnimationState>& previousAnimationStates{ m_viewSlots[m_viewSlot].animationStates };
+	m_animationStates.resize(previousAnimationStates.size());
+	for (std::size_t a{ 0u }, numberOfAnimations{ previousAnimationStates.size() }; a < numberOfAnimations; ++a)
+	{
+		AnimationState& animationState{ m_animationStates[a] };
+		if (animationState.frame != previousAnimationStates[a].frame)
+		{
+			animationState.isChanged = true;
+			m_isAnimationUpdateRequired = true;
+		}
+		animationState.frame = previousAnimationStates[a].frame;
+		animationState.frameTime = previousAnimationStates[a].frameTime;
+	}
+	m_viewSlot = viewSlot;
+}
+
+inline std::size_t Map::getViewSlot() const
+{
+	return m_viewSlot;
+}
+
+inline void Map::setUpdateStats(const bool collectUpdateStats)
+{
+	priv_finishAsyncUpdate(true);
+	m_isCollectingUpdateStats = collectUpdateStats;
+	m_updateStats = {};
+}
+
+inline void Map::setUpdateStatsCallback(std::function<void(const UpdateStats&)> updateStatsCallback)
+{
+	priv_finishAsyncUpdate(true);
+	m_updateStatsCallback = std::move(updateStatsCallback);
+}
+
+inline void Map::setUpdateStatsCallback()
+{
+	setUpdateStatsCallback(nullptr);
+}
+
+inline Map::UpdateStats Map::getUpdateStats() const
+{
+	return m_updateStats;
+}
+
 inline void Map::setDepthScale(const float depthScale)
 {
+	priv_finishAsyncUpdate(true);
 	m_depthMultiplier = depthScale > 0.f ? 1.f / depthScale : 0.f;
 	update();
 }
 
 inline void Map::setVanishingPointOffsetFromCenter(const sf::Vector2f vanishingPointOffsetFromCenter)
 {
+	priv_finishAsyncUpdate(true);
 	m_vanishingPointOffsetFromCenter = vanishingPointOffsetFromCenter;
 	update();
 }
@@ -132,6 +537,7 @@ inline sf::Vector2f Map::getVanishingPointOffsetCenter() const
 
 inline void Map::setDepthOffset(const float depthOffset)
 {
+	priv_finishAsyncUpdate(true);
 	m_depthOffset = depthOffset;
 	update();
 }
@@ -166,26 +572,13 @@ inline Map::GridTileId Map::getGridTileIdAtLocalCoord(const sf::Vector2f localCo
 		if (grid.zOrder < zOrder)
 			continue;
 
-		const std::size_t numberOfTileIds{ grid.tileIds.size() };
-		for (std::size_t t{ 0u }; t < numberOfTileIds; ++t)
+		const std::size_t tileIndex{ priv_getGridTileIndexAtLocalCoord(g, localCoord) };
+		if (tileIndex < grid.getNumberOfTiles())
 		{
-			const sf::Vector2<std::size_t> location{ t % grid.rowWidth, t / grid.rowWidth };
-			
-			sf::Vector2f topLeft{ grid.position };
-
-			topLeft.x += static_cast<float>(location.x * grid.tileSize.x);
-			topLeft.y += static_cast<float>(location.y * grid.tileSize.y);
-
-			const sf::FloatRect tileRect{ topLeft, grid.tileSize };
-
-			if (tileRect.contains(localCoord))
-			{
-				zOrder = grids[g].zOrder;
-				gridTileId.gridIndex = g;
-				gridTileId.tileIndex = t;
-				tileFound = true;
-				break;
-			}
+			zOrder = grid.zOrder;
+			gridTileId.gridIndex = g;
+			gridTileId.tileIndex = tileIndex;
+			tileFound = true;
 		}
 	}
 
@@ -208,26 +601,13 @@ inline std::vector<Map::GridTileId> Map::getGridTileIdsAtLocalCoord(sf::Vector2f
 		if ((!grid.isActive) || (grid.depth < 0.f))
 			continue;
 
-		const std::size_t numberOfTileIds{ grid.tileIds.size() };
-		for (std::size_t t{ 0u }; t < numberOfTileIds; ++t)
+		const std::size_t tileIndex{ priv_getGridTileIndexAtLocalCoord(g, localCoord) };
+		if (tileIndex < grid.getNumberOfTiles())
 		{
-			const sf::Vector2<std::size_t> location{ t % grid.rowWidth, t / grid.rowWidth };
-
-			sf::Vector2f topLeft{ grid.position };
-
-			topLeft.x += static_cast<float>(location.x * grid.tileSize.x);
-			topLeft.y += static_cast<float>(location.y * grid.tileSize.y);
-
-			const sf::FloatRect tileRect{ topLeft, grid.tileSize };
-
-			if (tileRect.contains(localCoord))
-			{
-				GridTileId gridTileId{};
-				gridTileId.gridIndex = g;
-				gridTileId.tileIndex = t;
-				gridTileIds.push_back(gridTileId);
-				break;
-			}
+			GridTileId gridTileId{};
+			gridTileId.gridIndex = g;
+			gridTileId.tileIndex = tileIndex;
+			gridTileIds.push_back(gridTileId);
 		}
 	}
 
@@ -245,6 +625,7 @@ inline Map::LayerTileId Map::getLayerTileIdAtLocalCoord(sf::Vector2f localCoord)
 
 	std::size_t zOrder{ 0u };
 
+	std::vector<std::size_t> candidateTiles{};
 	for (std::size_t l{ 0u }; l < numberOfLayers; ++l)
 	{
 		const Layer& layer{ layers[l] };
@@ -254,33 +635,13 @@ inline Map::LayerTileId Map::getLayerTileIdAtLocalCoord(sf::Vector2f localCoord)
 		if (layer.zOrder < zOrder)
 			continue;
 
-		const std::size_t numberOfTiles{ layer.tiles.size() };
-		for (std::size_t t{ 0u }; t < numberOfTiles; ++t)
+		const std::size_t tileIndex{ priv_getLayerTileIndexAtLocalCoord(l, localCoord, candidateTiles) };
+		if (tileIndex < layer.tiles.size())
 		{
-			const cm::Tile& tile{ layer.tiles[t] };
-			if ((!layer.isActive) || (!(layer.depth < 0.f)))
-				continue;
-
-			const sf::Vector2f topLeft{ layer.offset + tile.position };
-
-			sf::Vector2f tileSize{ tile.size };
-			if (tile.isTemplate)
-			{
-				const sf::Vector2f tileTemplateSize{ tileTemplates[tile.id].size };
-				tileSize.x *= tileTemplateSize.x;
-				tileSize.y *= tileTemplateSize.y;
-			}
-
-			const sf::FloatRect tileRect{ topLeft, tileSize };
-
-			if (tileRect.contains(localCoord))
-			{
-				zOrder = layers[l].zOrder;
-				layerTileId.layerIndex = l;
-				layerTileId.tileIndex = t;
-				tileFound = true;
-				break;
-			}
+			zOrder = layer.zOrder;
+			layerTileId.layerIndex = l;
+			layerTileId.tileIndex = tileIndex;
+			tileFound = true;
 		}
 	}
 
@@ -297,147 +658,2474 @@ inline std::vector<Map::LayerTileId> Map::getLayerTileIdsAtLocalCoord(sf::Vector
 	if (numberOfLayers == 0u)
 		return layerTileIds;
 
+	std::vector<std::size_t> candidateTiles{};
 	for (std::size_t l{ 0u }; l < numberOfLayers; ++l)
 	{
 		const Layer& layer{ layers[l] };
 		if ((!layer.isActive) || (layer.depth < 0.f))
 			continue;
 
-		const std::size_t numberOfTiles{ layer.tiles.size() };
-		for (std::size_t t{ 0u }; t < numberOfTiles; ++t)
+		const std::size_t tileIndex{ priv_getLayerTileIndexAtLocalCoord(l, localCoord, candidateTiles) };
+		if (tileIndex < layer.tiles.size())
 		{
-			const cm::Tile& tile{ layer.tiles[t] };
-			if (!tile.isActive)
-				continue;
-
-			const sf::Vector2f topLeft{ layer.offset + tile.position };
-
-			sf::Vector2f tileSize{ tile.size };
-			if (tile.isTemplate)
-			{
-				const sf::Vector2f tileTemplateSize{ tileTemplates[tile.id].size };
-				tileSize.x *= tileTemplateSize.x;
-				tileSize.y *= tileTemplateSize.y;
-			}
-
-			const sf::FloatRect tileRect{ topLeft, tileSize };
-
-			if (tileRect.contains(localCoord))
-			{
-				LayerTileId layerTileId{};
-				layerTileId.layerIndex = l;
-				layerTileId.tileIndex = t;
-				layerTileIds.push_back(layerTileId);
-				break;
-			}
+			LayerTileId layerTileId{};
+			layerTileId.layerIndex = l;
+			layerTileId.tileIndex = tileIndex;
+			layerTileIds.push_back(layerTileId);
 		}
 	}
 
 	return layerTileIds;
 }
 
-inline std::size_t Map::getGridTileIndexAtGridLocation(const std::size_t gridIndex, const sf::Vector2<std::size_t> location) const
+inline Map::SparseGridTileId Map::getSparseGridTileIdAtLocalCoord(const sf::Vector2f localCoord) const
 {
-	const std::size_t numberOfGrids{ grids.size() };
-	if ((numberOfGrids == 0u) || (gridIndex >= numberOfGrids))
-		return{};
+	const std::size_t numberOfSparseGrids{ sparseGrids.size() };
+	SparseGridTileId sparseGridTileId{ numberOfSparseGrids, 0u };
+	for (std::size_t s{ 0u }; s < numberOfSparseGrids; ++s)
+	{
+		const SparseGrid& sparseGrid{ sparseGrids[s] };
+		if ((!sparseGrid.isActive) || (sparseGrid.depth < 0.f))
+			continue;
 
-	return (location.y * grids[gridIndex].rowWidth) + location.x;
-}
+		if ((sparseGridTileId.sparseGridIndex < numberOfSparseGrids) && (sparseGrid.zOrder < sparseGrids[sparseGridTileId.sparseGridIndex].zOrder))
+			continue;
 
-inline std::size_t Map::getGridHeight(const std::size_t gridIndex) const
-{
-	return grids[gridIndex].tileIds.size() / grids[gridIndex].rowWidth;
+		const std::size_t tileIndex{ priv_getSparseGridTileIndexAtLocalCoord(s, localCoord) };
+		if (tileIndex != noQuad)
+			sparseGridTileId = { s, tileIndex };
+	}
+
+	return sparseGridTileId;
 }
 
-inline bool Map::doesGridBoundsContainCoord(const std::size_t gridIndex, const sf::Vector2f localCoord) const
+inline std::vector<Map::SparseGridTileId> Map::getSparseGridTileIdsAtLocalCoord(const sf::Vector2f localCoord) const
 {
-	const std::size_t numberOfGrids{ grids.size() };
-	if ((numberOfGrids == 0u) || (gridIndex >= numberOfGrids))
-		return false;
-
-	const Grid& grid{ grids[gridIndex] };
+	std::vector<SparseGridTileId> sparseGridTileIds{};
+	for (std::size_t s{ 0u }, numberOfSparseGrids{ sparseGrids.size() }; s < numberOfSparseGrids; ++s)
+	{
+		const SparseGrid& sparseGrid{ sparseGrids[s] };
+		if ((!sparseGrid.isActive) || (sparseGrid.depth < 0.f))
+			continue;
 
-	const sf::Vector2f tileSize{ grid.tileSize };
-	const sf::Vector2f topLeft{ grid.position };
-	const sf::Vector2f bottomRight{ topLeft.x + (grid.rowWidth * tileSize.x), topLeft.y + (getGridHeight(gridIndex) * tileSize.y) };
+		const std::size_t tileIndex{ priv_getSparseGridTileIndexAtLocalCoord(s, localCoord) };
+		if (tileIndex != noQuad)
+			sparseGridTileIds.push_back({ s, tileIndex });
+	}
 
-	return !((localCoord.x < topLeft.x) || (localCoord.y < topLeft.y) || (localCoord.x >= bottomRight.x) || (localCoord.y >= bottomRight.y));
+	return sparseGridTileIds;
 }
 
+inline void Map::getGridTileIdsInLocalRectangle(const sf::FloatRect localRectangle, std::vector<GridTileId>& gridTileIds) const
+{
+	gridTileIds.clear();
+	if ((localRectangle.size.x <= 0.f) || (localRectangle.size.y <= 0.f))
+		return;
 
+	for (std::size_t g{ 0u }, numberOfGrids{ grids.size() }; g < numberOfGrids; ++g)
+	{
+		const Grid& grid{ grids[g] };
+		const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+		if ((!grid.isActive) || (grid.depth < 0.f) || (numberOfTiles == 0u) || (grid.rowWidth == 0u) || (grid.tileSize.x <= 0.f) || (grid.tileSize.y <= 0.f))
+			continue;
 
+		// the range of cells that the rectangle (with the grid's depth removed) covers
+		const float depthRatio{ priv_getDepthRatio(grid.depth) };
+		const sf::FloatRect gridRectangle{ (depthRatio == 1.f) ? localRectangle : priv_rectangleWithoutDepth(localRectangle, depthRatio) };
+		const sf::Vector2f topLeft{ gridRectangle.position - grid.position };
+		const sf::Vector2f bottomRight{ topLeft + gridRectangle.size };
+		const std::size_t numberOfRows{ ((numberOfTiles - 1u) / grid.rowWidth) + 1u };
+		const float columnBegin{ std::max(std::floor(topLeft.x / grid.tileSize.x), 0.f) };
+		const float columnEnd{ std::min(std::ceil(bottomRight.x / grid.tileSize.x), static_cast<float>(grid.rowWidth)) };
+		const float rowBegin{ std::max(std::floor(topLeft.y / grid.tileSize.y), 0.f) };
+		const float rowEnd{ std::min(std::ceil(bottomRight.y / grid.tileSize.y), static_cast<float>(numberOfRows)) };
+		if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+			continue;
 
+		for (std::size_t y{ static_cast<std::size_t>(rowBegin) }, lastRow{ static_cast<std::size_t>(rowEnd) }; y < lastRow; ++y)
+		{
+			for (std::size_t x{ static_cast<std::size_t>(columnBegin) }, lastColumn{ static_cast<std::size_t>(columnEnd) }, t{ (y * grid.rowWidth) + x }; (x < lastColumn) && (t < numberOfTiles); ++x, ++t)
+				gridTileIds.push_back({ g, t });
+		}
+	}
+}
 
+inline void Map::getLayerTileIdsInLocalRectangle(const sf::FloatRect localRectangle, std::vector<LayerTileId>& layerTileIds) const
+{
+	layerTileIds.clear();
+	std::vector<std::size_t> candidateTiles{};
+	for (std::size_t l{ 0u }, numberOfLayers{ layers.size() }; l < numberOfLayers; ++l)
+	{
+		const Layer& layer{ layers[l] };
+		if ((!layer.isActive) || (layer.depth < 0.f))
+			continue;
 
+		const float depthRatio{ priv_getDepthRatio(layer.depth) };
+		const sf::FloatRect layerRectangle{ (depthRatio == 1.f) ? localRectangle : priv_rectangleWithoutDepth(localRectangle, depthRatio) };
+		auto testTile = [&](const std::size_t t)
+		{
+			const Tile& tile{ layer.tiles[t] };
+			if (!tile.isActive)
+				return;
 
+			sf::FloatRect tileRect{ priv_getLayerTileBounds(tile) };
+			tileRect.position += layer.offset;
+			if (tileRect.findIntersection(layerRectangle))
+				layerTileIds.push_back({ l, t });
+		};
 
+		// the spatial index finds tiles in ascending order so that the results are in tile order either way
+		const SpatialIndex* spatialIndex{ priv_getLayerSpatialIndex(l) };
+		if (spatialIndex != nullptr)
+		{
+			candidateTiles.clear();
+			spatialIndex->query({ layerRectangle.position - layer.offset, layerRectangle.size }, candidateTiles);
+			for (const std::size_t t : candidateTiles)
+				testTile(t);
+		}
+		else
+		{
+			for (std::size_t t{ 0u }, numberOfTiles{ layer.tiles.size() }; t < numberOfTiles; ++t)
+				testTile(t);
+		}
+	}
+}
 
+inline void Map::getGridTileIdsAtLocalCoords(const sf::Vector2f* const localCoords, const std::size_t numberOfLocalCoords, std::vector<GridTileId>& gridTileIds) const
+{
+	// each grid is tested against every coord in turn, keeping the same choice of grid as getGridTileIdAtLocalCoord
+	const std::size_t numberOfGrids{ grids.size() };
+	gridTileIds.assign(numberOfLocalCoords, { numberOfGrids, 0u });
+	for (std::size_t g{ 0u }; g < numberOfGrids; ++g)
+	{
+		const Grid& grid{ grids[g] };
+		if ((!grid.isActive) || (grid.depth < 0.f))
+			continue;
 
+		for (std::size_t i{ 0u }; i < numberOfLocalCoords; ++i)
+		{
+			GridTileId& gridTileId{ gridTileIds[i] };
+			if ((gridTileId.gridIndex < numberOfGrids) && (grid.zOrder < grids[gridTileId.gridIndex].zOrder))
+				continue;
 
+			const std::size_t tileIndex{ priv_getGridTileIndexAtLocalCoord(g, localCoords[i]) };
+			if (tileIndex < grid.getNumberOfTiles())
+				gridTileId = { g, tileIndex };
+		}
+	}
+}
 
+inline void Map::getLayerTileIdsAtLocalCoords(const sf::Vector2f* const localCoords, const std::size_t numberOfLocalCoords, std::vector<LayerTileId>& layerTileIds) const
+{
+	// each layer is tested against every coord in turn, keeping the same choice of layer as getLayerTileIdAtLocalCoord
+	// layers without a spatial index put the coords into a temporary one instead so that each of their tiles is only tested once (against the coords near it)
+	const std::size_t numberOfLayers{ layers.size() };
+	layerTileIds.assign(numberOfLocalCoords, { numberOfLayers, 0u });
+	std::vector<std::size_t> candidateTiles{};
+	std::vector<std::size_t> coordIndices{}; // the coords that the layer can be chosen for
+	std::vector<sf::Vector2f> layerCoords{}; // those coords with the layer's depth removed
+	std::vector<bool> areCoordsFound{};
+	std::vector<std::size_t> candidateCoords{};
+	SpatialIndex coordSpatialIndex{};
+	for (std::size_t l{ 0u }; l < numberOfLayers; ++l)
+	{
+		const Layer& layer{ layers[l] };
+		if ((!layer.isActive) || (layer.depth < 0.f))
+			continue;
 
+		coordIndices.clear();
+		for (std::size_t i{ 0u }; i < numberOfLocalCoords; ++i)
+		{
+			const LayerTileId& layerTileId{ layerTileIds[i] };
+			if ((layerTileId.layerIndex >= numberOfLayers) || (layer.zOrder >= layers[layerTileId.layerIndex].zOrder))
+				coordIndices.push_back(i);
+		}
+		if (coordIndices.empty())
+			continue;
 
+		if (priv_getLayerSpatialIndex(l) != nullptr)
+		{
+			for (const std::size_t i : coordIndices)
+			{
+				const std::size_t tileIndex{ priv_getLayerTileIndexAtLocalCoord(l, localCoords[i], candidateTiles) };
+				if (tileIndex < layer.tiles.size())
+					layerTileIds[i] = { l, tileIndex };
+			}
+			continue;
+		}
+
+		// tiles are tested in order so each coord takes the first tile that contains it (the same as priv_getLayerTileIndexAtLocalCoord)
+		const float depthRatio{ priv_getDepthRatio(layer.depth) };
+		layerCoords.clear();
+		for (const std::size_t i : coordIndices)
+			layerCoords.push_back((depthRatio == 1.f) ? localCoords[i] : priv_pointWithoutDepth(localCoords[i], depthRatio));
+		coordSpatialIndex.build(layerCoords.size(), [&](const std::size_t c) { return sf::FloatRect{ layerCoords[c], { 0.f, 0.f } }; });
+		areCoordsFound.assign(layerCoords.size(), false);
+		std::size_t numberOfCoordsRemaining{ layerCoords.size() };
+		for (std::size_t t{ 0u }, numberOfTiles{ layer.tiles.size() }; (t < numberOfTiles) && (numberOfCoordsRemaining > 0u); ++t)
+		{
+			const Tile& tile{ layer.tiles[t] };
+			if (!tile.isActive)
+				continue;
+
+			sf::FloatRect tileRect{ priv_getLayerTileBounds(tile) };
+			tileRect.position += layer.offset;
+			candidateCoords.clear();
+			coordSpatialIndex.query(tileRect, candidateCoords);
+			for (const std::size_t c : candidateCoords)
+			{
+				if (areCoordsFound[c] || !tileRect.contains(layerCoords[c]))
+					continue;
+
+				areCoordsFound[c] = true;
+				--numberOfCoordsRemaining;
+				layerTileIds[coordIndices[c]] = { l, t };
+			}
+		}
+	}
+}
+
+inline void Map::getSparseGridTileIdsInLocalRectangle(const sf::FloatRect localRectangle, std::vector<SparseGridTileId>& sparseGridTileIds) const
+{
+	sparseGridTileIds.clear();
+	if ((localRectangle.size.x <= 0.f) || (localRectangle.size.y <= 0.f))
+		return;
+
+	constexpr std::size_t rowWidth{ SparseGrid::rowWidth };
+	constexpr std::size_t chunkSize{ SparseGrid::chunkSize };
+	std::vector<SparseGridChunk> sparseGridChunks{};
+	for (std::size_t s{ 0u }, numberOfSparseGrids{ sparseGrids.size() }; s < numberOfSparseGrids; ++s)
+	{
+		const SparseGrid& sparseGrid{ sparseGrids[s] };
+		if ((!sparseGrid.isActive) || (sparseGrid.depth < 0.f) || (sparseGrid.getNumberOfChunks() == 0u) || (sparseGrid.tileSize.x <= 0.f) || (sparseGrid.tileSize.y <= 0.f))
+			continue;
+
+		// the range of cells that the rectangle (with the sparse grid's depth removed) covers (the same as getGridTileIdsInLocalRectangle)
+		const float depthRatio{ priv_getDepthRatio(sparseGrid.depth) };
+		const sf::FloatRect gridRectangle{ (depthRatio == 1.f) ? localRectangle : priv_rectangleWithoutDepth(localRectangle, depthRatio) };
+		const sf::Vector2f topLeft{ gridRectangle.position - sparseGrid.position };
+		const sf::Vector2f bottomRight{ topLeft + gridRectangle.size };
+		const float columnBegin{ std::max(std::floor(topLeft.x / sparseGrid.tileSize.x), 0.f) };
+		const float columnEnd{ std::min(std::ceil(bottomRight.x / sparseGrid.tileSize.x), static_cast<float>(rowWidth)) };
+		const float rowBegin{ std::max(std::floor(topLeft.y / sparseGrid.tileSize.y), 0.f) };
+		const float rowEnd{ std::min(std::ceil(bottomRight.y / sparseGrid.tileSize.y), static_cast<float>(rowWidth)) };
+		if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+			continue;
+
+		const std::size_t firstColumn{ static_cast<std::size_t>(columnBegin) };
+		const std::size_t lastColumn{ static_cast<std::size_t>(columnEnd) };
+		const std::size_t firstRow{ static_cast<std::size_t>(rowBegin) };
+		const std::size_t lastRow{ static_cast<std::size_t>(rowEnd) };
+		priv_getSparseGridChunks(sparseGrid, { firstColumn / chunkSize, firstRow / chunkSize }, { ((lastColumn - 1u) / chunkSize) + 1u, ((lastRow - 1u) / chunkSize) + 1u }, sparseGridChunks);
+
+		// only stored chunks are tested. they are found chunk by chunk so the sparse grid's tiles are then put in tile order
+		const std::size_t firstSparseGridTileId{ sparseGridTileIds.size() };
+		for (const SparseGridChunk& sparseGridChunk : sparseGridChunks)
+		{
+			const std::size_t chunkColumn{ sparseGridChunk.location.x * chunkSize };
+			const std::size_t chunkRow{ sparseGridChunk.location.y * chunkSize };
+			for (std::size_t y{ std::max(chunkRow, firstRow) }, chunkLastRow{ std::min(chunkRow + chunkSize, lastRow) }; y < chunkLastRow; ++y)
+			{
+				for (std::size_t x{ std::max(chunkColumn, firstColumn) }, chunkLastColumn{ std::min(chunkColumn + chunkSize, lastColumn) }; x < chunkLastColumn; ++x)
+				{
+					if (sparseGridChunk.tileIds[((y - chunkRow) * chunkSize) + (x - chunkColumn)] != sparseGrid.invisibleId)
+						sparseGridTileIds.push_back({ s, (y * rowWidth) + x });
+				}
+			}
+		}
+		std::sort(sparseGridTileIds.begin() + firstSparseGridTileId, sparseGridTileIds.end(), [](const SparseGridTileId& lhs, const SparseGridTileId& rhs) { return lhs.tileIndex < rhs.tileIndex; });
+	}
+}
+
+inline void Map::getSparseGridTileIdsAtLocalCoords(const sf::Vector2f* const localCoords, const std::size_t numberOfLocalCoords, std::vector<SparseGridTileId>& sparseGridTileIds) const
+{
+	// each sparse grid is tested against every coord in turn, keeping the same choice of sparse grid as getSparseGridTileIdAtLocalCoord
+	const std::size_t numberOfSparseGrids{ sparseGrids.size() };
+	sparseGridTileIds.assign(numberOfLocalCoords, { numberOfSparseGrids, 0u });
+	for (std::size_t s{ 0u }; s < numberOfSparseGrids; ++s)
+	{
+		const SparseGrid& sparseGrid{ sparseGrids[s] };
+		if ((!sparseGrid.isActive) || (sparseGrid.depth < 0.f))
+			continue;
+
+		for (std::size_t i{ 0u }; i < numberOfLocalCoords; ++i)
+		{
+			SparseGridTileId& sparseGridTileId{ sparseGridTileIds[i] };
+			if ((sparseGridTileId.sparseGridIndex < numberOfSparseGrids) && (sparseGrid.zOrder < sparseGrids[sparseGridTileId.sparseGridIndex].zOrder))
+				continue;
+
+			const std::size_t tileIndex{ priv_getSparseGridTileIndexAtLocalCoord(s, localCoords[i]) };
+			if (tileIndex != noQuad)
+				sparseGridTileId = { s, tileIndex };
+		}
+	}
+}
+
+inline std::size_t Map::getGridTileIndexAtGridLocation(const std::size_t gridIndex, const sf::Vector2<std::size_t> location) const
+{
+	const std::size_t numberOfGrids{ grids.size() };
+	if ((numberOfGrids == 0u) || (gridIndex >= numberOfGrids))
+		return{};
+
+	return (location.y * grids[gridIndex].rowWidth) + location.x;
+}
+
+inline std::size_t Map::getGridHeight(const std::size_t gridIndex) const
+{
+	return grids[gridIndex].getNumberOfTiles() / grids[gridIndex].rowWidth;
+}
+
+inline std::size_t Map::getSparseGridTileIndexAtGridLocation(const std::size_t sparseGridIndex, const sf::Vector2<std::size_t> location) const
+{
+	if (sparseGridIndex >= sparseGrids.size())
+		return{};
+
+	return (location.y * SparseGrid::rowWidth) + location.x;
+}
+
+inline bool Map::doesGridBoundsContainCoord(const std::size_t gridIndex, const sf::Vector2f localCoord) const
+{
+	const std::size_t numberOfGrids{ grids.size() };
+	if ((numberOfGrids == 0u) || (gridIndex >= numberOfGrids))
+		return false;
+
+	const Grid& grid{ grids[gridIndex] };
+
+	const sf::Vector2f tileSize{ grid.tileSize };
+	const sf::Vector2f topLeft{ grid.position };
+	const sf::Vector2f bottomRight{ topLeft.x + (grid.rowWidth * tileSize.x), topLeft.y + (getGridHeight(gridIndex) * tileSize.y) };
+
+	return !((localCoord.x < topLeft.x) || (localCoord.y < topLeft.y) || (localCoord.x >= bottomRight.x) || (localCoord.y >= bottomRight.y));
+}
+
+template <class VertexRunFunction>
+inline void Map::forEachVertexRun(VertexRunFunction vertexRunFunction) const
+{
+	if (m_isUpdateRequired || m_asyncUpdate.valid())
+		priv_update();
+	if (m_isAnimationUpdateRequired)
+		priv_updateAnimatedQuads();
+
+	priv_forEachRun([&](const VertexRun& vertexRun, Chunk*) { vertexRunFunction(vertexRun); });
+}
+
+inline void Map::getVertices(std::vector<sf::Vertex>& vertices) const
+{
+	vertices.clear();
+	forEachVertexRun([&](const VertexRun& vertexRun)
+	{
+		const std::size_t firstVertex{ vertices.size() };
+		vertices.insert(vertices.end(), vertexRun.vertices, vertexRun.vertices + vertexRun.numberOfVertices);
+		if (vertexRun.transform == sf::Transform::Identity)
+			return;
+		for (auto vertex{ vertices.begin() + firstVertex }; vertex != vertices.end(); ++vertex)
+			vertex->position = vertexRun.transform.transformPoint(vertex->position);
+	});
+}
+
+template <class VertexRunFunction>
+inline void Map::build(const sf::View& view, VertexRunFunction vertexRunFunction)
+{
+	update(view);
+	waitForUpdate();
+	forEachVertexRun(std::move(vertexRunFunction));
+}
+
+inline void Map::build(const sf::View& view, std::vector<sf::Vertex>& vertices)
+{
+	update(view);
+	waitForUpdate();
+	getVertices(vertices);
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+// PRIVATE
+
+inline void Map::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	CHEESEMAP_PROFILE_ZONE("CheeseMap draw");
+
+	if (m_textures.empty())
+		return;
+
+	states.transform *= getTransform();
+	states.texture = m_textures.front();
+
+	if (m_isUpdateRequired || m_asyncUpdate.valid())
+		priv_update();
+	if (m_isAnimationUpdateRequired)
+		priv_updateAnimatedQuads();
+
+	if (!m_useChunks && !m_useDepthTransforms && m_texturePages.empty() && priv_isVertexArrayPacked())
+	{
+		if (states.texture != nullptr)
+			target.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Triangles, states);
+		return;
+	}
+
+	// runs are drawn in order: chunks are drawn from their vertex buffers and consecutive runs from the vertex array (with the same transform and texture page) are drawn together
+	// runs of a texture page that has no texture are not drawn
+	m_chunkInfo.numberOfVerticesUploaded = 0u;
+	const sf::Vertex* pendingVertices{ nullptr };
+	std::size_t numberOfPendingVertices{ 0u };
+	sf::Transform pendingTransform{};
+	std::size_t pendingTexturePage{ 0u };
+	auto getRunStates = [&](const sf::Transform& transform, const std::size_t texturePage)
+	{
+		sf::RenderStates runStates{ states };
+		if (transform != sf::Transform::Identity)
+			runStates.transform *= transform;
+		runStates.texture = (texturePage < m_textures.size()) ? m_textures[texturePage] : nullptr;
+		return runStates;
+	};
+	auto drawPending = [&]()
+	{
+		if (numberOfPendingVertices == 0u)
+			return;
+		const sf::RenderStates runStates{ getRunStates(pendingTransform, pendingTexturePage) };
+		if (runStates.texture != nullptr)
+			target.draw(pendingVertices, numberOfPendingVertices, sf::PrimitiveType::Triangles, runStates);
+		numberOfPendingVertices = 0u;
+	};
+	priv_forEachRun([&](const VertexRun& vertexRun, Chunk* const chunk)
+	{
+		if (chunk != nullptr)
+		{
+			drawPending();
+			const sf::RenderStates runStates{ getRunStates(vertexRun.transform, vertexRun.texturePage) };
+			if (runStates.texture != nullptr)
+				priv_drawChunk(target, runStates, *chunk, static_cast<std::size_t>(vertexRun.vertices - chunk->vertices.data()), vertexRun.numberOfVertices);
+			return;
+		}
+		if ((pendingVertices + numberOfPendingVertices != vertexRun.vertices) || (pendingTransform != vertexRun.transform) || (pendingTexturePage != vertexRun.texturePage))
+			drawPending();
+		if (numberOfPendingVertices == 0u)
+		{
+			pendingVertices = vertexRun.vertices;
+			pendingTransform = vertexRun.transform;
+			pendingTexturePage = vertexRun.texturePage;
+		}
+		numberOfPendingVertices += vertexRun.numberOfVertices;
+	});
+	drawPending();
+}
+
+inline void Map::priv_update() const
+{
+	CHEESEMAP_PROFILE_ZONE("CheeseMap update");
+
+	// asynchronous updates: a completed update is swapped in and then the next one is started (if required)
+	if (m_isAsync)
+	{
+		if (priv_finishAsyncUpdate(false) && m_isUpdateRequired)
+			priv_startAsyncUpdate();
+		return;
+	}
+
+	m_isUpdateRequired = false;
+	m_isAnimationIndexValid = false;
+	for (auto& groupChunks : m_groupChunks)
+		groupChunks.numberOfChunksBuilt = 0u;
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	UpdateStats* const updateStats{ m_isCollectingUpdateStats ? &m_updateStats : nullptr };
+	std::chrono::steady_clock::time_point updateStart{};
+	if (updateStats != nullptr)
+	{
+		*updateStats = {};
+		updateStats->isFullUpdate = m_isFullUpdateRequired;
+		updateStart = std::chrono::steady_clock::now();
+	}
+#else // CHEESEMAP_NO_UPDATE_STATS
+	UpdateStats* const updateStats{ nullptr };
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	// a full update builds for the view plus the view margin. that rectangle is also used by partial updates until the next full update
+	if (m_isFullUpdateRequired)
+	{
+		const sf::FloatRect viewRectangle{ priv_getEffectiveViewRectangle(m_view) };
+		m_builtView = m_view;
+		m_builtViewRectangle = { viewRectangle.position - m_viewMargin, viewRectangle.size + (m_viewMargin * 2.f) };
+	}
+	const sf::FloatRect effectiveViewRectangle{ m_builtViewRectangle };
+
+	// when only some groups (or grid tiles) have changed, only their vertices are rebuilt
+	// if that changes which groups are drawn (or their order), the vertex array is reassembled and only those groups are culled again
+	std::vector<std::size_t> activeTiles{};
+	std::vector<GroupId> reorderedGroups{};
+	if (!m_isFullUpdateRequired)
+	{
+		for (const GroupId& groupId : m_groupsRequiringUpdate)
+		{
+			if (!priv_updateGroup(groupId, effectiveViewRectangle, activeTiles))
+				reorderedGroups.push_back(groupId);
+		}
+		for (const GridTileId& gridTileId : m_gridTilesRequiringUpdate)
+		{
+			if (!priv_updateGridTile(gridTileId, effectiveViewRectangle, activeTiles))
+				reorderedGroups.push_back({ GroupType::Grid, gridTileId.gridIndex });
+		}
+	}
+	m_groupsRequiringUpdate.clear();
+	m_gridTilesRequiringUpdate.clear();
+
+	if (m_isFullUpdateRequired)
+	{
+		priv_updateTextureCoords();
+		priv_buildGroups(effectiveViewRectangle, nullptr, m_groupGeometries, m_vertices, updateStats);
+	}
+	else if (!reorderedGroups.empty())
+		priv_buildGroups(effectiveViewRectangle, &reorderedGroups, m_groupGeometries, m_vertices, updateStats);
+	else
+		priv_packVertexArray();
+
+	m_isFullUpdateRequired = false;
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (updateStats != nullptr)
+	{
+		updateStats->totalTime = priv_getStageTime(updateStart);
+		if (m_updateStatsCallback)
+			m_updateStatsCallback(*updateStats);
+	}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+}
+
+inline void Map::priv_startAsyncUpdate() const
+{
+	// every asynchronous update is a full update. spatial indices (and texture transform indices) are prepared here so that the worker thread only reads them
+	m_isUpdateRequired = false;
+	m_isFullUpdateRequired = false;
+	m_groupsRequiringUpdate.clear();
+	m_gridTilesRequiringUpdate.clear();
+	for (std::size_t l{ 0u }, numberOfLayers{ layers.size() }; l < numberOfLayers; ++l)
+		priv_getLayerSpatialIndex(l);
+	for (std::size_t g{ 0u }, numberOfGrids{ grids.size() }; g < numberOfGrids; ++g)
+		priv_getTileTextureTransformIndices(g);
+	priv_updateTextureCoords();
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	UpdateStats* const updateStats{ m_isCollectingUpdateStats ? &m_backUpdateStats : nullptr };
+#else // CHEESEMAP_NO_UPDATE_STATS
+	UpdateStats* const updateStats{ nullptr };
+#endif // CHEESEMAP_NO_UPDATE_STATS
+	m_asyncUpdate = std::async(std::launch::async, [this, updateStats]()
+	{
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+		std::chrono::steady_clock::time_point updateStart{};
+		if (updateStats != nullptr)
+		{
+			*updateStats = {};
+			updateStats->isFullUpdate = true;
+			updateStart = std::chrono::steady_clock::now();
+		}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+		const sf::FloatRect viewRectangle{ priv_getEffectiveViewRectangle(m_view) };
+		priv_buildGroups({ viewRectangle.position - m_viewMargin, viewRectangle.size + (m_viewMargin * 2.f) }, nullptr, m_backGroupGeometries, m_backVertices, updateStats);
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+		if (updateStats != nullptr)
+			updateStats->totalTime = priv_getStageTime(updateStart);
+#endif // CHEESEMAP_NO_UPDATE_STATS
+	}).share();
+}
+
+inline bool Map::priv_finishAsyncUpdate(const bool wait) const
+{
+	// returns false if an asynchronous update is still being built (only if not waiting)
+	if (!m_asyncUpdate.valid())
+		return true;
+	if (!wait && (m_asyncUpdate.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+		return false;
+
+	const std::shared_future<void> asyncUpdate{ std::move(m_asyncUpdate) };
+	m_asyncUpdate = {};
+	asyncUpdate.wait();
+	if (m_isViewPending)
+	{
+		m_view = m_pendingView;
+		m_isViewPending = false;
+	}
+	try
+	{
+		asyncUpdate.get(); // rethrows anything thrown while building (the completed update is not swapped in)
+	}
+	catch (...)
+	{
+		// starting the update cleared these so the next update must build everything again
+		m_isUpdateRequired = true;
+		m_isFullUpdateRequired = true;
+		throw;
+	}
+	m_groupGeometries.swap(m_backGroupGeometries);
+	m_vertices.swap(m_backVertices);
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (m_isCollectingUpdateStats)
+	{
+		m_updateStats = m_backUpdateStats;
+		if (m_updateStatsCallback)
+			m_updateStatsCallback(m_updateStats);
+	}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	// the completed update used the animation frames from when it was started
+	m_isAnimationIndexValid = false;
+	for (auto& animationState : m_animationStates)
+		animationState.isChanged = true;
+	m_isAnimationUpdateRequired = !m_animationStates.empty();
+	return true;
+}
+
+inline void Map::priv_updateTextureCoords() const
+{
+	m_textureCoords.resize(textureAtlas.size());
+	for (std::size_t i{ 0u }, numberOfTextureAtlasRectangles{ textureAtlas.size() }; i < numberOfTextureAtlasRectangles; ++i)
+		m_textureCoords[i] = { textureAtlas[i].position, textureAtlas[i].position + textureAtlas[i].size };
+
+	// texture pages are only looked up if any rectangle is on a page other than 0
+	m_texturePages.clear();
+	const std::size_t numberOfTexturePages{ std::min(textureAtlasPages.size(), textureAtlas.size()) };
+	if (std::any_of(textureAtlasPages.begin(), textureAtlasPages.begin() + numberOfTexturePages, [](const std::size_t texturePage) { return texturePage != 0u; }))
+	{
+		m_texturePages.assign(textureAtlas.size(), 0u);
+		std::copy_n(textureAtlasPages.begin(), numberOfTexturePages, m_texturePages.begin());
+	}
+
+	// animated ids use their animation's current frame
+	m_animationStates.resize(animations.size());
+	for (std::size_t a{ 0u }, numberOfAnimations{ animations.size() }; a < numberOfAnimations; ++a)
+	{
+		if (animations[a].id < m_textureCoords.size())
+			m_textureCoords[animations[a].id] = priv_getAnimationTextureCoords(a);
+	}
+}
+
+inline void Map::priv_updateAnimatedQuads() const
+{
+	CHEESEMAP_PROFILE_ZONE("CheeseMap animate quads");
+
+	// only the texture coordinates of the quads of animations whose frames have changed are set
+	// (the texture coordinates table is also updated unless an asynchronous update is reading it; the next update updates it anyway)
+	m_isAnimationUpdateRequired = false;
+	m_animationStates.resize(animations.size());
+	if (!m_isAnimationIndexValid)
+		priv_updateAnimationIndex();
+
+	for (std::size_t a{ 0u }, numberOfAnimations{ animations.size() }; a < numberOfAnimations; ++a)
+	{
+		AnimationState& animationState{ m_animationStates[a] };
+		if (!animationState.isChanged)
+			continue;
+		animationState.isChanged = false;
+		if (animations[a].id >= textureAtlas.size())
+			continue;
+
+		const TextureCoords textureCoords{ priv_getAnimationTextureCoords(a) };
+		if (!m_asyncUpdate.valid() && (animations[a].id < m_textureCoords.size()))
+			m_textureCoords[animations[a].id] = textureCoords;
+		for (const AnimatedQuad& animatedQuad : animationState.quads)
+		{
+			sf::Vertex* vertices{ m_vertices.data() };
+			if (animatedQuad.groupChunks != noQuad)
+			{
+				Chunk& chunk{ m_groupChunks[animatedQuad.groupChunks].chunks[animatedQuad.chunk] };
+				vertices = chunk.vertices.data();
+				chunk.isUploadRequired = true;
+			}
+			const TextureTransform& textureTransform{ animatedQuad.textureTransform };
+			priv_setQuadTextureCoords(vertices + animatedQuad.startVertex, textureCoords.topLeft + textureTransform.texInset, textureCoords.bottomRight - textureTransform.texInset, textureTransform.flipX, textureTransform.flipY, textureTransform.turn);
+		}
+	}
+}
+
+inline void Map::priv_updateAnimationIndex() const
+{
+	// finds the quads (in the vertex array and in chunks) that use each animation's id
+	m_isAnimationIndexValid = true;
+	for (auto& animationState : m_animationStates)
+		animationState.quads.clear();
+	if (animations.empty())
+		return;
+
+	std::vector<std::size_t> idAnimations(textureAtlas.size(), noQuad);
+	for (std::size_t a{ 0u }, numberOfAnimations{ animations.size() }; a < numberOfAnimations; ++a)
+	{
+		if (animations[a].id < idAnimations.size())
+			idAnimations[animations[a].id] = a;
+	}
+
+	for (const auto& groupGeometry : m_groupGeometries)
+	{
+		const GroupId groupId{ groupGeometry.groupId };
+		const std::vector<TileTextureTransformIndex>* tileTextureTransformIndices{ nullptr };
+		if (groupId.groupType == GroupType::Grid)
+			tileTextureTransformIndices = &priv_getTileTextureTransformIndices(groupId.groupIndex);
+
+		auto addQuad = [&](const std::size_t tileIndex, const std::size_t groupChunksIndex, const std::size_t chunkIndex, const std::size_t startVertex)
+		{
+			std::size_t id{ 0u };
+			TextureTransform textureTransform{};
+			if (groupId.groupType == GroupType::Grid)
+			{
+				const Grid& grid{ grids[groupId.groupIndex] };
+				id = grid.getTileIds()[tileIndex];
+				const auto tileTextureTransformIndex{ std::lower_bound(tileTextureTransformIndices->cbegin(), tileTextureTransformIndices->cend(), TileTextureTransformIndex{ tileIndex, 0u }, [](const TileTextureTransformIndex& lhs, const TileTextureTransformIndex& rhs) { return lhs.tileIndex < rhs.tileIndex; }) };
+				if ((tileTextureTransformIndex != tileTextureTransformIndices->cend()) && (tileTextureTransformIndex->tileIndex == tileIndex))
+					textureTransform = grid.tileTextureTransforms[tileTextureTransformIndex->transformIndex].textureTransform;
+				textureTransform.texInset += grid.texInset;
+			}
+			else if (groupId.groupType == GroupType::SparseGrid)
+			{
+				const SparseGrid& sparseGrid{ sparseGrids[groupId.groupIndex] };
+				id = sparseGrid.getTileId(tileIndex);
+				textureTransform.texInset += sparseGrid.texInset;
+			}
+			else
+			{
+				const Layer& layer{ layers[groupId.groupIndex] };
+				const Tile& tile{ layer.tiles[tileIndex] };
+				id = tile.isTemplate ? tileTemplates[tile.id].id : tile.id;
+				textureTransform = tile.textureTransform;
+				textureTransform.texInset += layer.texInset;
+			}
+			if ((id < idAnimations.size()) && (idAnimations[id] != noQuad))
+				m_animationStates[idAnimations[id]].quads.push_back({ groupChunksIndex, chunkIndex, startVertex, textureTransform });
+		};
+
+		if (groupGeometry.isChunked)
+		{
+			const GroupChunks& groupChunks{ priv_getGroupChunks(groupId) };
+			const std::size_t groupChunksIndex{ static_cast<std::size_t>(&groupChunks - m_groupChunks.data()) };
+			for (std::size_t c{ 0u }, numberOfChunks{ groupChunks.chunks.size() }; c < numberOfChunks; ++c)
+			{
+				const std::vector<std::size_t>& quadTiles{ groupChunks.chunks[c].quadTiles };
+				for (std::size_t q{ 0u }, numberOfQuads{ quadTiles.size() }; q < numberOfQuads; ++q)
+					addQuad(quadTiles[q], groupChunksIndex, c, q * numberOfVerticesPerQuad);
+			}
+		}
+		else
+		{
+			for (std::size_t q{ 0u }, numberOfQuads{ groupGeometry.quadTiles.size() }; q < numberOfQuads; ++q)
+				addQuad(groupGeometry.quadTiles[q], noQuad, 0u, groupGeometry.startVertex + (q * numberOfVerticesPerQuad));
+		}
+	}
+}
+
+inline Map::TextureCoords Map::priv_getAnimationTextureCoords(const std::size_t animationIndex) const
+{
+	// the current frame's texture atlas rectangle (or the animation's own id if the frame's id isn't in the texture atlas)
+	const Animation& animation{ animations[animationIndex] };
+	const std::size_t frame{ m_animationStates[animationIndex].frame };
+	const std::size_t id{ ((frame < animation.frames.size()) && (animation.frames[frame].id < textureAtlas.size())) ? animation.frames[frame].id : animation.id };
+	return{ textureAtlas[id].position, textureAtlas[id].position + textureAtlas[id].size };
+}
+
+inline const std::vector<Map::TileTextureTransformIndex>& Map::priv_getTileTextureTransformIndices(const std::size_t gridIndex) const
+{
+	// the grid's texture transforms ordered by tile index (ties keep their order so that the first one for a tile is found first)
+	// the index is kept until the grid changes (updateGrid, updateGridTile or update)
+	const Grid& grid{ grids[gridIndex] };
+	if (m_gridTextureTransformIndices.size() != grids.size())
+		m_gridTextureTransformIndices.resize(grids.size());
+
+	GridTextureTransformIndex& gridTextureTransformIndex{ m_gridTextureTransformIndices[gridIndex] };
+	if (gridTextureTransformIndex.isValid && (gridTextureTransformIndex.tileTextureTransforms == grid.tileTextureTransforms.data()) && (gridTextureTransformIndex.numberOfTileTextureTransforms == grid.tileTextureTransforms.size()))
+		return gridTextureTransformIndex.tileTextureTransformIndices;
+
+	std::vector<TileTextureTransformIndex>& tileTextureTransformIndices{ gridTextureTransformIndex.tileTextureTransformIndices };
+	tileTextureTransformIndices.resize(grid.tileTextureTransforms.size());
+	for (std::size_t i{ 0u }, numberOfTileTextureTransforms{ tileTextureTransformIndices.size() }; i < numberOfTileTextureTransforms; ++i)
+		tileTextureTransformIndices[i] = { grid.tileTextureTransforms[i].tileIndex, i };
+	auto isLowerTileIndex = [](const TileTextureTransformIndex& lhs, const TileTextureTransformIndex& rhs) { return lhs.tileIndex < rhs.tileIndex; };
+	if (!std::is_sorted(tileTextureTransformIndices.begin(), tileTextureTransformIndices.end(), isLowerTileIndex))
+		std::stable_sort(tileTextureTransformIndices.begin(), tileTextureTransformIndices.end(), isLowerTileIndex);
+	gridTextureTransformIndex.tileTextureTransforms = grid.tileTextureTransforms.data();
+	gridTextureTransformIndex.numberOfTileTextureTransforms = grid.tileTextureTransforms.size();
+	gridTextureTransformIndex.isValid = true;
+	return tileTextureTransformIndices;
+}
+
+inline void Map::priv_buildGroups(const sf::FloatRect& effectiveViewRectangle, const std::vector<GroupId>* changedGroups, std::vector<GroupGeometry>& groupGeometries, std::vector<sf::Vertex>& vertices, UpdateStats* const updateStats) const
+{
+	CHEESEMAP_PROFILE_ZONE("CheeseMap build groups");
+
+	// changedGroups: if provided, only these groups are culled; all other groups keep their current vertices (just moved into their new place)
+	// updateStats: if provided, the counts and times of this build are added to it
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	std::chrono::steady_clock::time_point stageStart{};
+	if (updateStats != nullptr)
+		stageStart = std::chrono::steady_clock::now();
+#endif // CHEESEMAP_NO_UPDATE_STATS
+	std::vector<GroupGeometry> previousGroupGeometries{};
+	std::vector<sf::Vertex> previousVertices{};
+	if (changedGroups != nullptr)
+	{
+		previousGroupGeometries.swap(groupGeometries);
+		previousVertices.swap(vertices);
+	}
+
+	// groups that are drawn, bucketed by z order (each group's z order is read once; groups with the same z order keep their order: layers, grids and then sparse grids)
+	groupGeometries.clear();
+	for (std::size_t l{ 0u }, numberOfLayers{ layers.size() }; l < numberOfLayers; ++l)
+	{
+		const GroupId groupId{ GroupType::Layer, l };
+		if (priv_isGroupDrawn(groupId))
+			groupGeometries.push_back({ groupId, layers[l].zOrder, priv_isGroupChunked(groupId) });
+	}
+	for (std::size_t g{ 0u }, numberOfGrids{ grids.size() }; g < numberOfGrids; ++g)
+	{
+		const GroupId groupId{ GroupType::Grid, g };
+		if (priv_isGroupDrawn(groupId))
+			groupGeometries.push_back({ groupId, grids[g].zOrder, priv_isGroupChunked(groupId) });
+	}
+	for (std::size_t s{ 0u }, numberOfSparseGrids{ sparseGrids.size() }; s < numberOfSparseGrids; ++s)
+	{
+		const GroupId groupId{ GroupType::SparseGrid, s };
+		if (priv_isGroupDrawn(groupId))
+			groupGeometries.push_back({ groupId, sparseGrids[s].zOrder, priv_isGroupChunked(groupId) });
+	}
+	std::stable_sort(groupGeometries.begin(), groupGeometries.end(), [](const GroupGeometry& lhs, const GroupGeometry& rhs) { return lhs.zOrder < rhs.zOrder; });
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (updateStats != nullptr)
+	{
+		const std::size_t numberOfGroupsConsidered{ layers.size() + grids.size() + sparseGrids.size() };
+		updateStats->numberOfGroupsConsidered += numberOfGroupsConsidered;
+		updateStats->numberOfGroupsSkipped += numberOfGroupsConsidered - groupGeometries.size();
+		updateStats->sortTime += priv_getStageTime(stageStart);
+	}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	// groups that keep their previous vertices (the previous start vertex of each group; noQuad if it is culled)
+	const std::size_t numberOfGroups{ groupGeometries.size() };
+	std::vector<std::size_t> previousStartVertices(numberOfGroups, noQuad);
+	std::vector<std::size_t> culledGroups{};
+	for (std::size_t i{ 0u }; i < numberOfGroups; ++i)
+	{
+		GroupGeometry& groupGeometry{ groupGeometries[i] };
+		if (changedGroups != nullptr)
+		{
+			const auto previousGroupGeometry{ std::find_if(previousGroupGeometries.begin(), previousGroupGeometries.end(), [&](const GroupGeometry& gg) { return gg.groupId == groupGeometry.groupId; }) };
+			if ((previousGroupGeometry != previousGroupGeometries.end()) && (previousGroupGeometry->isChunked == groupGeometry.isChunked) && (std::find(changedGroups->begin(), changedGroups->end(), groupGeometry.groupId) == changedGroups->end()))
+			{
+				previousStartVertices[i] = previousGroupGeometry->startVertex;
+				groupGeometry = std::move(*previousGroupGeometry);
+				continue;
+			}
+		}
+		culledGroups.push_back(i);
+	}
+
+	// cull each group into its own active tiles. anything shared between groups (chunk storage, spatial indices, texture transform indices and grid blocks) is prepared first so that the groups can be culled on separate threads
+	for (const std::size_t i : culledGroups)
+	{
+		const GroupId groupId{ groupGeometries[i].groupId };
+		if (groupId.groupType == GroupType::Grid)
+			priv_getTileTextureTransformIndices(groupId.groupIndex);
+		if (groupGeometries[i].isChunked)
+			priv_getGroupChunks(groupId);
+		else if (groupId.groupType == GroupType::Layer)
+			priv_getLayerSpatialIndex(groupId.groupIndex);
+		else if (groupId.groupType == GroupType::Grid)
+		{
+			const std::size_t level{ priv_getGridLevelOfDetail(groupId.groupIndex) };
+			if (level > 0u)
+				priv_getGridLevel(groupId.groupIndex, level);
+		}
+	}
+	std::vector<std::vector<std::size_t>> groupActiveTiles(culledGroups.size());
+	std::vector<std::size_t> groupNumbersOfTilesTested(culledGroups.size());
+	priv_runTasks(culledGroups.size(), [&](const std::size_t c) { groupNumbersOfTilesTested[c] = priv_cullGroup(groupGeometries[culledGroups[c]], effectiveViewRectangle, groupActiveTiles[c]); });
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (updateStats != nullptr)
+	{
+		updateStats->numberOfGroupsCulled += culledGroups.size();
+		for (std::size_t c{ 0u }, numberOfCulledGroups{ culledGroups.size() }; c < numberOfCulledGroups; ++c)
+			priv_addCullStats(*updateStats, groupGeometries[culledGroups[c]].isChunked, groupNumbersOfTilesTested[c], groupActiveTiles[c].size());
+		updateStats->cullTime += priv_getStageTime(stageStart);
+	}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	// lay out the vertex array (each group's vertices are together and in the group's tile order so the result is the same every time)
+	std::size_t numberOfVertices{ 0u };
+	for (std::size_t i{ 0u }, c{ 0u }; i < numberOfGroups; ++i)
+	{
+		GroupGeometry& groupGeometry{ groupGeometries[i] };
+		groupGeometry.startVertex = numberOfVertices;
+		if (previousStartVertices[i] == noQuad)
+			groupGeometry.numberOfVertices = groupActiveTiles[c++].size() * numberOfVerticesPerQuad;
+		groupGeometry.vertexCapacity = groupGeometry.numberOfVertices;
+		numberOfVertices += groupGeometry.numberOfVertices;
+	}
+	vertices.resize(numberOfVertices);
+	for (std::size_t i{ 0u }; i < numberOfGroups; ++i)
+	{
+		if (previousStartVertices[i] != noQuad)
+			std::copy_n(previousVertices.begin() + previousStartVertices[i], groupGeometries[i].numberOfVertices, vertices.begin() + groupGeometries[i].startVertex);
+	}
+
+	// set the culled groups' quads. when using multiple threads, large groups are split into parts that each write their own part of the vertex array
+	struct QuadTask
+	{
+		std::size_t culledGroup;
+		std::size_t firstTile;
+		std::size_t numberOfTiles;
+	};
+	const std::size_t maxNumberOfTilesPerTask{ m_threadPool ? numberOfTilesPerTask : static_cast<std::size_t>(-1) };
+	std::vector<QuadTask> quadTasks{};
+	for (std::size_t c{ 0u }, numberOfCulledGroups{ culledGroups.size() }; c < numberOfCulledGroups; ++c)
+	{
+		for (std::size_t firstTile{ 0u }, numberOfTiles{ groupActiveTiles[c].size() }; firstTile < numberOfTiles; firstTile += std::min(numberOfTiles - firstTile, maxNumberOfTilesPerTask))
+			quadTasks.push_back({ c, firstTile, std::min(numberOfTiles - firstTile, maxNumberOfTilesPerTask) });
+	}
+	priv_runTasks(quadTasks.size(), [&](const std::size_t q)
+	{
+		const QuadTask& quadTask{ quadTasks[q] };
+		const GroupGeometry& groupGeometry{ groupGeometries[culledGroups[quadTask.culledGroup]] };
+		priv_setGroupQuads(groupGeometry.groupId, groupActiveTiles[quadTask.culledGroup].data() + quadTask.firstTile, quadTask.numberOfTiles, vertices.data() + groupGeometry.startVertex + (quadTask.firstTile * numberOfVerticesPerQuad));
+	});
+	for (std::size_t c{ 0u }, numberOfCulledGroups{ culledGroups.size() }; c < numberOfCulledGroups; ++c)
+		groupGeometries[culledGroups[c]].quadTiles = std::move(groupActiveTiles[c]);
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (updateStats != nullptr)
+		updateStats->emitTime += priv_getStageTime(stageStart);
+#else // CHEESEMAP_NO_UPDATE_STATS
+	(void)updateStats;
+#endif // CHEESEMAP_NO_UPDATE_STATS
+}
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+inline void Map::priv_addCullStats(UpdateStats& updateStats, const bool isChunked, const std::size_t numberOfTilesTested, const std::size_t numberOfActiveTiles) const
+{
+	// chunked groups build every tile that they test (into their chunks instead of the vertex array)
+	const std::size_t numberOfQuads{ isChunked ? numberOfTilesTested : numberOfActiveTiles };
+	updateStats.numberOfTilesTested += numberOfTilesTested;
+	updateStats.numberOfTilesCulled += numberOfTilesTested - numberOfQuads;
+	updateStats.numberOfQuads += numberOfQuads;
+	updateStats.numberOfVertexBytes += numberOfQuads * numberOfVerticesPerQuad * sizeof(sf::Vertex);
+}
+
+inline float Map::priv_getStageTime(std::chrono::steady_clock::time_point& stageStart) const
+{
+	// the time (in seconds) since the stage started. the next stage starts now
+	const std::chrono::steady_clock::time_point stageEnd{ std::chrono::steady_clock::now() };
+	const float stageTime{ std::chrono::duration<float>(stageEnd - stageStart).count() };
+	stageStart = stageEnd;
+	return stageTime;
+}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+template <class TaskFunction>
+inline void Map::priv_runTasks(const std::size_t numberOfTasks, TaskFunction task) const
+{
+	if (m_threadPool)
+		m_threadPool->run(numberOfTasks, task);
+	else
+	{
+		for (std::size_t t{ 0u }; t < numberOfTasks; ++t)
+			task(t);
+	}
+}
+
+inline bool Map::priv_updateGroup(const GroupId groupId, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	// returns false if the group can't be updated in its current place (it has been added, removed or moved)
+	const auto groupGeometry{ std::find_if(m_groupGeometries.begin(), m_groupGeometries.end(), [&](const GroupGeometry& gg) { return gg.groupId == groupId; }) };
+	const bool isGroupDrawn{ priv_isGroupDrawn(groupId) };
+	if (groupGeometry == m_groupGeometries.end())
+	{
+		if (isGroupDrawn)
+			return false;
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+		if (m_isCollectingUpdateStats)
+		{
+			++m_updateStats.numberOfGroupsConsidered;
+			++m_updateStats.numberOfGroupsSkipped;
+		}
+#endif // CHEESEMAP_NO_UPDATE_STATS
+		return true;
+	}
+	if (!isGroupDrawn || (groupGeometry->zOrder != priv_getGroupZOrder(groupId)) || (groupGeometry->isChunked != priv_isGroupChunked(groupId)))
+		return false;
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	std::chrono::steady_clock::time_point stageStart{};
+	if (m_isCollectingUpdateStats)
+		stageStart = std::chrono::steady_clock::now();
+	const std::size_t numberOfTilesTested{ priv_cullGroup(*groupGeometry, effectiveViewRectangle, activeTiles) };
+	if (m_isCollectingUpdateStats)
+	{
+		++m_updateStats.numberOfGroupsConsidered;
+		++m_updateStats.numberOfGroupsCulled;
+		priv_addCullStats(m_updateStats, groupGeometry->isChunked, numberOfTilesTested, activeTiles.size());
+		m_updateStats.cullTime += priv_getStageTime(stageStart);
+	}
+#else // CHEESEMAP_NO_UPDATE_STATS
+	priv_cullGroup(*groupGeometry, effectiveViewRectangle, activeTiles);
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	// the group's vertices stay where they are if they fit in its reserved vertices. otherwise, they are moved to the end of the vertex array (with room to grow) so that no other group is moved
+	const std::size_t numberOfVertices{ activeTiles.size() * numberOfVerticesPerQuad };
+	if (numberOfVertices > groupGeometry->vertexCapacity)
+	{
+		groupGeometry->startVertex = m_vertices.size();
+		groupGeometry->vertexCapacity = numberOfVertices + (numberOfVertices / 2u);
+		m_vertices.resize(m_vertices.size() + groupGeometry->vertexCapacity);
+	}
+	groupGeometry->numberOfVertices = numberOfVertices;
+
+	priv_setGroupQuads(groupGeometry->groupId, activeTiles.data(), activeTiles.size(), m_vertices.data() + groupGeometry->startVertex);
+	groupGeometry->quadTiles.assign(activeTiles.begin(), activeTiles.end());
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (m_isCollectingUpdateStats)
+		m_updateStats.emitTime += priv_getStageTime(stageStart);
+#endif // CHEESEMAP_NO_UPDATE_STATS
+	return true;
+}
+
+inline bool Map::priv_isVertexArrayPacked() const
+{
+	// true if the vertex array is every group's vertices in order without any unused vertices between them (so it can be drawn all at once)
+	std::size_t numberOfVertices{ 0u };
+	for (const auto& groupGeometry : m_groupGeometries)
+	{
+		if (groupGeometry.vertexCapacity == 0u)
+			continue;
+		if ((groupGeometry.startVertex != numberOfVertices) || (groupGeometry.numberOfVertices != groupGeometry.vertexCapacity))
+			return false;
+		numberOfVertices += groupGeometry.vertexCapacity;
+	}
+	return numberOfVertices == m_vertices.size();
+}
+
+inline void Map::priv_packVertexArray() const
+{
+	// partial updates leave unused vertices in the vertex array. once there are more of them than used vertices, the groups are packed together again (so each vertex is only moved after at least as many vertices have been updated)
+	std::size_t numberOfVertices{ 0u };
+	for (const auto& groupGeometry : m_groupGeometries)
+		numberOfVertices += groupGeometry.numberOfVertices;
+	if (m_vertices.size() <= numberOfVertices * 2u)
+		return;
+
+	std::vector<sf::Vertex> vertices(numberOfVertices);
+	numberOfVertices = 0u;
+	for (auto& groupGeometry : m_groupGeometries)
+	{
+		std::copy_n(m_vertices.begin() + groupGeometry.startVertex, groupGeometry.numberOfVertices, vertices.begin() + numberOfVertices);
+		groupGeometry.startVertex = numberOfVertices;
+		groupGeometry.vertexCapacity = groupGeometry.numberOfVertices;
+		numberOfVertices += groupGeometry.numberOfVertices;
+	}
+	m_vertices.swap(vertices);
+}
+
+inline bool Map::priv_updateGridTile(const GridTileId gridTileId, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	// returns false if the grid tile can't be updated in its grid's current place (the grid has been added)
+	const GroupId groupId{ GroupType::Grid, gridTileId.gridIndex };
+	const auto groupGeometry{ std::find_if(m_groupGeometries.begin(), m_groupGeometries.end(), [&](const GroupGeometry& gg) { return gg.groupId == groupId; }) };
+	if (groupGeometry == m_groupGeometries.end())
+		return !priv_isGroupDrawn(groupId);
+
+	// the tile's chunk has already been marked as changed so updating the grid only rebuilds that chunk
+	// (grids drawn in blocks are also updated entirely since the tile may change which tile its blocks are drawn as)
+	if (groupGeometry->isChunked || (priv_getGridLevelOfDetail(gridTileId.gridIndex) > 0u))
+		return priv_updateGroup(groupId, effectiveViewRectangle, activeTiles);
+
+	const Grid& grid{ grids[gridTileId.gridIndex] };
+	if (gridTileId.tileIndex >= grid.getNumberOfTiles())
+		return true;
+
+	// a grid without a row width has no cells (it has changed since it was built) so it is updated entirely
+	if (grid.rowWidth == 0u)
+		return priv_updateGroup(groupId, effectiveViewRectangle, activeTiles);
+
+	// tiles outside of the range of cells that were tested cannot be visible
+	const sf::Vector2<std::size_t> location{ gridTileId.tileIndex % grid.rowWidth, gridTileId.tileIndex / grid.rowWidth };
+	if ((location.x < groupGeometry->firstCell.x) || (location.y < groupGeometry->firstCell.y) || (location.x >= groupGeometry->firstCell.x + groupGeometry->numberOfCells.x) || (location.y >= groupGeometry->firstCell.y + groupGeometry->numberOfCells.y))
+		return true;
+
+	const float depthRatio{ priv_getBuiltDepthRatio(groupId) };
+	const std::size_t cellQuad{ groupGeometry->cellQuads[((location.y - groupGeometry->firstCell.y) * groupGeometry->numberOfCells.x) + (location.x - groupGeometry->firstCell.x)] };
+	const bool isTileVisible{ priv_isGridTileVisible(grid, location, gridTileId.tileIndex, depthRatio, groupGeometry->culledRectangle) };
+
+	// if the tile has appeared or disappeared, the number of quads changes so the entire grid is updated
+	if ((cellQuad != noQuad) != isTileVisible)
+		return priv_updateGroup(groupId, effectiveViewRectangle, activeTiles);
+
+	// a tile that is now on a different texture page must be moved to that page's quads
+	if (isTileVisible && !m_texturePages.empty() && (priv_getTileTexturePage(groupId, gridTileId.tileIndex) != priv_getQuadTexturePage(groupGeometry->pageRuns, cellQuad)))
+		return priv_updateGroup(groupId, effectiveViewRectangle, activeTiles);
+
+#ifndef CHEESEMAP_NO_UPDATE_STATS
+	if (m_isCollectingUpdateStats)
+		priv_addCullStats(m_updateStats, false, 1u, isTileVisible ? 1u : 0u);
+#endif // CHEESEMAP_NO_UPDATE_STATS
+
+	if (isTileVisible)
+	{
+		// a single tile only needs a single search so there's no need to order the texture transforms here
+		const auto tileTextureTransform{ std::find_if(grid.tileTextureTransforms.begin(), grid.tileTextureTransforms.end(), [&](const Grid::TileTextureTransform& ttt) { return ttt.tileIndex == gridTileId.tileIndex; }) };
+		priv_setGridTileQuad(m_vertices.data() + groupGeometry->startVertex + (cellQuad * numberOfVerticesPerQuad), gridTileId.gridIndex, gridTileId.tileIndex, (tileTextureTransform != grid.tileTextureTransforms.end()) ? &*tileTextureTransform : nullptr, depthRatio);
+	}
+	return true;
+}
+
+inline bool Map::priv_isGroupDrawn(const GroupId groupId) const
+{
+	bool isActive{ false };
+	float depth{ 0.f };
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+		if (groupId.groupIndex >= grids.size())
+			return false;
+		isActive = grids[groupId.groupIndex].isActive;
+		depth = grids[groupId.groupIndex].depth - m_depthOffset;
+		break;
+	case GroupType::SparseGrid:
+		if (groupId.groupIndex >= sparseGrids.size())
+			return false;
+		isActive = sparseGrids[groupId.groupIndex].isActive;
+		depth = sparseGrids[groupId.groupIndex].depth - m_depthOffset;
+		break;
+	default:
+	case GroupType::Layer:
+		if (groupId.groupIndex >= layers.size())
+			return false;
+		isActive = layers[groupId.groupIndex].isActive;
+		depth = layers[groupId.groupIndex].depth - m_depthOffset;
+		break;
+	}
+	const std::size_t zOrder{ priv_getGroupZOrder(groupId) };
+
+	if ((!isActive) || (depth <= 0.f))
+		return false;
+
+	if (m_useRangeZ && ((zOrder < m_rangeMinZ) || (zOrder > m_rangeMaxZ)))
+		return false;
+	if (m_useRangeDepth && ((depth < m_rangeMinDepth) || (depth > m_rangeMaxDepth)))
+		return false;
+
+	return true;
+}
+
+inline std::size_t Map::priv_getGroupZOrder(const GroupId groupId) const
+{
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+		return grids[groupId.groupIndex].zOrder;
+	case GroupType::SparseGrid:
+		return sparseGrids[groupId.groupIndex].zOrder;
+	default:
+	case GroupType::Layer:
+		return layers[groupId.groupIndex].zOrder;
+	}
+}
+
+inline float Map::priv_getGroupDepth(const GroupId groupId) const
+{
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+		return grids[groupId.groupIndex].depth;
+	case GroupType::SparseGrid:
+		return sparseGrids[groupId.groupIndex].depth;
+	default:
+	case GroupType::Layer:
+		return layers[groupId.groupIndex].depth;
+	}
+}
+
+inline float Map::priv_getBuiltDepthRatio(const GroupId groupId) const
+{
+	// the depth ratio that is built into the group's vertices
+	return m_useDepthTransforms ? 1.f : priv_getDepthRatio(priv_getGroupDepth(groupId));
+}
+
+inline sf::Transform Map::priv_getDepthTransform(const float depthRatio) const
+{
+	// the same as priv_pointWithDepth for the most recent view
+	const sf::View& view{ m_isViewPending ? m_pendingView : m_view };
+	const sf::Vector2f vanishingPoint{ view.getCenter() + m_vanishingPointOffsetFromCenter };
+	sf::Transform transform{};
+	transform.translate(vanishingPoint * (1.f - depthRatio));
+	transform.scale({ depthRatio, depthRatio });
+	return transform;
+}
+
+inline bool Map::priv_isViewWithinMargin(const sf::View& view) const
+{
+	if ((m_viewMargin.x <= 0.f) && (m_viewMargin.y <= 0.f))
+		return false;
+	if ((view.getSize() != m_builtView.getSize()) || (view.getRotation() != m_builtView.getRotation()))
+		return false;
+
+	return priv_isRectangleWithin(priv_getEffectiveViewRectangle(view), m_builtViewRectangle);
+}
+
+inline bool Map::priv_isSameView(const sf::View& view, const sf::View& otherView) const
+{
+	return (view.getCenter() == otherView.getCenter()) && (view.getSize() == otherView.getSize()) && (view.getRotation() == otherView.getRotation());
+}
+
+inline void Map::priv_swapViewSlot(ViewSlot& viewSlot)
+{
+	std::swap(m_view, viewSlot.view);
+	std::swap(m_isUpdateRequired, viewSlot.isUpdateRequired);
+	std::swap(m_isFullUpdateRequired, viewSlot.isFullUpdateRequired);
+	m_groupsRequiringUpdate.swap(viewSlot.groupsRequiringUpdate);
+	m_gridTilesRequiringUpdate.swap(viewSlot.gridTilesRequiringUpdate);
+	m_groupGeometries.swap(viewSlot.groupGeometries);
+	m_vertices.swap(viewSlot.vertices);
+	std::swap(m_builtView, viewSlot.builtView);
+	std::swap(m_builtViewRectangle, viewSlot.builtViewRectangle);
+	m_backGroupGeometries.swap(viewSlot.backGroupGeometries);
+	m_backVertices.swap(viewSlot.backVertices);
+	std::swap(m_isViewPending, viewSlot.isViewPending);
+	std::swap(m_pendingView, viewSlot.pendingView);
+	m_groupChunks.swap(viewSlot.groupChunks);
+	std::swap(m_chunkInfo, viewSlot.chunkInfo);
+	std::swap(m_updateStats, viewSlot.updateStats);
+	std::swap(m_backUpdateStats, viewSlot.backUpdateStats);
+	m_animationStates.swap(viewSlot.animationStates);
+	std::swap(m_isAnimationUpdateRequired, viewSlot.isAnimationUpdateRequired);
+	std::swap(m_isAnimationIndexValid, viewSlot.isAnimationIndexValid);
+}
+
+template <class ViewSlotFunction>
+inline void Map::priv_forEachViewSlot(ViewSlotFunction viewSlotFunction)
+{
+	// viewSlotFunction() is called for each view slot while its state is in the map's members (view slots that aren't selected are swapped in and then back out)
+	viewSlotFunction();
+	for (std::size_t v{ 0u }, numberOfViewSlots{ m_viewSlots.size() }; v < numberOfViewSlots; ++v)
+	{
+		if (v == m_viewSlot)
+			continue;
+		priv_swapViewSlot(m_viewSlots[v]);
+		viewSlotFunction();
+		priv_swapViewSlot(m_viewSlots[v]);
+	}
+}
+
+inline bool Map::priv_isRectangleWithin(const sf::FloatRect& rectangle, const sf::FloatRect& outerRectangle) const
+{
+	return (rectangle.position.x >= outerRectangle.position.x) &&
+		(rectangle.position.y >= outerRectangle.position.y) &&
+		(rectangle.position.x + rectangle.size.x <= outerRectangle.position.x + outerRectangle.size.x) &&
+		(rectangle.position.y + rectangle.size.y <= outerRectangle.position.y + outerRectangle.size.y);
+}
+
+inline bool Map::priv_isGroupChunked(const GroupId groupId) const
+{
+	// chunks are built once so they can only be used by groups whose vertices don't depend on the view
+	if (!m_useChunks || m_isAsync)
+		return false;
+	if ((groupId.groupType == GroupType::Grid) && (priv_getGridLevelOfDetail(groupId.groupIndex) > 0u))
+		return false;
+
+	return priv_getDepthRatio(priv_getGroupDepth(groupId)) == 1.f;
+}
+
+inline std::size_t Map::priv_cullGroup(GroupGeometry& groupGeometry, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	CHEESEMAP_PROFILE_ZONE("CheeseMap cull group");
+
+	// returns the number of tiles that were tested (for chunked groups, the number of tiles built into chunks)
+	// groups drawn with a depth transform are culled without depth (using the rectangle with depth removed)
+	const float depthRatio{ priv_getDepthRatio(priv_getGroupDepth(groupGeometry.groupId)) };
+	groupGeometry.depthRatio = (priv_getBuiltDepthRatio(groupGeometry.groupId) == depthRatio) ? 1.f : depthRatio;
+	if (groupGeometry.depthRatio != 1.f)
+		groupGeometry.culledRectangle = priv_rectangleWithoutDepth(effectiveViewRectangle, depthRatio);
+	else
+		groupGeometry.culledRectangle = effectiveViewRectangle;
+
+	if (groupGeometry.isChunked)
+	{
+		// chunked groups only update their chunks (and which of them are visible) and have no tiles in the vertex array
+		GroupChunks& groupChunks{ priv_getGroupChunks(groupGeometry.groupId) };
+		if (groupGeometry.groupId.groupType == GroupType::Grid)
+			priv_updateGridChunks(groupChunks, groupGeometry.culledRectangle, activeTiles);
+		else if (groupGeometry.groupId.groupType == GroupType::SparseGrid)
+			priv_updateSparseGridChunks(groupChunks, groupGeometry.culledRectangle, activeTiles);
+		else
+			priv_updateLayerChunks(groupChunks, groupGeometry.culledRectangle, activeTiles);
+		groupGeometry.numberOfCells = { 0u, 0u };
+		groupGeometry.cellQuads.clear();
+		groupGeometry.quadTiles.clear();
+		groupGeometry.pageRuns.clear();
+		const std::size_t numberOfTilesBuilt{ activeTiles.size() };
+		activeTiles.clear();
+		return numberOfTilesBuilt;
+	}
+
+	activeTiles.clear();
+	std::size_t numberOfTilesTested{ 0u };
+	switch (groupGeometry.groupId.groupType)
+	{
+	case GroupType::Grid:
+		numberOfTilesTested = priv_cullGrid(groupGeometry, groupGeometry.culledRectangle, activeTiles);
+		break;
+	case GroupType::SparseGrid:
+		groupGeometry.numberOfCells = { 0u, 0u };
+		groupGeometry.cellQuads.clear();
+		numberOfTilesTested = priv_cullSparseGrid(groupGeometry.groupId.groupIndex, groupGeometry.culledRectangle, activeTiles);
+		break;
+	default:
+	case GroupType::Layer:
+		numberOfTilesTested = priv_cullLayer(groupGeometry.groupId.groupIndex, groupGeometry.culledRectangle, activeTiles);
+		break;
+	}
+	priv_sortTilesByTexturePage(groupGeometry.groupId, activeTiles.data(), activeTiles.size(), groupGeometry.pageRuns, &groupGeometry.cellQuads);
+	return numberOfTilesTested;
+}
+
+inline std::size_t Map::priv_cullLayer(const std::size_t layerIndex, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const Layer& layer{ layers[layerIndex] };
+	const std::size_t numberOfTextureAtlasRectangle{ textureAtlas.size() };
+	const float depthRatio{ priv_getBuiltDepthRatio({ GroupType::Layer, layerIndex }) };
+
+	auto testTile = [&](const std::size_t t)
+	{
+		const Tile& tile{ layer.tiles[t] };
+		if (!tile.isActive)
+			return;
+
+		bool isAnActiveTile{ false };
+		if (!tile.isTemplate)
+		{
+			if (tile.id < numberOfTextureAtlasRectangle)
+				isAnActiveTile = true;
+		}
+		else if (tileTemplates[tile.id].isActive)
+		{
+			if (tileTemplates[tile.id].id < numberOfTextureAtlasRectangle)
+				isAnActiveTile = true;
+		}
+		if (!isAnActiveTile)
+			return;
+
+		sf::FloatRect tileBounds{ priv_getLayerTileBounds(tile) };
+		tileBounds = { priv_pointWithDepth(tileBounds.position + layer.offset, depthRatio), priv_pointDepthScale(tileBounds.size, depthRatio) };
+
+		if (effectiveViewRectangle.findIntersection(tileBounds))
+			activeTiles.push_back(t);
+	};
+
+	const SpatialIndex* spatialIndex{ priv_getLayerSpatialIndex(layerIndex) };
+	if (spatialIndex != nullptr)
+	{
+		// only test the tiles that the spatial index finds near the view rectangle (with depth removed)
+		const sf::FloatRect layerViewRectangle{ priv_pointWithoutDepth(effectiveViewRectangle.position, depthRatio) - layer.offset, priv_pointDepthUnscale(effectiveViewRectangle.size, depthRatio) };
+		std::vector<std::size_t> candidateTiles{};
+		spatialIndex->query(layerViewRectangle, candidateTiles);
+		for (const std::size_t t : candidateTiles)
+			testTile(t);
+		return candidateTiles.size();
+	}
+
+	for (std::size_t t{ 0u }, numberOfTiles{ layer.tiles.size() }; t < numberOfTiles; ++t)
+		testTile(t);
+	return layer.tiles.size();
+}
+
+inline std::size_t Map::priv_cullGrid(GroupGeometry& groupGeometry, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const Grid& grid{ grids[groupGeometry.groupId.groupIndex] };
+	const float depthRatio{ priv_getBuiltDepthRatio(groupGeometry.groupId) };
+
+	groupGeometry.numberOfCells = { 0u, 0u };
+	groupGeometry.cellQuads.clear();
+
+	const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+	if ((numberOfTiles == 0u) || (grid.rowWidth == 0u) || (grid.tileSize.x <= 0.f) || (grid.tileSize.y <= 0.f))
+		return 0u;
+
+	const std::size_t level{ priv_getGridLevelOfDetail(groupGeometry.groupId.groupIndex) };
+	if (level > 0u)
+		return priv_cullGridBlocks(groupGeometry, level, effectiveViewRectangle, activeTiles);
+
+	// calculate the range of cells that can be visible by removing depth from the view rectangle (instead of projecting every cell)
+	// the range is expanded by one cell on each side so that cells on the edge are still decided by the exact test
+	const std::size_t numberOfRows{ ((numberOfTiles - 1u) / grid.rowWidth) + 1u };
+	const sf::Vector2f viewTopLeft{ priv_pointWithoutDepth(effectiveViewRectangle.position, depthRatio) - grid.position };
+	const sf::Vector2f viewBottomRight{ viewTopLeft + priv_pointDepthUnscale(effectiveViewRectangle.size, depthRatio) };
+	const float columnBegin{ std::max(std::floor(viewTopLeft.x / grid.tileSize.x) - 1.f, 0.f) };
+	const float columnEnd{ std::min(std::ceil(viewBottomRight.x / grid.tileSize.x) + 1.f, static_cast<float>(grid.rowWidth)) };
+	const float rowBegin{ std::max(std::floor(viewTopLeft.y / grid.tileSize.y) - 1.f, 0.f) };
+	const float rowEnd{ std::min(std::ceil(viewBottomRight.y / grid.tileSize.y) + 1.f, static_cast<float>(numberOfRows)) };
+	if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+		return 0u;
+
+	const std::size_t firstColumn{ static_cast<std::size_t>(columnBegin) };
+	const std::size_t lastColumn{ static_cast<std::size_t>(columnEnd) };
+	const std::size_t firstRow{ static_cast<std::size_t>(rowBegin) };
+	const std::size_t lastRow{ static_cast<std::size_t>(rowEnd) };
+
+	// store which quad each tested cell uses so that single tiles can be updated later
+	groupGeometry.firstCell = { firstColumn, firstRow };
+	groupGeometry.numberOfCells = { lastColumn - firstColumn, lastRow - firstRow };
+	groupGeometry.cellQuads.assign(groupGeometry.numberOfCells.x * groupGeometry.numberOfCells.y, noQuad);
+
+	std::size_t cell{ 0u };
+	for (std::size_t y{ firstRow }; y < lastRow; ++y)
+	{
+		for (std::size_t x{ firstColumn }, t{ (y * grid.rowWidth) + firstColumn }; x < lastColumn; ++x, ++t, ++cell)
+		{
+			if ((t < numberOfTiles) && priv_isGridTileVisible(grid, { x, y }, t, depthRatio, effectiveViewRectangle))
+			{
+				groupGeometry.cellQuads[cell] = activeTiles.size();
+				activeTiles.push_back(t);
+			}
+		}
+	}
+	return groupGeometry.numberOfCells.x * groupGeometry.numberOfCells.y; // cells
+}
+
+inline std::size_t Map::priv_cullGridBlocks(GroupGeometry& groupGeometry, const std::size_t level, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	// the same as priv_cullGrid but with blocks instead of cells. each visible block adds the tile that it is drawn as (blocks have no cell quads so single tiles can't be updated)
+	const Grid& grid{ grids[groupGeometry.groupId.groupIndex] };
+	const GridLevel& gridLevel{ priv_getGridLevel(groupGeometry.groupId.groupIndex, level) };
+	const float depthRatio{ priv_getBuiltDepthRatio(groupGeometry.groupId) };
+
+	const float blockScale{ static_cast<float>(std::size_t{ 1u } << level) };
+	const sf::Vector2f blockSize{ grid.tileSize * blockScale };
+	const sf::Vector2f gridSize{ grid.tileSize.x * grid.rowWidth, grid.tileSize.y * (((grid.getNumberOfTiles() - 1u) / grid.rowWidth) + 1u) };
+	const sf::Vector2f viewTopLeft{ priv_pointWithoutDepth(effectiveViewRectangle.position, depthRatio) - grid.position };
+	const sf::Vector2f viewBottomRight{ viewTopLeft + priv_pointDepthUnscale(effectiveViewRectangle.size, depthRatio) };
+	const float columnBegin{ std::max(std::floor(viewTopLeft.x / blockSize.x) - 1.f, 0.f) };
+	const float columnEnd{ std::min(std::ceil(viewBottomRight.x / blockSize.x) + 1.f, static_cast<float>(gridLevel.numberOfBlocks.x)) };
+	const float rowBegin{ std::max(std::floor(viewTopLeft.y / blockSize.y) - 1.f, 0.f) };
+	const float rowEnd{ std::min(std::ceil(viewBottomRight.y / blockSize.y) + 1.f, static_cast<float>(gridLevel.numberOfBlocks.y)) };
+	if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+		return 0u;
+
+	const std::size_t firstColumn{ static_cast<std::size_t>(columnBegin) };
+	const std::size_t lastColumn{ static_cast<std::size_t>(columnEnd) };
+	const std::size_t firstRow{ static_cast<std::size_t>(rowBegin) };
+	const std::size_t lastRow{ static_cast<std::size_t>(rowEnd) };
+	for (std::size_t y{ firstRow }; y < lastRow; ++y)
+	{
+		for (std::size_t x{ firstColumn }; x < lastColumn; ++x)
+		{
+			const std::size_t blockTile{ gridLevel.blockTiles[(y * gridLevel.numberOfBlocks.x) + x] };
+			if (blockTile == noQuad)
+				continue;
+
+			// blocks on the grid's right and bottom edges only cover the tiles that are within it
+			const sf::Vector2f blockPosition{ blockSize.x * x, blockSize.y * y };
+			sf::FloatRect blockBounds{ grid.position + blockPosition, { std::min(blockSize.x, gridSize.x - blockPosition.x), std::min(blockSize.y, gridSize.y - blockPosition.y) } };
+			blockBounds = { priv_pointWithDepth(blockBounds.position, depthRatio), priv_pointDepthScale(blockBounds.size, depthRatio) };
+			if (effectiveViewRectangle.findIntersection(blockBounds))
+				activeTiles.push_back(blockTile);
+		}
+	}
+	return (lastColumn - firstColumn) * (lastRow - firstRow); // blocks
+}
+
+inline std::size_t Map::priv_cullSparseGrid(const std::size_t sparseGridIndex, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const SparseGrid& sparseGrid{ sparseGrids[sparseGridIndex] };
+	const float depthRatio{ priv_getBuiltDepthRatio({ GroupType::SparseGrid, sparseGridIndex }) };
+
+	if ((sparseGrid.getNumberOfChunks() == 0u) || (sparseGrid.tileSize.x <= 0.f) || (sparseGrid.tileSize.y <= 0.f))
+		return 0u;
+
+	// the range of cells that can be visible (the same as priv_cullGrid)
+	constexpr std::size_t rowWidth{ SparseGrid::rowWidth };
+	constexpr std::size_t chunkSize{ SparseGrid::chunkSize };
+	const sf::Vector2f viewTopLeft{ priv_pointWithoutDepth(effectiveViewRectangle.position, depthRatio) - sparseGrid.position };
+	const sf::Vector2f viewBottomRight{ viewTopLeft + priv_pointDepthUnscale(effectiveViewRectangle.size, depthRatio) };
+	const float columnBegin{ std::max(std::floor(viewTopLeft.x / sparseGrid.tileSize.x) - 1.f, 0.f) };
+	const float columnEnd{ std::min(std::ceil(viewBottomRight.x / sparseGrid.tileSize.x) + 1.f, static_cast<float>(rowWidth)) };
+	const float rowBegin{ std::max(std::floor(viewTopLeft.y / sparseGrid.tileSize.y) - 1.f, 0.f) };
+	const float rowEnd{ std::min(std::ceil(viewBottomRight.y / sparseGrid.tileSize.y) + 1.f, static_cast<float>(rowWidth)) };
+	if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+		return 0u;
+
+	const std::size_t firstColumn{ static_cast<std::size_t>(columnBegin) };
+	const std::size_t lastColumn{ static_cast<std::size_t>(columnEnd) };
+	const std::size_t firstRow{ static_cast<std::size_t>(rowBegin) };
+	const std::size_t lastRow{ static_cast<std::size_t>(rowEnd) };
+
+	// only stored chunks are tested
+	std::vector<SparseGridChunk> storedChunks{};
+	priv_getSparseGridChunks(sparseGrid, { firstColumn / chunkSize, firstRow / chunkSize }, { ((lastColumn - 1u) / chunkSize) + 1u, ((lastRow - 1u) / chunkSize) + 1u }, storedChunks);
+
+	const std::size_t numberOfTextureAtlasRectangles{ textureAtlas.size() };
+	std::size_t numberOfTilesTested{ 0u };
+	for (const SparseGridChunk& storedChunk : storedChunks)
+	{
+		const std::size_t chunkColumn{ storedChunk.location.x * chunkSize };
+		const std::size_t chunkRow{ storedChunk.location.y * chunkSize };
+		const std::size_t chunkFirstColumn{ std::max(chunkColumn, firstColumn) };
+		const std::size_t chunkFirstRow{ std::max(chunkRow, firstRow) };
+		const std::size_t chunkLastColumn{ std::min(chunkColumn + chunkSize, lastColumn) };
+		const std::size_t chunkLastRow{ std::min(chunkRow + chunkSize, lastRow) };
+		numberOfTilesTested += (chunkLastColumn - chunkFirstColumn) * (chunkLastRow - chunkFirstRow);
+		for (std::size_t y{ chunkFirstRow }; y < chunkLastRow; ++y)
+		{
+			for (std::size_t x{ chunkFirstColumn }; x < chunkLastColumn; ++x)
+			{
+				const TileIdType tileId{ storedChunk.tileIds[((y - chunkRow) * chunkSize) + (x - chunkColumn)] };
+				if ((tileId == sparseGrid.invisibleId) || (tileId >= numberOfTextureAtlasRectangles))
+					continue;
+
+				sf::FloatRect tileBounds{ { sparseGrid.position.x + (x * sparseGrid.tileSize.x), sparseGrid.position.y + (y * sparseGrid.tileSize.y) }, sparseGrid.tileSize };
+				tileBounds = { priv_pointWithDepth(tileBounds.position, depthRatio), priv_pointDepthScale(tileBounds.size, depthRatio) };
+				if (effectiveViewRectangle.findIntersection(tileBounds).has_value())
+					activeTiles.push_back((y * rowWidth) + x);
+			}
+		}
+	}
+	return numberOfTilesTested;
+}
+
+inline void Map::priv_getSparseGridChunks(const SparseGrid& sparseGrid, const sf::Vector2<std::size_t> firstChunk, const sf::Vector2<std::size_t> lastChunk, std::vector<SparseGridChunk>& sparseGridChunks) const
+{
+	// the stored chunks within the range (row by row). each chunk in the range is looked up unless the range has more chunks than are stored, in which case the stored chunks are checked against the range
+	sparseGridChunks.clear();
+	if ((lastChunk.x - firstChunk.x) * (lastChunk.y - firstChunk.y) <= sparseGrid.getNumberOfChunks())
+	{
+		for (std::size_t y{ firstChunk.y }; y < lastChunk.y; ++y)
+		{
+			for (std::size_t x{ firstChunk.x }; x < lastChunk.x; ++x)
+			{
+				if (const TileIdType* const tileIds{ sparseGrid.getChunkTileIds({ x, y }) })
+					sparseGridChunks.push_back({ { x, y }, tileIds });
+			}
+		}
+	}
+	else
+	{
+		sparseGrid.forEachChunk([&](const sf::Vector2<std::size_t> chunkLocation, const TileIdType* const tileIds)
+		{
+			if ((chunkLocation.x >= firstChunk.x) && (chunkLocation.x < lastChunk.x) && (chunkLocation.y >= firstChunk.y) && (chunkLocation.y < lastChunk.y))
+				sparseGridChunks.push_back({ chunkLocation, tileIds });
+		});
+		std::sort(sparseGridChunks.begin(), sparseGridChunks.end(), [](const SparseGridChunk& lhs, const SparseGridChunk& rhs) { return (lhs.location.y != rhs.location.y) ? (lhs.location.y < rhs.location.y) : (lhs.location.x < rhs.location.x); });
+	}
+}
+
+inline Map::GroupChunks& Map::priv_getGroupChunks(const GroupId groupId) const
+{
+	const auto groupChunks{ std::find_if(m_groupChunks.begin(), m_groupChunks.end(), [&](const GroupChunks& gc) { return gc.groupId == groupId; }) };
+	if (groupChunks != m_groupChunks.end())
+		return *groupChunks;
+
+	m_groupChunks.emplace_back();
+	m_groupChunks.back().groupId = groupId;
+	return m_groupChunks.back();
+}
+
+inline void Map::priv_invalidateGroupChunks(const GroupId groupId)
+{
+	const auto groupChunks{ std::find_if(m_groupChunks.begin(), m_groupChunks.end(), [&](const GroupChunks& gc) { return gc.groupId == groupId; }) };
+	if (groupChunks != m_groupChunks.end())
+		groupChunks->isValid = false;
+}
+
+inline void Map::priv_invalidateGridTileChunk(const std::size_t gridIndex, const std::size_t tileIndex)
+{
+	const auto groupChunks{ std::find_if(m_groupChunks.begin(), m_groupChunks.end(), [&](const GroupChunks& gc) { return (gc.groupId.groupType == GroupType::Grid) && (gc.groupId.groupIndex == gridIndex); }) };
+	if ((groupChunks == m_groupChunks.end()) || (!groupChunks->isValid) || (gridIndex >= grids.size()) || (grids[gridIndex].rowWidth == 0u))
+		return;
+
+	const sf::Vector2<std::size_t> chunkLocation{ (tileIndex % grids[gridIndex].rowWidth) / groupChunks->chunkSize.x, (tileIndex / grids[gridIndex].rowWidth) / groupChunks->chunkSize.y };
+	if ((chunkLocation.x < groupChunks->numberOfChunks.x) && (chunkLocation.y < groupChunks->numberOfChunks.y))
+		groupChunks->chunks[(chunkLocation.y * groupChunks->numberOfChunks.x) + chunkLocation.x].isBuildRequired = true;
+}
+
+inline void Map::priv_invalidateLayerTileChunk(const std::size_t layerIndex, const std::size_t tileIndex)
+{
+	// the tile is moved from its previous chunk to its new one and both are rebuilt. all of the chunks are rebuilt if the number of tiles has changed or the tile's new chunk doesn't exist yet
+	const auto groupChunks{ std::find_if(m_groupChunks.begin(), m_groupChunks.end(), [&](const GroupChunks& gc) { return (gc.groupId.groupType == GroupType::Layer) && (gc.groupId.groupIndex == layerIndex); }) };
+	if ((groupChunks == m_groupChunks.end()) || (!groupChunks->isValid) || (layerIndex >= layers.size()))
+		return;
+
+	const Layer& layer{ layers[layerIndex] };
+	if ((tileIndex >= layer.tiles.size()) || (groupChunks->layerTileChunks.size() != layer.tiles.size()))
+	{
+		groupChunks->isValid = false;
+		return;
+	}
+
+	std::size_t newChunk{ noQuad };
+	const Tile& tile{ layer.tiles[tileIndex] };
+	if (priv_isLayerTileDrawn(tile))
+	{
+		const sf::Vector2<long long> chunkLocation{ priv_getLayerTileChunkLocation(layer, tile) };
+		const auto location{ std::lower_bound(groupChunks->layerChunkLocations.begin(), groupChunks->layerChunkLocations.end(), chunkLocation, [](const sf::Vector2<long long>& lhs, const sf::Vector2<long long>& rhs)
+			{ return (lhs.y < rhs.y) || ((lhs.y == rhs.y) && (lhs.x < rhs.x)); }) };
+		if ((location == groupChunks->layerChunkLocations.end()) || (*location != chunkLocation))
+		{
+			groupChunks->isValid = false;
+			return;
+		}
+		newChunk = static_cast<std::size_t>(location - groupChunks->layerChunkLocations.begin());
+	}
+
+	// each chunk's tiles are kept in tile order
+	std::size_t& previousChunk{ groupChunks->layerTileChunks[tileIndex] };
+	if (previousChunk != newChunk)
+	{
+		if (previousChunk != noQuad)
+		{
+			std::vector<std::size_t>& quadTiles{ groupChunks->chunks[previousChunk].quadTiles };
+			quadTiles.erase(std::lower_bound(quadTiles.begin(), quadTiles.end(), tileIndex));
+		}
+		if (newChunk != noQuad)
+		{
+			std::vector<std::size_t>& quadTiles{ groupChunks->chunks[newChunk].quadTiles };
+			quadTiles.insert(std::lower_bound(quadTiles.begin(), quadTiles.end(), tileIndex), tileIndex);
+		}
+	}
+	if (previousChunk != noQuad)
+		groupChunks->chunks[previousChunk].isBuildRequired = true;
+	if (newChunk != noQuad)
+		groupChunks->chunks[newChunk].isBuildRequired = true;
+	previousChunk = newChunk;
+}
+
+inline bool Map::priv_isLayerTileDrawn(const Tile& tile) const
+{
+	const std::size_t numberOfTextureAtlasRectangle{ textureAtlas.size() };
+	return tile.isActive && (tile.isTemplate ? (tileTemplates[tile.id].isActive && (tileTemplates[tile.id].id < numberOfTextureAtlasRectangle)) : (tile.id < numberOfTextureAtlasRectangle));
+}
+
+inline sf::Vector2<long long> Map::priv_getLayerTileChunkLocation(const Layer& layer, const Tile& tile) const
+{
+	// the chunk that contains the tile's top-left corner
+	const sf::Vector2f position{ tile.position + layer.offset };
+	return { static_cast<long long>(std::floor(position.x / m_chunkSize.x)), static_cast<long long>(std::floor(position.y / m_chunkSize.y)) };
+}
+
+inline void Map::priv_updateGridChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const Grid& grid{ grids[groupChunks.groupId.groupIndex] };
+	groupChunks.visibleChunks.clear();
+
+	const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+	if ((numberOfTiles == 0u) || (grid.rowWidth == 0u) || (grid.tileSize.x <= 0.f) || (grid.tileSize.y <= 0.f))
+	{
+		groupChunks.chunks.clear();
+		return;
+	}
+
+	// lay out the chunks (a whole number of cells each)
+	const std::size_t numberOfRows{ ((numberOfTiles - 1u) / grid.rowWidth) + 1u };
+	const sf::Vector2<std::size_t> chunkSize{ static_cast<std::size_t>(std::max(std::floor(m_chunkSize.x / grid.tileSize.x), 1.f)), static_cast<std::size_t>(std::max(std::floor(m_chunkSize.y / grid.tileSize.y), 1.f)) };
+	const sf::Vector2<std::size_t> numberOfChunks{ ((grid.rowWidth - 1u) / chunkSize.x) + 1u, ((numberOfRows - 1u) / chunkSize.y) + 1u };
+	if ((!groupChunks.isValid) || (groupChunks.chunkSize != chunkSize) || (groupChunks.numberOfChunks != numberOfChunks))
+	{
+		groupChunks.isValid = true;
+		groupChunks.chunkSize = chunkSize;
+		groupChunks.numberOfChunks = numberOfChunks;
+		groupChunks.chunks.resize(numberOfChunks.x * numberOfChunks.y);
+		for (auto& chunk : groupChunks.chunks)
+			chunk.isBuildRequired = true;
+	}
+
+	// the range of chunks around the view rectangle (expanded by one chunk to allow for tiles that expand outside of their chunk)
+	const sf::Vector2f chunkWorldSize{ grid.tileSize.x * chunkSize.x, grid.tileSize.y * chunkSize.y };
+	const sf::Vector2f viewTopLeft{ effectiveViewRectangle.position - grid.position };
+	const sf::Vector2f viewBottomRight{ viewTopLeft + effectiveViewRectangle.size };
+	const float columnBegin{ std::max(std::floor(viewTopLeft.x / chunkWorldSize.x) - 1.f, 0.f) };
+	const float columnEnd{ std::min(std::ceil(viewBottomRight.x / chunkWorldSize.x) + 1.f, static_cast<float>(numberOfChunks.x)) };
+	const float rowBegin{ std::max(std::floor(viewTopLeft.y / chunkWorldSize.y) - 1.f, 0.f) };
+	const float rowEnd{ std::min(std::ceil(viewBottomRight.y / chunkWorldSize.y) + 1.f, static_cast<float>(numberOfChunks.y)) };
+	const sf::Vector2<std::size_t> firstChunk{ static_cast<std::size_t>(columnBegin), static_cast<std::size_t>(rowBegin) };
+	const sf::Vector2<std::size_t> endChunk{ static_cast<std::size_t>(std::max(columnEnd, columnBegin)), static_cast<std::size_t>(std::max(rowEnd, rowBegin)) };
+
+	// build the chunks in range that require it. all of their quads are set together and then shared out to the chunks
+	std::vector<std::size_t> chunksToBuild{};
+	std::vector<std::size_t> chunkTileEnds{};
+	const std::size_t numberOfTextureAtlasRectangle{ textureAtlas.size() };
+	const TileIdType* const tileIds{ grid.getTileIds() };
+	activeTiles.clear();
+	for (std::size_t cy{ firstChunk.y }; cy < endChunk.y; ++cy)
+	{
+		for (std::size_t cx{ firstChunk.x }; cx < endChunk.x; ++cx)
+		{
+			const std::size_t c{ (cy * numberOfChunks.x) + cx };
+			if (!groupChunks.chunks[c].isBuildRequired)
+				continue;
+
+			const sf::Vector2<std::size_t> firstCell{ cx * chunkSize.x, cy * chunkSize.y };
+			const sf::Vector2<std::size_t> endCell{ std::min(firstCell.x + chunkSize.x, grid.rowWidth), std::min(firstCell.y + chunkSize.y, numberOfRows) };
+			for (std::size_t y{ firstCell.y }; y < endCell.y; ++y)
+			{
+				for (std::size_t t{ (y * grid.rowWidth) + firstCell.x }, end{ std::min((y * grid.rowWidth) + endCell.x, numberOfTiles) }; t < end; ++t)
+				{
+					if ((tileIds[t] != grid.invisibleId) && (tileIds[t] < numberOfTextureAtlasRectangle))
+						activeTiles.push_back(t);
+				}
+			}
+			chunksToBuild.push_back(c);
+			chunkTileEnds.push_back(activeTiles.size());
+		}
+	}
+	if (!chunksToBuild.empty())
+	{
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }, chunkTileBegin{ 0u }; i < numberOfChunksToBuild; chunkTileBegin = chunkTileEnds[i++])
+			priv_sortTilesByTexturePage(groupChunks.groupId, activeTiles.data() + chunkTileBegin, chunkTileEnds[i] - chunkTileBegin, groupChunks.chunks[chunksToBuild[i]].pageRuns, nullptr);
+
+		std::vector<sf::Vertex> vertices(activeTiles.size() * numberOfVerticesPerQuad);
+		priv_setGroupQuads(groupChunks.groupId, activeTiles.data(), activeTiles.size(), vertices.data());
+
+		std::size_t chunkTileBegin{ 0u };
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }; i < numberOfChunksToBuild; ++i)
+		{
+			Chunk& chunk{ groupChunks.chunks[chunksToBuild[i]] };
+			chunk.vertices.assign(vertices.begin() + (chunkTileBegin * numberOfVerticesPerQuad), vertices.begin() + (chunkTileEnds[i] * numberOfVerticesPerQuad));
+			chunk.quadTiles.assign(activeTiles.begin() + chunkTileBegin, activeTiles.begin() + chunkTileEnds[i]);
+			chunk.bounds = priv_getVertexBounds(chunk.vertices);
+			chunk.isBuildRequired = false;
+			chunk.isUploadRequired = true;
+			chunkTileBegin = chunkTileEnds[i];
+		}
+		groupChunks.numberOfChunksBuilt += chunksToBuild.size();
+	}
+
+	// visible chunks: chunks in range whose actual bounds intersect the view rectangle
+	for (std::size_t cy{ firstChunk.y }; cy < endChunk.y; ++cy)
+	{
+		for (std::size_t cx{ firstChunk.x }; cx < endChunk.x; ++cx)
+		{
+			const std::size_t c{ (cy * numberOfChunks.x) + cx };
+			if ((!groupChunks.chunks[c].vertices.empty()) && effectiveViewRectangle.findIntersection(groupChunks.chunks[c].bounds))
+				groupChunks.visibleChunks.push_back(c);
+		}
+	}
+}
+
+inline void Map::priv_updateLayerChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const Layer& layer{ layers[groupChunks.groupId.groupIndex] };
+	groupChunks.visibleChunks.clear();
+	activeTiles.clear();
+
+	// a layer's chunks are all rebuilt together (after updateLayerTile, only the chunks that require it are rebuilt). each tile belongs to the chunk that contains its top-left corner
+	std::vector<std::size_t> chunksToBuild{};
+	std::vector<std::size_t> chunkTileEnds{};
+	if (!groupChunks.isValid)
+	{
+		groupChunks.isValid = true;
+
+		struct ChunkTile
+		{
+			sf::Vector2<long long> chunkLocation;
+			std::size_t tileIndex;
+		};
+		std::vector<ChunkTile> chunkTiles{};
+		for (std::size_t t{ 0u }, numberOfTiles{ layer.tiles.size() }; t < numberOfTiles; ++t)
+		{
+			const Tile& tile{ layer.tiles[t] };
+			if (priv_isLayerTileDrawn(tile))
+				chunkTiles.push_back({ priv_getLayerTileChunkLocation(layer, tile), t });
+		}
+		std::stable_sort(chunkTiles.begin(), chunkTiles.end(), [](const ChunkTile& lhs, const ChunkTile& rhs)
+			{ return (lhs.chunkLocation.y < rhs.chunkLocation.y) || ((lhs.chunkLocation.y == rhs.chunkLocation.y) && (lhs.chunkLocation.x < rhs.chunkLocation.x)); });
+
+		activeTiles.resize(chunkTiles.size());
+		groupChunks.layerChunkLocations.clear();
+		groupChunks.layerTileChunks.assign(layer.tiles.size(), noQuad);
+		for (std::size_t i{ 0u }, numberOfChunkTiles{ chunkTiles.size() }; i < numberOfChunkTiles; ++i)
+		{
+			activeTiles[i] = chunkTiles[i].tileIndex;
+			groupChunks.layerTileChunks[chunkTiles[i].tileIndex] = chunkTileEnds.size();
+			if ((i + 1u == numberOfChunkTiles) || (chunkTiles[i + 1u].chunkLocation != chunkTiles[i].chunkLocation))
+			{
+				chunksToBuild.push_back(chunkTileEnds.size());
+				chunkTileEnds.push_back(i + 1u);
+				groupChunks.layerChunkLocations.push_back(chunkTiles[i].chunkLocation);
+			}
+		}
+		groupChunks.chunks.resize(chunkTileEnds.size());
+	}
+	else
+	{
+		for (std::size_t c{ 0u }, numberOfChunks{ groupChunks.chunks.size() }; c < numberOfChunks; ++c)
+		{
+			if (!groupChunks.chunks[c].isBuildRequired)
+				continue;
+
+			activeTiles.insert(activeTiles.end(), groupChunks.chunks[c].quadTiles.begin(), groupChunks.chunks[c].quadTiles.end());
+			chunksToBuild.push_back(c);
+			chunkTileEnds.push_back(activeTiles.size());
+		}
+	}
+
+	if (!chunksToBuild.empty())
+	{
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }, chunkTileBegin{ 0u }; i < numberOfChunksToBuild; chunkTileBegin = chunkTileEnds[i++])
+			priv_sortTilesByTexturePage(groupChunks.groupId, activeTiles.data() + chunkTileBegin, chunkTileEnds[i] - chunkTileBegin, groupChunks.chunks[chunksToBuild[i]].pageRuns, nullptr);
+
+		std::vector<sf::Vertex> vertices(activeTiles.size() * numberOfVerticesPerQuad);
+		priv_setGroupQuads(groupChunks.groupId, activeTiles.data(), activeTiles.size(), vertices.data());
+
+		std::size_t chunkTileBegin{ 0u };
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }; i < numberOfChunksToBuild; ++i)
+		{
+			Chunk& chunk{ groupChunks.chunks[chunksToBuild[i]] };
+			chunk.vertices.assign(vertices.begin() + (chunkTileBegin * numberOfVerticesPerQuad), vertices.begin() + (chunkTileEnds[i] * numberOfVerticesPerQuad));
+			chunk.quadTiles.assign(activeTiles.begin() + chunkTileBegin, activeTiles.begin() + chunkTileEnds[i]);
+			chunk.bounds = priv_getVertexBounds(chunk.vertices);
+			chunk.isBuildRequired = false;
+			chunk.isUploadRequired = true;
+			chunkTileBegin = chunkTileEnds[i];
+		}
+		groupChunks.numberOfChunksBuilt += chunksToBuild.size();
+	}
+
+	for (std::size_t c{ 0u }, numberOfChunks{ groupChunks.chunks.size() }; c < numberOfChunks; ++c)
+	{
+		if ((!groupChunks.chunks[c].vertices.empty()) && effectiveViewRectangle.findIntersection(groupChunks.chunks[c].bounds))
+			groupChunks.visibleChunks.push_back(c);
+	}
+}
+
+inline void Map::priv_updateSparseGridChunks(GroupChunks& groupChunks, const sf::FloatRect& effectiveViewRectangle, std::vector<std::size_t>& activeTiles) const
+{
+	const SparseGrid& sparseGrid{ sparseGrids[groupChunks.groupId.groupIndex] };
+	groupChunks.visibleChunks.clear();
+	activeTiles.clear();
+
+	if ((sparseGrid.getNumberOfChunks() == 0u) || (sparseGrid.tileSize.x <= 0.f) || (sparseGrid.tileSize.y <= 0.f))
+	{
+		groupChunks.sparseGridChunkIndices.clear();
+		groupChunks.chunks.clear();
+		return;
+	}
+
+	// lay out the chunks (one for each stored chunk)
+	if ((!groupChunks.isValid) || (groupChunks.chunks.size() != sparseGrid.getNumberOfChunks()))
+	{
+		groupChunks.isValid = true;
+		groupChunks.sparseGridChunkIndices.clear();
+		sparseGrid.forEachChunk([&](const sf::Vector2<std::size_t> chunkLocation, const TileIdType*)
+		{
+			groupChunks.sparseGridChunkIndices.emplace((chunkLocation.y * sparseGridNumberOfChunksPerRow) + chunkLocation.x, groupChunks.sparseGridChunkIndices.size());
+		});
+		groupChunks.chunks.resize(groupChunks.sparseGridChunkIndices.size());
+		for (auto& chunk : groupChunks.chunks)
+			chunk.isBuildRequired = true;
+	}
+
+	// the range of stored chunks around the view rectangle (expanded by one chunk to allow for tiles that expand outside of their chunk)
+	constexpr std::size_t rowWidth{ SparseGrid::rowWidth };
+	constexpr std::size_t chunkSize{ SparseGrid::chunkSize };
+	const sf::Vector2f chunkWorldSize{ sparseGrid.tileSize.x * chunkSize, sparseGrid.tileSize.y * chunkSize };
+	const sf::Vector2f viewTopLeft{ effectiveViewRectangle.position - sparseGrid.position };
+	const sf::Vector2f viewBottomRight{ viewTopLeft + effectiveViewRectangle.size };
+	const float columnBegin{ std::max(std::floor(viewTopLeft.x / chunkWorldSize.x) - 1.f, 0.f) };
+	const float columnEnd{ std::min(std::ceil(viewBottomRight.x / chunkWorldSize.x) + 1.f, static_cast<float>(sparseGridNumberOfChunksPerRow)) };
+	const float rowBegin{ std::max(std::floor(viewTopLeft.y / chunkWorldSize.y) - 1.f, 0.f) };
+	const float rowEnd{ std::min(std::ceil(viewBottomRight.y / chunkWorldSize.y) + 1.f, static_cast<float>(sparseGridNumberOfChunksPerRow)) };
+	if ((columnBegin >= columnEnd) || (rowBegin >= rowEnd))
+		return;
+
+	std::vector<SparseGridChunk> sparseGridChunks{};
+	priv_getSparseGridChunks(sparseGrid, { static_cast<std::size_t>(columnBegin), static_cast<std::size_t>(rowBegin) }, { static_cast<std::size_t>(columnEnd), static_cast<std::size_t>(rowEnd) }, sparseGridChunks);
+
+	// the chunk of each stored chunk in range (noQuad if the stored chunk was added without the sparse grid being updated)
+	std::vector<std::size_t> chunkIndices(sparseGridChunks.size(), noQuad);
+	for (std::size_t i{ 0u }, numberOfSparseGridChunks{ sparseGridChunks.size() }; i < numberOfSparseGridChunks; ++i)
+	{
+		const auto chunkIndex{ groupChunks.sparseGridChunkIndices.find((sparseGridChunks[i].location.y * sparseGridNumberOfChunksPerRow) + sparseGridChunks[i].location.x) };
+		if (chunkIndex != groupChunks.sparseGridChunkIndices.end())
+			chunkIndices[i] = chunkIndex->second;
+	}
+
+	// build the chunks in range that require it. all of their quads are set together and then shared out to the chunks (the same as priv_updateGridChunks)
+	std::vector<std::size_t> chunksToBuild{};
+	std::vector<std::size_t> chunkTileEnds{};
+	const std::size_t numberOfTextureAtlasRectangle{ textureAtlas.size() };
+	for (std::size_t i{ 0u }, numberOfSparseGridChunks{ sparseGridChunks.size() }; i < numberOfSparseGridChunks; ++i)
+	{
+		if ((chunkIndices[i] == noQuad) || (!groupChunks.chunks[chunkIndices[i]].isBuildRequired))
+			continue;
 
+		const SparseGridChunk& sparseGridChunk{ sparseGridChunks[i] };
+		const sf::Vector2<std::size_t> firstCell{ sparseGridChunk.location.x * chunkSize, sparseGridChunk.location.y * chunkSize };
+		for (std::size_t y{ 0u }; y < chunkSize; ++y)
+		{
+			for (std::size_t x{ 0u }; x < chunkSize; ++x)
+			{
+				const TileIdType tileId{ sparseGridChunk.tileIds[(y * chunkSize) + x] };
+				if ((tileId != sparseGrid.invisibleId) && (tileId < numberOfTextureAtlasRectangle))
+					activeTiles.push_back(((firstCell.y + y) * rowWidth) + firstCell.x + x);
+			}
+		}
+		chunksToBuild.push_back(chunkIndices[i]);
+		chunkTileEnds.push_back(activeTiles.size());
+	}
+	if (!chunksToBuild.empty())
+	{
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }, chunkTileBegin{ 0u }; i < numberOfChunksToBuild; chunkTileBegin = chunkTileEnds[i++])
+			priv_sortTilesByTexturePage(groupChunks.groupId, activeTiles.data() + chunkTileBegin, chunkTileEnds[i] - chunkTileBegin, groupChunks.chunks[chunksToBuild[i]].pageRuns, nullptr);
 
+		std::vector<sf::Vertex> vertices(activeTiles.size() * numberOfVerticesPerQuad);
+		priv_setGroupQuads(groupChunks.groupId, activeTiles.data(), activeTiles.size(), vertices.data());
 
+		std::size_t chunkTileBegin{ 0u };
+		for (std::size_t i{ 0u }, numberOfChunksToBuild{ chunksToBuild.size() }; i < numberOfChunksToBuild; ++i)
+		{
+			Chunk& chunk{ groupChunks.chunks[chunksToBuild[i]] };
+			chunk.vertices.assign(vertices.begin() + (chunkTileBegin * numberOfVerticesPerQuad), vertices.begin() + (chunkTileEnds[i] * numberOfVerticesPerQuad));
+			chunk.quadTiles.assign(activeTiles.begin() + chunkTileBegin, activeTiles.begin() + chunkTileEnds[i]);
+			chunk.bounds = priv_getVertexBounds(chunk.vertices);
+			chunk.isBuildRequired = false;
+			chunk.isUploadRequired = true;
+			chunkTileBegin = chunkTileEnds[i];
+		}
+		groupChunks.numberOfChunksBuilt += chunksToBuild.size();
+	}
 
+	// visible chunks: chunks in range whose actual bounds intersect the view rectangle
+	for (const std::size_t c : chunkIndices)
+	{
+		if ((c != noQuad) && (!groupChunks.chunks[c].vertices.empty()) && effectiveViewRectangle.findIntersection(groupChunks.chunks[c].bounds))
+			groupChunks.visibleChunks.push_back(c);
+	}
+}
 
+template <class RunFunction>
+inline void Map::priv_forEachRun(RunFunction runFunction) const
+{
+	// the runs of the most recent update in drawing order: each group's part of the vertex array or (for chunked groups) each of its visible chunks, split by texture page
+	// runFunction(const VertexRun&, Chunk*) is also given the chunk of chunk runs (otherwise, nullptr)
+	VertexRun vertexRun{};
+	auto runPages = [&](const sf::Vertex* const vertices, const std::size_t* const quadTiles, const std::size_t numberOfQuads, const std::vector<PageRun>& pageRuns, Chunk* const chunk)
+	{
+		if (pageRuns.empty())
+		{
+			vertexRun.vertices = vertices;
+			vertexRun.numberOfVertices = numberOfQuads * numberOfVerticesPerQuad;
+			vertexRun.quadTiles = quadTiles;
+			vertexRun.texturePage = 0u;
+			runFunction(static_cast<const VertexRun&>(vertexRun), chunk);
+			return;
+		}
+		std::size_t quad{ 0u };
+		for (const PageRun& pageRun : pageRuns)
+		{
+			vertexRun.vertices = vertices + (quad * numberOfVerticesPerQuad);
+			vertexRun.numberOfVertices = pageRun.numberOfQuads * numberOfVerticesPerQuad;
+			vertexRun.quadTiles = quadTiles + quad;
+			vertexRun.texturePage = pageRun.texturePage;
+			runFunction(static_cast<const VertexRun&>(vertexRun), chunk);
+			quad += pageRun.numberOfQuads;
+		}
+	};
+	for (const auto& groupGeometry : m_groupGeometries)
+	{
+		vertexRun.groupType = groupGeometry.groupId.groupType;
+		vertexRun.groupIndex = groupGeometry.groupId.groupIndex;
+		vertexRun.transform = sf::Transform::Identity;
+		if (!groupGeometry.isChunked)
+		{
+			if (groupGeometry.numberOfVertices == 0u)
+				continue;
+			if (groupGeometry.depthRatio != 1.f)
+				vertexRun.transform = priv_getDepthTransform(groupGeometry.depthRatio);
+			runPages(m_vertices.data() + groupGeometry.startVertex, groupGeometry.quadTiles.data(), groupGeometry.numberOfVertices / numberOfVerticesPerQuad, groupGeometry.pageRuns, nullptr);
+			continue;
+		}
 
+		GroupChunks& groupChunks{ priv_getGroupChunks(groupGeometry.groupId) };
+		for (const std::size_t c : groupChunks.visibleChunks)
+		{
+			Chunk& chunk{ groupChunks.chunks[c] };
+			runPages(chunk.vertices.data(), chunk.quadTiles.data(), chunk.quadTiles.size(), chunk.pageRuns, &chunk);
+		}
+	}
+}
 
+inline void Map::priv_drawChunk(sf::RenderTarget& target, const sf::RenderStates& states, Chunk& chunk, const std::size_t firstVertex, const std::size_t numberOfVertices) const
+{
+	// chunks are uploaded to their vertex buffer when first drawn after being rebuilt. if vertex buffers are not available, the chunk's vertices are drawn directly
+	if (sf::VertexBuffer::isAvailable())
+	{
+		bool isVertexBufferReady{ true };
+		if (chunk.isUploadRequired)
+		{
+			if (chunk.vertexBuffer.getVertexCount() != chunk.vertices.size())
+				isVertexBufferReady = chunk.vertexBuffer.create(chunk.vertices.size());
+			if (isVertexBufferReady)
+				isVertexBufferReady = chunk.vertexBuffer.update(chunk.vertices.data());
+			if (isVertexBufferReady)
+			{
+				chunk.isUploadRequired = false;
+				m_chunkInfo.numberOfVerticesUploaded += chunk.vertices.size();
+			}
+		}
+		if (isVertexBufferReady)
+		{
+			target.draw(chunk.vertexBuffer, firstVertex, numberOfVertices, states);
+			return;
+		}
+	}
 
+	target.draw(chunk.vertices.data() + firstVertex, numberOfVertices, sf::PrimitiveType::Triangles, states);
+}
 
+inline std::size_t Map::priv_getTileTexturePage(const GroupId groupId, const std::size_t tileIndex) const
+{
+	std::size_t id{ 0u };
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+		id = grids[groupId.groupIndex].getTileIds()[tileIndex];
+		break;
+	case GroupType::SparseGrid:
+		id = sparseGrids[groupId.groupIndex].getTileId(tileIndex);
+		break;
+	default:
+	case GroupType::Layer:
+	{
+		const Tile& tile{ layers[groupId.groupIndex].tiles[tileIndex] };
+		id = tile.isTemplate ? tileTemplates[tile.id].id : tile.id;
+		break;
+	}
+	}
+	return (id < m_texturePages.size()) ? m_texturePages[id] : 0u;
+}
 
+inline std::size_t Map::priv_getQuadTexturePage(const std::vector<PageRun>& pageRuns, std::size_t quad) const
+{
+	for (const PageRun& pageRun : pageRuns)
+	{
+		if (quad < pageRun.numberOfQuads)
+			return pageRun.texturePage;
+		quad -= pageRun.numberOfQuads;
+	}
+	return 0u;
+}
 
+inline void Map::priv_sortTilesByTexturePage(const GroupId groupId, std::size_t* const activeTiles, const std::size_t numberOfActiveTiles, std::vector<PageRun>& pageRuns, std::vector<std::size_t>* const cellQuads) const
+{
+	// active tiles are (stably) sorted by texture page so that each page's quads are together. cellQuads (if provided) are moved with them.
+	// tiles that can overlap are drawn in tile order so they aren't moved; instead, a new page run starts wherever the page changes
+	pageRuns.clear();
+	if (m_texturePages.empty() || (numberOfActiveTiles == 0u))
+		return;
 
+	std::vector<std::size_t> texturePages(numberOfActiveTiles);
+	std::size_t numberOfTexturePages{ 0u };
+	for (std::size_t i{ 0u }; i < numberOfActiveTiles; ++i)
+	{
+		texturePages[i] = priv_getTileTexturePage(groupId, activeTiles[i]);
+		numberOfTexturePages = std::max(numberOfTexturePages, texturePages[i] + 1u);
+	}
+	if (std::all_of(texturePages.begin(), texturePages.end(), [&](const std::size_t texturePage) { return texturePage == texturePages.front(); }))
+	{
+		pageRuns.push_back({ texturePages.front(), numberOfActiveTiles });
+		return;
+	}
+	if (priv_canTilesOverlap(groupId))
+	{
+		for (const std::size_t texturePage : texturePages)
+		{
+			if (pageRuns.empty() || (pageRuns.back().texturePage != texturePage))
+				pageRuns.push_back({ texturePage, 0u });
+			++pageRuns.back().numberOfQuads;
+		}
+		return;
+	}
 
+	// counting sort: the first quad of each page and then the new quad of each tile
+	std::vector<std::size_t> pageFirstQuads(numberOfTexturePages, 0u);
+	for (const std::size_t texturePage : texturePages)
+		++pageFirstQuads[texturePage];
+	for (std::size_t p{ 0u }, firstQuad{ 0u }; p < numberOfTexturePages; ++p)
+	{
+		const std::size_t numberOfQuads{ pageFirstQuads[p] };
+		if (numberOfQuads > 0u)
+			pageRuns.push_back({ p, numberOfQuads });
+		pageFirstQuads[p] = firstQuad;
+		firstQuad += numberOfQuads;
+	}
+	std::vector<std::size_t> newQuads(numberOfActiveTiles);
+	std::vector<std::size_t> sortedTiles(numberOfActiveTiles);
+	for (std::size_t i{ 0u }; i < numberOfActiveTiles; ++i)
+	{
+		newQuads[i] = pageFirstQuads[texturePages[i]]++;
+		sortedTiles[newQuads[i]] = activeTiles[i];
+	}
+	std::copy(sortedTiles.begin(), sortedTiles.end(), activeTiles);
+	if (cellQuads != nullptr)
+	{
+		for (std::size_t& cellQuad : *cellQuads)
+		{
+			if (cellQuad != noQuad)
+				cellQuad = newQuads[cellQuad];
+		}
+	}
+}
 
+inline bool Map::priv_canTilesOverlap(const GroupId groupId) const
+{
+	// layer tiles can be anywhere. grid cells only overlap when they are expanded
+	auto isExpanded = [](const sf::Vector2f tileExpand) { return (tileExpand.x > 0.f) || (tileExpand.y > 0.f); };
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+	{
+		const Grid& grid{ grids[groupId.groupIndex] };
+		return isExpanded(grid.tileExpand) || std::any_of(grid.tileTextureTransforms.begin(), grid.tileTextureTransforms.end(), [&](const Grid::TileTextureTransform& ttt) { return isExpanded(grid.tileExpand + ttt.tileExpand); });
+	}
+	case GroupType::SparseGrid:
+		return isExpanded(sparseGrids[groupId.groupIndex].tileExpand);
+	default:
+	case GroupType::Layer:
+		return true;
+	}
+}
 
+inline sf::FloatRect Map::priv_getVertexBounds(const std::vector<sf::Vertex>& vertices) const
+{
+	if (vertices.empty())
+		return{};
 
+	sf::Vector2f min{ vertices.front().position };
+	sf::Vector2f max{ min };
+	for (const auto& vertex : vertices)
+	{
+		min.x = std::min(min.x, vertex.position.x);
+		min.y = std::min(min.y, vertex.position.y);
+		max.x = std::max(max.x, vertex.position.x);
+		max.y = std::max(max.y, vertex.position.y);
+	}
+	return{ min, max - min };
+}
 
+inline bool Map::priv_isGridTileVisible(const Grid& grid, const sf::Vector2<std::size_t> location, const std::size_t tileIndex, const float depthRatio, const sf::FloatRect& effectiveViewRectangle) const
+{
+	const TileIdType tileId{ grid.getTileIds()[tileIndex] };
+	if ((tileId == grid.invisibleId) || (tileId >= textureAtlas.size()))
+		return false;
 
+	sf::FloatRect tileBounds{ { grid.position.x + (location.x * grid.tileSize.x), grid.position.y + (location.y * grid.tileSize.y) }, grid.tileSize };
+	tileBounds = { priv_pointWithDepth(tileBounds.position, depthRatio), priv_pointDepthScale(tileBounds.size, depthRatio) };
 
+	return effectiveViewRectangle.findIntersection(tileBounds).has_value();
+}
 
-
-// PRIVATE
-
-inline void Map::draw(sf::RenderTarget& target, sf::RenderStates states) const
+inline void Map::priv_setGroupQuads(const GroupId groupId, const std::size_t* const activeTiles, const std::size_t numberOfActiveTiles, sf::Vertex* vertices) const
 {
-	if (m_texture == nullptr)
-		return;
+	CHEESEMAP_PROFILE_ZONE("CheeseMap set quads");
 
-	states.transform *= getTransform();
-	states.texture = m_texture;
+	switch (groupId.groupType)
+	{
+	case GroupType::Grid:
+	{
+		const Grid& grid{ grids[groupId.groupIndex] };
+		const float depthRatio{ priv_getBuiltDepthRatio(groupId) };
 
-	if (m_isUpdateRequired)
-		priv_update();
+		// the grid's texture transforms (ordered by tile index) are found with a binary search
+		// (so the first one for a tile is used). active tiles are usually in ascending order so each search starts from the previous one
+		const std::vector<TileTextureTransformIndex>& tileTextureTransformIndices{ priv_getTileTextureTransformIndices(groupId.groupIndex) };
+		auto isLowerTileIndex = [](const TileTextureTransformIndex& lhs, const TileTextureTransformIndex& rhs) { return lhs.tileIndex < rhs.tileIndex; };
+
+		// grids drawn in blocks set each block from the tile that it is drawn as (and that tile's texture transform)
+		const std::size_t level{ priv_getGridLevelOfDetail(groupId.groupIndex) };
+		if (level > 0u)
+		{
+			for (std::size_t i{ 0u }; i < numberOfActiveTiles; ++i)
+			{
+				const std::size_t t{ activeTiles[i] };
+				const auto tileTextureTransformIndex{ std::lower_bound(tileTextureTransformIndices.cbegin(), tileTextureTransformIndices.cend(), TileTextureTransformIndex{ t, 0u }, isLowerTileIndex) };
+				const bool hasTextureTransform{ (tileTextureTransformIndex != tileTextureTransformIndices.cend()) && (tileTextureTransformIndex->tileIndex == t) };
+				priv_setGridBlockQuad(vertices, groupId.groupIndex, t, level, hasTextureTransform ? &grid.tileTextureTransforms[tileTextureTransformIndex->transformIndex] : nullptr, depthRatio);
+				vertices += numberOfVerticesPerQuad;
+			}
+			break;
+		}
+
+		// tiles with texture transforms are set individually. other tiles are set in runs of consecutive tiles in the same row
+		auto tileTextureTransformIndex{ tileTextureTransformIndices.cbegin() };
+		std::size_t previousTile{ 0u };
+		for (std::size_t i{ 0u }; i < numberOfActiveTiles;)
+		{
+			const std::size_t t{ activeTiles[i] };
+			if (t < previousTile)
+				tileTextureTransformIndex = tileTextureTransformIndices.cbegin();
+			tileTextureTransformIndex = std::lower_bound(tileTextureTransformIndex, tileTextureTransformIndices.cend(), TileTextureTransformIndex{ t, 0u }, isLowerTileIndex);
+			if ((tileTextureTransformIndex != tileTextureTransformIndices.cend()) && (tileTextureTransformIndex->tileIndex == t))
+			{
+				priv_setGridTileQuad(vertices, groupId.groupIndex, t, &grid.tileTextureTransforms[tileTextureTransformIndex->transformIndex], depthRatio);
+				vertices += numberOfVerticesPerQuad;
+				previousTile = t;
+				++i;
+				continue;
+			}
 
-	target.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Triangles, states);
+			const std::size_t runEndTile{ std::min(t - (t % grid.rowWidth) + grid.rowWidth, (tileTextureTransformIndex != tileTextureTransformIndices.cend()) ? tileTextureTransformIndex->tileIndex : grid.getNumberOfTiles()) };
+			std::size_t numberOfRunTiles{ 1u };
+			while ((i + numberOfRunTiles < numberOfActiveTiles) && (activeTiles[i + numberOfRunTiles] == t + numberOfRunTiles) && (t + numberOfRunTiles < runEndTile))
+				++numberOfRunTiles;
+			priv_setGridRowQuads(vertices, grid, t, numberOfRunTiles, depthRatio);
+			vertices += numberOfRunTiles * numberOfVerticesPerQuad;
+			previousTile = t + numberOfRunTiles - 1u;
+			i += numberOfRunTiles;
+		}
+	}
+		break;
+	case GroupType::SparseGrid:
+	{
+		const SparseGrid& sparseGrid{ sparseGrids[groupId.groupIndex] };
+		const float depthRatio{ priv_getBuiltDepthRatio(groupId) };
+
+		// active tiles are grouped by chunk so a chunk is only looked up when the next tile is in a different one
+		constexpr std::size_t rowWidth{ SparseGrid::rowWidth };
+		constexpr std::size_t chunkSize{ SparseGrid::chunkSize };
+		sf::Vector2<std::size_t> chunkLocation{ 0u, 0u };
+		const TileIdType* chunkTileIds{ nullptr };
+		for (std::size_t i{ 0u }; i < numberOfActiveTiles; ++i)
+		{
+			const std::size_t t{ activeTiles[i] };
+			const sf::Vector2<std::size_t> location{ t % rowWidth, t / rowWidth };
+			const sf::Vector2<std::size_t> tileChunkLocation{ location.x / chunkSize, location.y / chunkSize };
+			if ((chunkTileIds == nullptr) || (tileChunkLocation != chunkLocation))
+			{
+				chunkLocation = tileChunkLocation;
+				chunkTileIds = sparseGrid.getChunkTileIds(chunkLocation);
+			}
+			priv_setSparseGridTileQuad(vertices, sparseGrid, t, chunkTileIds[((location.y % chunkSize) * chunkSize) + (location.x % chunkSize)], depthRatio);
+			vertices += numberOfVerticesPerQuad;
+		}
+	}
+		break;
+	default:
+	case GroupType::Layer:
+	{
+		const float depthRatio{ priv_getBuiltDepthRatio(groupId) };
+		for (std::size_t i{ 0u }; i < numberOfActiveTiles; ++i)
+		{
+			priv_setLayerTileQuad(vertices, groupId.groupIndex, activeTiles[i], depthRatio);
+			vertices += numberOfVerticesPerQuad;
+		}
+	}
+		break;
+	}
 }
 
-inline void Map::priv_update() const
+inline void Map::priv_setGridRowQuads(sf::Vertex* vertices, const Grid& grid, const std::size_t firstTileIndex, const std::size_t numberOfTiles, const float depthRatio) const
 {
-	m_isUpdateRequired = false;
+	// sets the quads of consecutive tiles in a row that have no texture transforms (the same result as setting each one with priv_setGridTileQuad)
+	const sf::Vector2f vanishingPoint{ m_view.getCenter() + m_vanishingPointOffsetFromCenter };
+	const std::size_t firstColumn{ firstTileIndex % grid.rowWidth };
+	const float y{ grid.position.y + grid.tileSize.y * (firstTileIndex / grid.rowWidth) };
+	const float top{ (((y - grid.tileExpand.y) - vanishingPoint.y) * depthRatio) + vanishingPoint.y };
+	const float bottom{ ((((y + grid.tileSize.y) + grid.tileExpand.y) - vanishingPoint.y) * depthRatio) + vanishingPoint.y };
+	std::size_t i{ 0u };
+
+#ifdef CHEESEMAP_SSE2
+	// four tiles at a time: their positions are calculated together and each quad is shuffled together from its corners, texture coordinates and colour
+	// (this relies on sf::Vertex being position, colour and texture coordinates packed together)
+	constexpr bool isVertexPacked{ (sizeof(sf::Vertex) == 5u * sizeof(float)) && (sizeof(sf::Color) == sizeof(float)) && (sizeof(TextureCoords) == 4u * sizeof(float)) };
+	if (isVertexPacked && (firstColumn + numberOfTiles <= static_cast<std::size_t>(INT_MAX)))
+	{
+		std::uint32_t colorBits{};
+		std::memcpy(&colorBits, &grid.color, sizeof(colorBits));
+		const __m128 color{ _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(colorBits))) };
+		const __m128 texInset{ _mm_setr_ps(grid.texInset.x, grid.texInset.y, -grid.texInset.x, -grid.texInset.y) };
+		const __m128 topBottom{ _mm_setr_ps(top, bottom, top, bottom) };
+		const __m128 topColor{ _mm_shuffle_ps(_mm_set1_ps(top), color, _MM_SHUFFLE(0, 0, 0, 0)) }; // T T c c
+		const __m128 bottomColor{ _mm_shuffle_ps(_mm_set1_ps(bottom), color, _MM_SHUFFLE(0, 0, 0, 0)) }; // B B c c
+		const __m128 gridLeft{ _mm_set1_ps(grid.position.x) };
+		const __m128 tileWidth{ _mm_set1_ps(grid.tileSize.x) };
+		const __m128 tileExpand{ _mm_set1_ps(grid.tileExpand.x) };
+		const __m128 vanishingPointX{ _mm_set1_ps(vanishingPoint.x) };
+		const __m128 ratio{ _mm_set1_ps(depthRatio) };
+
+		auto setQuad = [&](float* const quad, const __m128 corners, const std::size_t tileId) // corners: L R T B
+		{
+			const __m128 uv{ _mm_add_ps(_mm_loadu_ps(&m_textureCoords[tileId].topLeft.x), texInset) }; // u0 v0 u1 v1
+			const __m128 colorU0{ _mm_shuffle_ps(color, uv, _MM_SHUFFLE(0, 0, 0, 0)) }; // c c u0 u0
+			const __m128 colorU1V0{ _mm_shuffle_ps(color, uv, _MM_SHUFFLE(1, 2, 0, 0)) }; // c c u1 v0
+			_mm_storeu_ps(quad, _mm_shuffle_ps(corners, colorU0, _MM_SHUFFLE(2, 1, 2, 0))); // L T c u0
+			_mm_storeu_ps(quad + 4, _mm_shuffle_ps(_mm_shuffle_ps(uv, corners, _MM_SHUFFLE(0, 0, 1, 1)), bottomColor, _MM_SHUFFLE(2, 0, 2, 0))); // v0 L B c
+			_mm_storeu_ps(quad + 8, _mm_shuffle_ps(uv, corners, _MM_SHUFFLE(2, 1, 3, 0))); // u0 v1 R T
+			_mm_storeu_ps(quad + 12, _mm_shuffle_ps(colorU1V0, _mm_shuffle_ps(uv, corners, _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(2, 0, 2, 0))); // c u1 v0 R
+			_mm_storeu_ps(quad + 16, _mm_shuffle_ps(topColor, colorU1V0, _MM_SHUFFLE(3, 2, 2, 0))); // T c u1 v0
+			_mm_storeu_ps(quad + 20, _mm_shuffle_ps(corners, colorU0, _MM_SHUFFLE(2, 1, 3, 0))); // L B c u0
+			_mm_storeu_ps(quad + 24, _mm_shuffle_ps(_mm_shuffle_ps(uv, corners, _MM_SHUFFLE(1, 1, 3, 3)), bottomColor, _MM_SHUFFLE(2, 0, 2, 0))); // v1 R B c
+			_mm_storeh_pi(reinterpret_cast<__m64*>(quad + 28), uv); // u1 v1
+		};
+
+		float* quads{ reinterpret_cast<float*>(vertices) };
+		for (; i + 4u <= numberOfTiles; i += 4u)
+		{
+			const __m128 columns{ _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(static_cast<int>(firstColumn + i)), _mm_setr_epi32(0, 1, 2, 3))) };
+			const __m128 x{ _mm_add_ps(gridLeft, _mm_mul_ps(tileWidth, columns)) };
+			const __m128 left{ _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_sub_ps(x, tileExpand), vanishingPointX), ratio), vanishingPointX) };
+			const __m128 right{ _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_add_ps(x, tileWidth), tileExpand), vanishingPointX), ratio), vanishingPointX) };
+			const __m128 leftRight01{ _mm_unpacklo_ps(left, right) }; // L0 R0 L1 R1
+			const __m128 leftRight23{ _mm_unpackhi_ps(left, right) }; // L2 R2 L3 R3
+			const TileIdType* const tileIds{ grid.getTileIds() + firstTileIndex + i };
+			setQuad(quads, _mm_movelh_ps(leftRight01, topBottom), tileIds[0u]);
+			setQuad(quads + 30, _mm_movehl_ps(topBottom, leftRight01), tileIds[1u]);
+			setQuad(quads + 60, _mm_movelh_ps(leftRight23, topBottom), tileIds[2u]);
+			setQuad(quads + 90, _mm_movehl_ps(topBottom, leftRight23), tileIds[3u]);
+			quads += 120;
+		}
+		vertices += i * numberOfVerticesPerQuad;
+	}
+#endif // CHEESEMAP_SSE2
+
+	for (; i < numberOfTiles; ++i)
+	{
+		const float x{ grid.position.x + grid.tileSize.x * (firstColumn + i) };
+		const TextureCoords& textureCoords{ m_textureCoords[grid.getTileIds()[firstTileIndex + i]] };
+		priv_setQuad(
+			vertices,
+			{ (((x - grid.tileExpand.x) - vanishingPoint.x) * depthRatio) + vanishingPoint.x, top },
+			{ ((((x + grid.tileSize.x) + grid.tileExpand.x) - vanishingPoint.x) * depthRatio) + vanishingPoint.x, bottom },
+			textureCoords.topLeft + grid.texInset,
+			textureCoords.bottomRight - grid.texInset,
+			grid.color,
+			false,
+			false,
+			false);
+		vertices += numberOfVerticesPerQuad;
+	}
+}
 
+inline void Map::priv_setGridTileQuad(sf::Vertex* const vertices, const std::size_t gridIndex, const std::size_t tileIndex, const Grid::TileTextureTransform* tileTextureTransform, const float depthRatio) const
+{
+	const Grid& grid{ grids[gridIndex] };
+	Tile tile{};
+	TextureTransform textureTransform{};
+	tile.id = grid.getTileIds()[tileIndex];
+	tile.size = grid.tileSize;
+	tile.position = { grid.position.x + tile.size.x * (tileIndex % grid.rowWidth), grid.position.y + tile.size.y * (tileIndex / grid.rowWidth) };
+	tile.expand = grid.tileExpand;
+	if (tileTextureTransform != nullptr)
+	{
+		textureTransform = tileTextureTransform->textureTransform;
+		tile.expand += tileTextureTransform->tileExpand;
+	}
+	priv_setTileQuad(vertices, tile, textureTransform, grid.texInset, grid.color, depthRatio);
+}
+
+inline void Map::priv_setGridBlockQuad(sf::Vertex* const vertices, const std::size_t gridIndex, const std::size_t tileIndex, const std::size_t level, const Grid::TileTextureTransform* tileTextureTransform, const float depthRatio) const
+{
+	// the block that contains the tile, drawn as that tile (blocks on the grid's right and bottom edges only cover the tiles that are within it)
+	const Grid& grid{ grids[gridIndex] };
+	const std::size_t numberOfRows{ ((grid.getNumberOfTiles() - 1u) / grid.rowWidth) + 1u };
+	const sf::Vector2<std::size_t> firstCell{ ((tileIndex % grid.rowWidth) >> level) << level, ((tileIndex / grid.rowWidth) >> level) << level };
+	const std::size_t blockCells{ std::size_t{ 1u } << level };
+	Tile tile{};
+	TextureTransform textureTransform{};
+	tile.id = grid.getTileIds()[tileIndex];
+	tile.size = { grid.tileSize.x * std::min(blockCells, grid.rowWidth - firstCell.x), grid.tileSize.y * std::min(blockCells, numberOfRows - firstCell.y) };
+	tile.position = { grid.position.x + grid.tileSize.x * firstCell.x, grid.position.y + grid.tileSize.y * firstCell.y };
+	tile.expand = grid.tileExpand;
+	if (tileTextureTransform != nullptr)
+	{
+		textureTransform = tileTextureTransform->textureTransform;
+		tile.expand += tileTextureTransform->tileExpand;
+	}
+	priv_setTileQuad(vertices, tile, textureTransform, grid.texInset, grid.color, depthRatio);
+}
 
+inline void Map::priv_setSparseGridTileQuad(sf::Vertex* const vertices, const SparseGrid& sparseGrid, const std::size_t tileIndex, const TileIdType tileId, const float depthRatio) const
+{
+	Tile tile{};
+	tile.id = tileId;
+	tile.size = sparseGrid.tileSize;
+	tile.position = { sparseGrid.position.x + tile.size.x * (tileIndex % SparseGrid::rowWidth), sparseGrid.position.y + tile.size.y * (tileIndex / SparseGrid::rowWidth) };
+	tile.expand = sparseGrid.tileExpand;
+	priv_setTileQuad(vertices, tile, TextureTransform{}, sparseGrid.texInset, sparseGrid.color, depthRatio);
+}
 
-	const std::size_t numberOfTextureAtlasRectangle{ textureAtlas.size() };
+inline void Map::priv_setLayerTileQuad(sf::Vertex* const vertices, const std::size_t layerIndex, const std::size_t tileIndex, const float depthRatio) const
+{
+	const Layer& layer{ layers[layerIndex] };
+	const Tile& tileControl{ layer.tiles[tileIndex] };
+	Tile tile{ tileControl };
+	if (tileControl.isTemplate)
+	{
+		const TileTemplate& templateTile{ tileTemplates[tileControl.id] };
+		tile.id = templateTile.id;
+		tile.size.x *= templateTile.size.x;
+		tile.size.y *= templateTile.size.y;
+		tile.expand += templateTile.expand;
+	}
+	tile.position += layer.offset;
+	priv_setTileQuad(vertices, tile, tile.textureTransform, layer.texInset, layer.color, depthRatio);
+}
+
+inline void Map::priv_setTileQuad(sf::Vertex* const vertices, const Tile& tile, const TextureTransform& textureTransform, sf::Vector2f texInset, const sf::Color color, const float depthRatio) const
+{
+	texInset += textureTransform.texInset;
+
+	// texture coordinates come from the table (rather than the texture atlas) so that animated ids use their current frame
+	priv_setQuad(
+		vertices,
+		priv_pointWithDepth(tile.position - tile.expand, depthRatio),
+		priv_pointWithDepth(tile.position + tile.size + tile.expand, depthRatio),
+		m_textureCoords[tile.id].topLeft + texInset,
+		m_textureCoords[tile.id].bottomRight - texInset,
+		color,
+		textureTransform.flipX,
+		textureTransform.flipY,
+		textureTransform.turn);
+}
 
-	const sf::Vector2f viewCenter{ m_view.getCenter() };
-	const sf::Vector2f viewSize{ m_view.getSize() };
+inline sf::FloatRect Map::priv_getEffectiveViewRectangle(const sf::View& view) const
+{
+	const sf::Vector2f viewCenter{ view.getCenter() };
+	const sf::Vector2f viewSize{ view.getSize() };
 	const sf::Vector2f viewHalfSize{ viewSize / 2.f };
 
 	// an axis-aligned rectangle that encompasses view rectangle even if rotated
 	sf::FloatRect effectiveViewRectangle{ viewCenter - viewHalfSize, viewSize };
 
-	if (m_view.getRotation().asDegrees() != 0.f)
+	if (view.getRotation().asDegrees() != 0.f)
 	{
 		auto rotatePoint = [](sf::Vector2f& p, const float cos, const float sin) { p = { p.x * cos - p.y * sin, p.y * cos + p.x * sin }; };
 
 		sf::Vector2f topLeft{ -viewHalfSize };
 		sf::Vector2f topRight{ -topLeft.x, topLeft.y };
 
-		const float angle{ m_view.getRotation().asRadians() };
+		const float angle{ view.getRotation().asRadians() };
 		const float sine{ std::sin(angle) };
 		const float cosine{ std::cos(angle) };
 
@@ -456,211 +3144,276 @@ inline void Map::priv_update() const
 		effectiveViewRectangle = { min, max - min };
 	}
 
+	return effectiveViewRectangle;
+}
 
+inline float Map::priv_getDepthRatio(float depth) const
+{
+	float depthRatio{ 1.f };
+	depth -= m_depthOffset;
+	const float adjustedDepth{ m_depthMultiplier * depth };
+	if ((depth > 0.f) && (adjustedDepth != 0.f))
+		depthRatio = 1.f / adjustedDepth;
+	return depthRatio;
+}
 
-	struct TileId
-	{
-		enum class GroupType
-		{
-			Layer,
-			Grid,
-		} groupType;
-		std::size_t groupIndex; // index of layer or grid
-		std::size_t tileIndex; // index of tile within specific layer or grid
-	};
-	std::vector<TileId> activeTiles{};
+inline sf::Vector2f Map::priv_pointWithDepth(const sf::Vector2f point, const float depthRatio) const
+{
+	const sf::Vector2f vanishingPoint{ m_view.getCenter() + m_vanishingPointOffsetFromCenter };
+	return ((point - vanishingPoint) * depthRatio) + vanishingPoint;
+}
 
-	auto pointWithDepth = [&](const sf::Vector2f& p, const float dr) { return ((p - (viewCenter + m_vanishingPointOffsetFromCenter)) * dr) + (viewCenter + m_vanishingPointOffsetFromCenter); };
-	auto pointDepthScale = [&](const sf::Vector2f p, const float dr) { return p * dr; };
+inline sf::Vector2f Map::priv_pointWithoutDepth(const sf::Vector2f point, const float depthRatio) const
+{
+	const sf::Vector2f vanishingPoint{ m_view.getCenter() + m_vanishingPointOffsetFromCenter };
+	return ((point - vanishingPoint) / depthRatio) + vanishingPoint;
+}
 
-	sf::FloatRect tileBounds{};
+inline sf::FloatRect Map::priv_rectangleWithoutDepth(const sf::FloatRect& rectangle, const float depthRatio) const
+{
+	return{ priv_pointWithoutDepth(rectangle.position, depthRatio), priv_pointDepthUnscale(rectangle.size, depthRatio) };
+}
 
+inline sf::Vector2f Map::priv_pointDepthScale(const sf::Vector2f point, const float depthRatio) const
+{
+	return point * depthRatio;
+}
 
+inline sf::Vector2f Map::priv_pointDepthUnscale(const sf::Vector2f point, const float depthRatio) const
+{
+	return point / depthRatio;
+}
 
-	// test layers' tiles
-	for (std::size_t l{ 0u }, numberOfLayers{ layers.size() }; l < numberOfLayers; ++l)
+inline sf::FloatRect Map::priv_getLayerTileBounds(const Tile& tile) const
+{
+	// bounds without the layer's offset (or depth)
+	sf::Vector2f tileSize{ tile.size };
+	if (tile.isTemplate && (tile.id < tileTemplates.size()))
 	{
-		const float depth{ layers[l].depth - m_depthOffset };
-
-		if ((!layers[l].isActive) || (depth <= 0.f))
-			continue;
+		const sf::Vector2f tileTemplateSize{ tileTemplates[tile.id].size };
+		tileSize.x *= tileTemplateSize.x;
+		tileSize.y *= tileTemplateSize.y;
+	}
+	return{ tile.position, tileSize };
+}
 
-		if (m_useRangeZ && ((layers[l].zOrder < m_rangeMinZ) || (layers[l].zOrder > m_rangeMaxZ)))
-			continue;
-		if (m_useRangeDepth && ((depth < m_rangeMinDepth) || (depth > m_rangeMaxDepth)))
-			continue;
+inline const SpatialIndex* Map::priv_getLayerSpatialIndex(const std::size_t layerIndex) const
+{
+	const Layer& layer{ layers[layerIndex] };
+	if (!layer.useSpatialIndex)
+		return nullptr;
 
-		float depthRatio{ 1.f };
-		const float adjustedDepth{ m_depthMultiplier * depth };
-		if ((depth > 0.f) && (adjustedDepth != 0.f))
-			depthRatio = 1.f / adjustedDepth;
+	if (m_layerSpatialIndices.size() != layers.size())
+		m_layerSpatialIndices.resize(layers.size());
 
-		for (std::size_t t{ 0u }, numberOfTiles{ layers[l].tiles.size() }; t < numberOfTiles; ++t)
-		{
-			if (!layers[l].tiles[t].isActive)
-				continue;
+	LayerSpatialIndex& layerSpatialIndex{ m_layerSpatialIndices[layerIndex] };
+	if (!layerSpatialIndex.isValid || (layerSpatialIndex.tiles != layer.tiles.data()) || (layerSpatialIndex.numberOfTiles != layer.tiles.size()))
+	{
+		layerSpatialIndex.spatialIndex.build(layer.tiles.size(), [&](const std::size_t t) { return priv_getLayerTileBounds(layer.tiles[t]); });
+		layerSpatialIndex.tiles = layer.tiles.data();
+		layerSpatialIndex.numberOfTiles = layer.tiles.size();
+		layerSpatialIndex.isValid = true;
+	}
+	return &layerSpatialIndex.spatialIndex;
+}
 
-			bool isAnActiveTile{ false };
-			if (!layers[l].tiles[t].isTemplate)
-			{
-				tileBounds = { layers[l].tiles[t].position + layers[l].offset, layers[l].tiles[t].size };
-				if (layers[l].tiles[t].id < numberOfTextureAtlasRectangle)
-					isAnActiveTile = true;
-			}
-			else if (tileTemplates[layers[l].tiles[t].id].isActive)
-			{
-				tileBounds = { layers[l].tiles[t].position + layers[l].offset, { layers[l].tiles[t].size.x * tileTemplates[layers[l].tiles[t].id].size.x, layers[l].tiles[t].size.y * tileTemplates[layers[l].tiles[t].id].size.y } };
-				if (tileTemplates[layers[l].tiles[t].id].id < numberOfTextureAtlasRectangle)
-					isAnActiveTile = true;
-			}
+inline std::size_t Map::priv_getGridLevelOfDetail(const std::size_t gridIndex) const
+{
+	// the smallest level (each halving the number of blocks in both directions) at which the grid's blocks are drawn at least as large as the minimum tile size for the current view
+	// (0 draws every tile). the level never goes beyond a single block
+	if (!m_useGridLevelOfDetail)
+		return 0u;
 
-			tileBounds = { pointWithDepth(tileBounds.position, depthRatio), pointDepthScale(tileBounds.size, depthRatio) };
+	const Grid& grid{ grids[gridIndex] };
+	const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+	const sf::Vector2f viewSize{ std::abs(m_view.getSize().x), std::abs(m_view.getSize().y) };
+	const float depthRatio{ priv_getDepthRatio(grid.depth) };
+	if ((numberOfTiles == 0u) || (grid.rowWidth == 0u) || (grid.tileSize.x <= 0.f) || (grid.tileSize.y <= 0.f) || (viewSize.x <= 0.f) || (viewSize.y <= 0.f) || (depthRatio <= 0.f))
+		return 0u;
+
+	float tileSize{ std::min(grid.tileSize.x * m_levelOfDetailTargetSize.x / viewSize.x, grid.tileSize.y * m_levelOfDetailTargetSize.y / viewSize.y) * depthRatio };
+	std::size_t numberOfBlocks{ std::max(grid.rowWidth, ((numberOfTiles - 1u) / grid.rowWidth) + 1u) };
+	std::size_t level{ 0u };
+	while ((tileSize < m_levelOfDetailMinTileSize) && (numberOfBlocks > 1u))
+	{
+		tileSize *= 2.f;
+		numberOfBlocks = (numberOfBlocks + 1u) / 2u;
+		++level;
+	}
+	return level;
+}
 
-			if (!effectiveViewRectangle.findIntersection(tileBounds))
-				isAnActiveTile = false;
+inline const Map::GridLevel& Map::priv_getGridLevel(const std::size_t gridIndex, const std::size_t level) const
+{
+	// each level is built (from the level below it) when it's first required and kept until the grid changes
+	const Grid& grid{ grids[gridIndex] };
+	if (m_gridLevels.size() != grids.size())
+		m_gridLevels.resize(grids.size());
 
-			if (isAnActiveTile)
-				activeTiles.push_back({ TileId::GroupType::Layer, l, t });
-		}
+	GridLevels& gridLevels{ m_gridLevels[gridIndex] };
+	if (!gridLevels.isValid || (gridLevels.tileIds != grid.getTileIds()) || (gridLevels.numberOfTiles != grid.getNumberOfTiles()) || (gridLevels.rowWidth != grid.rowWidth))
+	{
+		gridLevels.levels.clear();
+		gridLevels.tileIds = grid.getTileIds();
+		gridLevels.numberOfTiles = grid.getNumberOfTiles();
+		gridLevels.rowWidth = grid.rowWidth;
+		gridLevels.isValid = true;
 	}
 
-	// test grids' tiles
-	for (std::size_t g{ 0u }, numberOfGrids{ grids.size() }; g < numberOfGrids; ++g)
+	const std::size_t numberOfRows{ ((grid.getNumberOfTiles() - 1u) / grid.rowWidth) + 1u };
+	while (gridLevels.levels.size() < level)
 	{
-		const float depth{ grids[g].depth - m_depthOffset };
-
-		if ((!grids[g].isActive) || (depth <= 0.f))
-			continue;
-
-		if (m_useRangeZ && (grids[g].zOrder < m_rangeMinZ || grids[g].zOrder > m_rangeMaxZ))
-			continue;
-		if (m_useRangeDepth && (depth < m_rangeMinDepth || depth > m_rangeMaxDepth))
-			continue;
-
-		float depthRatio{ 1.f };
-		const float adjustedDepth{ m_depthMultiplier * depth };
-		if ((depth > 0.f) && (adjustedDepth != 0.f))
-			depthRatio = 1.f / adjustedDepth;
-
-		for (std::size_t t{ 0u }, numberOfTiles{ grids[g].tileIds.size() }; t < numberOfTiles; ++t)
+		const std::size_t newLevel{ gridLevels.levels.size() + 1u };
+		const std::size_t blockCells{ std::size_t{ 1u } << newLevel };
+		gridLevels.levels.emplace_back();
+		GridLevel& gridLevel{ gridLevels.levels.back() };
+		gridLevel.numberOfBlocks = { (grid.rowWidth + blockCells - 1u) >> newLevel, (numberOfRows + blockCells - 1u) >> newLevel };
+		gridLevel.blockTiles.assign(gridLevel.numberOfBlocks.x * gridLevel.numberOfBlocks.y, noQuad);
+		for (std::size_t y{ 0u }; y < gridLevel.numberOfBlocks.y; ++y)
 		{
-			sf::Vector2<std::size_t> tileLocation{ t % grids[g].rowWidth, t / grids[g].rowWidth };
-			tileBounds = { { grids[g].position.x + (tileLocation.x * grids[g].tileSize.x), grids[g].position.y + (tileLocation.y * grids[g].tileSize.y) }, grids[g].tileSize };
-			tileBounds = { pointWithDepth(tileBounds.position, depthRatio), pointDepthScale(tileBounds.size, depthRatio) };
-			//const bool isTileWithinRange{  };
-
-			if ((grids[g].tileIds[t] != grids[g].invisibleId) && effectiveViewRectangle.findIntersection(tileBounds) && (grids[g].tileIds[t] < numberOfTextureAtlasRectangle))
-				activeTiles.push_back({ TileId::GroupType::Grid, g, t });
+			for (std::size_t x{ 0u }; x < gridLevel.numberOfBlocks.x; ++x)
+				priv_setGridLevelBlock(grid, gridLevels.levels, newLevel, { x, y });
 		}
 	}
+	return gridLevels.levels[level - 1u];
+}
+
+inline void Map::priv_setGridLevelBlock(const Grid& grid, std::vector<GridLevel>& levels, const std::size_t level, const sf::Vector2<std::size_t> block) const
+{
+	// a block is drawn as the most common tile of its four smaller blocks (or tiles, for level 1); ties choose the first of them. blocks without any drawn tiles are not drawn
+	GridLevel& gridLevel{ levels[level - 1u] };
+	if ((block.x >= gridLevel.numberOfBlocks.x) || (block.y >= gridLevel.numberOfBlocks.y))
+		return;
 
-	// sort active tiles by z, regardless of if it's a layer or grid
-	std::sort(activeTiles.begin(), activeTiles.end(), [&](const TileId lhs, const TileId rhs)
+	const TileIdType* tileIds{ grid.getTileIds() };
+	const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+	std::size_t candidates[4u]{};
+	std::size_t numberOfCandidates{ 0u };
+	for (std::size_t y{ block.y * 2u }; y < (block.y * 2u) + 2u; ++y)
+	{
+		for (std::size_t x{ block.x * 2u }; x < (block.x * 2u) + 2u; ++x)
 		{
-			std::size_t left{ 0u }, right{ 0u };
-			switch (lhs.groupType)
-			{
-			case TileId::GroupType::Grid:
-				left = grids[lhs.groupIndex].zOrder;
-				break;
-			default:
-			case TileId::GroupType::Layer:
-				left = layers[lhs.groupIndex].zOrder;
-				break;
-			}
-			switch (rhs.groupType)
+			std::size_t candidate{ noQuad };
+			if (level == 1u)
 			{
-			case TileId::GroupType::Grid:
-				right = grids[rhs.groupIndex].zOrder;
-				break;
-			default:
-			case TileId::GroupType::Layer:
-				right = layers[rhs.groupIndex].zOrder;
-				break;
+				const std::size_t t{ (y * grid.rowWidth) + x };
+				if ((x < grid.rowWidth) && (t < numberOfTiles) && (tileIds[t] != grid.invisibleId) && (tileIds[t] < textureAtlas.size()))
+					candidate = t;
 			}
-			return (left < right);
-		});
-
-	// build vertex array
-	constexpr std::size_t numOfVerticesPerQuad{ 6u };
-	m_vertices.resize(activeTiles.size() * numOfVerticesPerQuad);
-	std::size_t startVertex{ 0u };
-	for (auto& activeTile : activeTiles)
-	{
-		float tileDepth{ 0.f };
-		Tile tile{};
-		TextureTransform textureTransform{};
-		sf::Color color{};
-		sf::Vector2f texInset{};
-		switch (activeTile.groupType)
-		{
-		case TileId::GroupType::Grid:
-		{
-			texInset = grids[activeTile.groupIndex].texInset;
-			tile.id = grids[activeTile.groupIndex].tileIds[activeTile.tileIndex];
-			tile.size = grids[activeTile.groupIndex].tileSize;
-			const std::size_t rowWidth{ grids[activeTile.groupIndex].rowWidth };
-			const sf::Vector2f position{ grids[activeTile.groupIndex].position };
-			tile.position = { position.x + tile.size.x * (activeTile.tileIndex % rowWidth), position.y + tile.size.y * (activeTile.tileIndex / rowWidth) };
-			tileDepth = grids[activeTile.groupIndex].depth;
-			auto tt{ std::find_if(grids[activeTile.groupIndex].tileTextureTransforms.begin(), grids[activeTile.groupIndex].tileTextureTransforms.end(),
-				[&](const Grid::TileTextureTransform& ttt) { return ttt.tileIndex == activeTile.tileIndex; }
-				) };
-			tile.expand = grids[activeTile.groupIndex].tileExpand;
-			if (tt != grids[activeTile.groupIndex].tileTextureTransforms.end())
+			else
 			{
-				textureTransform = tt->textureTransform;
-				tile.expand += tt->tileExpand;
+				const GridLevel& smallerLevel{ levels[level - 2u] };
+				if ((x < smallerLevel.numberOfBlocks.x) && (y < smallerLevel.numberOfBlocks.y))
+					candidate = smallerLevel.blockTiles[(y * smallerLevel.numberOfBlocks.x) + x];
 			}
-			color = grids[activeTile.groupIndex].color;
+			if (candidate != noQuad)
+				candidates[numberOfCandidates++] = candidate;
 		}
-			break;
-		default:
-		case TileId::GroupType::Layer:
-		{
-			texInset = layers[activeTile.groupIndex].texInset;
-			const Tile& tileControl{ layers[activeTile.groupIndex].tiles[activeTile.tileIndex] };
-			tile = tileControl;
-			textureTransform = tile.textureTransform;
-			if (tileControl.isTemplate)
-			{
-				const TileTemplate& templateTile{ tileTemplates[tileControl.id] };
-				tile.id = templateTile.id;
-				tile.size.x *= templateTile.size.x;
-				tile.size.y *= templateTile.size.y;
-				tile.expand += templateTile.expand;
-			}
-			tile.position += layers[activeTile.groupIndex].offset;
-			tileDepth = layers[activeTile.groupIndex].depth;
-			color = layers[activeTile.groupIndex].color;
+	}
+
+	std::size_t blockTile{ noQuad };
+	std::size_t blockTileCount{ 0u };
+	for (std::size_t c{ 0u }; c < numberOfCandidates; ++c)
+	{
+		std::size_t count{ 0u };
+		for (std::size_t other{ 0u }; other < numberOfCandidates; ++other)
+		{
+			if (tileIds[candidates[other]] == tileIds[candidates[c]])
+				++count;
 		}
-			break;
+		if (count > blockTileCount)
+		{
+			blockTile = candidates[c];
+			blockTileCount = count;
 		}
-		texInset += textureTransform.texInset;
+	}
+	gridLevel.blockTiles[(block.y * gridLevel.numberOfBlocks.x) + block.x] = blockTile;
+}
 
-		float depthRatio{ 1.f };
-		tileDepth -= m_depthOffset;
-		const float adjustedDepth{ m_depthMultiplier * tileDepth };
-		if ((tileDepth > 0.f) && (adjustedDepth != 0.f))
-			depthRatio = 1.f / adjustedDepth;
+inline std::size_t Map::priv_getLayerTileIndexAtLocalCoord(const std::size_t layerIndex, const sf::Vector2f localCoord, std::vector<std::size_t>& candidateTiles) const
+{
+	// returns the index of the first active tile that contains the coord (or the number of tiles if none do). the coord has the layer's depth removed so that it matches what is drawn
+	const Layer& layer{ layers[layerIndex] };
+	const std::size_t numberOfTiles{ layer.tiles.size() };
+	const float depthRatio{ priv_getDepthRatio(layer.depth) };
+	const sf::Vector2f layerCoord{ (depthRatio == 1.f) ? localCoord : priv_pointWithoutDepth(localCoord, depthRatio) };
 
-		priv_setQuad(
-			startVertex,
-			pointWithDepth(tile.position - tile.expand, depthRatio),
-			pointWithDepth(tile.position + tile.size + tile.expand, depthRatio),
-			textureAtlas[tile.id].position + texInset,
-			textureAtlas[tile.id].position + textureAtlas[tile.id].size - texInset,
-			color,
-			textureTransform.flipX,
-			textureTransform.flipY,
-			textureTransform.turn);
-		startVertex += numOfVerticesPerQuad;
+	auto doesTileContainCoord = [&](const std::size_t t)
+	{
+		const Tile& tile{ layer.tiles[t] };
+		if (!tile.isActive)
+			return false;
+
+		sf::FloatRect tileRect{ priv_getLayerTileBounds(tile) };
+		tileRect.position += layer.offset;
+		return tileRect.contains(layerCoord);
+	};
+
+	const SpatialIndex* spatialIndex{ priv_getLayerSpatialIndex(layerIndex) };
+	if (spatialIndex != nullptr)
+	{
+		candidateTiles.clear();
+		spatialIndex->query(layerCoord - layer.offset, candidateTiles);
+		for (const std::size_t t : candidateTiles)
+		{
+			if (doesTileContainCoord(t))
+				return t;
+		}
+	}
+	else
+	{
+		for (std::size_t t{ 0u }; t < numberOfTiles; ++t)
+		{
+			if (doesTileContainCoord(t))
+				return t;
+		}
 	}
+
+	return numberOfTiles;
+}
+
+inline std::size_t Map::priv_getGridTileIndexAtLocalCoord(const std::size_t gridIndex, const sf::Vector2f localCoord) const
+{
+	// returns the index of the tile whose cell contains the coord (or the number of tiles if none do)
+	// the coord has the grid's depth removed (so that it matches what is drawn) and then its cell is found directly
+	const Grid& grid{ grids[gridIndex] };
+	const std::size_t numberOfTiles{ grid.getNumberOfTiles() };
+	if ((numberOfTiles == 0u) || (grid.rowWidth == 0u) || (grid.tileSize.x <= 0.f) || (grid.tileSize.y <= 0.f))
+		return numberOfTiles;
+
+	const float depthRatio{ priv_getDepthRatio(grid.depth) };
+	const sf::Vector2f gridCoord{ ((depthRatio == 1.f) ? localCoord : priv_pointWithoutDepth(localCoord, depthRatio)) - grid.position };
+	const float column{ std::floor(gridCoord.x / grid.tileSize.x) };
+	const float row{ std::floor(gridCoord.y / grid.tileSize.y) };
+	const std::size_t numberOfRows{ ((numberOfTiles - 1u) / grid.rowWidth) + 1u };
+	if ((column < 0.f) || (row < 0.f) || (column >= static_cast<float>(grid.rowWidth)) || (row >= static_cast<float>(numberOfRows)))
+		return numberOfTiles;
+
+	const std::size_t tileIndex{ (static_cast<std::size_t>(row) * grid.rowWidth) + static_cast<std::size_t>(column) };
+	return (tileIndex < numberOfTiles) ? tileIndex : numberOfTiles;
+}
+
+inline std::size_t Map::priv_getSparseGridTileIndexAtLocalCoord(const std::size_t sparseGridIndex, const sf::Vector2f localCoord) const
+{
+	// returns the index of the (visible) tile whose cell contains the coord (or noQuad if none do). the same as priv_getGridTileIndexAtLocalCoord
+	const SparseGrid& sparseGrid{ sparseGrids[sparseGridIndex] };
+	if ((sparseGrid.tileSize.x <= 0.f) || (sparseGrid.tileSize.y <= 0.f))
+		return noQuad;
+
+	const float depthRatio{ priv_getDepthRatio(sparseGrid.depth) };
+	const sf::Vector2f gridCoord{ ((depthRatio == 1.f) ? localCoord : priv_pointWithoutDepth(localCoord, depthRatio)) - sparseGrid.position };
+	const float column{ std::floor(gridCoord.x / sparseGrid.tileSize.x) };
+	const float row{ std::floor(gridCoord.y / sparseGrid.tileSize.y) };
+	if ((column < 0.f) || (row < 0.f) || (column >= static_cast<float>(SparseGrid::rowWidth)) || (row >= static_cast<float>(SparseGrid::rowWidth)))
+		return noQuad;
+
+	const std::size_t tileIndex{ (static_cast<std::size_t>(row) * SparseGrid::rowWidth) + static_cast<std::size_t>(column) };
+	return (sparseGrid.getTileId(tileIndex) != sparseGrid.invisibleId) ? tileIndex : noQuad;
 }
 
 inline void Map::priv_setQuad
 (
-	const std::size_t startVertex,
+	sf::Vertex* const vertices,
 	const sf::Vector2f topLeft,
 	const sf::Vector2f bottomRight,
 	sf::Vector2f textureTopLeft,
@@ -670,6 +3423,33 @@ inline void Map::priv_setQuad
 	const bool flipY,
 	const bool turn
 ) const
+{
+	vertices[0u].position = topLeft;
+	vertices[1u].position = { topLeft.x, bottomRight.y };
+	vertices[2u].position = { bottomRight.x, topLeft.y };
+	vertices[3u].position = vertices[2u].position;
+	vertices[4u].position = vertices[1u].position;
+	vertices[5u].position = bottomRight;
+
+	priv_setQuadTextureCoords(vertices, textureTopLeft, textureBottomRight, flipX, flipY, turn);
+
+	vertices[0u].color = color;
+	vertices[1u].color = color;
+	vertices[2u].color = color;
+	vertices[3u].color = color;
+	vertices[4u].color = color;
+	vertices[5u].color = color;
+}
+
+inline void Map::priv_setQuadTextureCoords
+(
+	sf::Vertex* const vertices,
+	sf::Vector2f textureTopLeft,
+	sf::Vector2f textureBottomRight,
+	const bool flipX,
+	const bool flipY,
+	const bool turn
+) const
 {
 	if (flipX)
 	{
@@ -684,19 +3464,12 @@ inline void Map::priv_setQuad
 		textureBottomRight.y = top;
 	}
 
-	m_vertices[startVertex + 0u].position = topLeft;
-	m_vertices[startVertex + 1u].position = { topLeft.x, bottomRight.y };
-	m_vertices[startVertex + 2u].position = { bottomRight.x, topLeft.y };
-	m_vertices[startVertex + 3u].position = m_vertices[startVertex + 2u].position;
-	m_vertices[startVertex + 4u].position = m_vertices[startVertex + 1u].position;
-	m_vertices[startVertex + 5u].position = bottomRight;
-
-	m_vertices[startVertex + 0u].texCoords = textureTopLeft;
-	m_vertices[startVertex + 1u].texCoords = { textureTopLeft.x, textureBottomRight.y };
-	m_vertices[startVertex + 2u].texCoords = { textureBottomRight.x, textureTopLeft.y };
-	m_vertices[startVertex + 3u].texCoords = m_vertices[startVertex + 2u].texCoords;
-	m_vertices[startVertex + 4u].texCoords = m_vertices[startVertex + 1u].texCoords;
-	m_vertices[startVertex + 5u].texCoords = textureBottomRight;
+	vertices[0u].texCoords = textureTopLeft;
+	vertices[1u].texCoords = { textureTopLeft.x, textureBottomRight.y };
+	vertices[2u].texCoords = { textureBottomRight.x, textureTopLeft.y };
+	vertices[3u].texCoords = vertices[2u].texCoords;
+	vertices[4u].texCoords = vertices[1u].texCoords;
+	vertices[5u].texCoords = textureBottomRight;
 
 	if (turn)
 	{
@@ -706,20 +3479,13 @@ inline void Map::priv_setQuad
 		// | 1,4  5 | --> | 0  1,4 |
 		//  --------       --------
 
-		m_vertices[startVertex + 1u].texCoords = m_vertices[startVertex + 5u].texCoords;
-		m_vertices[startVertex + 2u].texCoords = m_vertices[startVertex + 0u].texCoords;
-		m_vertices[startVertex + 0u].texCoords = m_vertices[startVertex + 4u].texCoords;
-		m_vertices[startVertex + 5u].texCoords = m_vertices[startVertex + 3u].texCoords;
-		m_vertices[startVertex + 3u].texCoords = m_vertices[startVertex + 2u].texCoords;
-		m_vertices[startVertex + 4u].texCoords = m_vertices[startVertex + 1u].texCoords;
+		vertices[1u].texCoords = vertices[5u].texCoords;
+		vertices[2u].texCoords = vertices[0u].texCoords;
+		vertices[0u].texCoords = vertices[4u].texCoords;
+		vertices[5u].texCoords = vertices[3u].texCoords;
+		vertices[3u].texCoords = vertices[2u].texCoords;
+		vertices[4u].texCoords = vertices[1u].texCoords;
 	}
-
-	m_vertices[startVertex + 0u].color = color;
-	m_vertices[startVertex + 1u].color = color;
-	m_vertices[startVertex + 2u].color = color;
-	m_vertices[startVertex + 3u].color = color;
-	m_vertices[startVertex + 4u].color = color;
-	m_vertices[startVertex + 5u].color = color;
 }
 
 } // namespace cheesemap
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Map File
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+#include "Map.hpp"
+
+#include <string>
+
+namespace cheesemap
+{
+
+// a versioned binary map file (texture atlas and its texture pages, tile templates, animations, grids, layers and sparse grids) that is memory-mapped when it is loaded.
+// loaded grids' tile ids are not copied: they point into the mapped file (Grid::externalTileIds) so the file must stay loaded while the map uses them. sparse grids' tile ids are copied.
+// the mapping is read-only and shared so processes loading the same file share its pages
+class MapFile
+{
+public:
+	static constexpr std::uint32_t version{ 3u }; // version 1 files (without texture pages) and version 2 files (without sparse grids) can also be loaded (leaving the map without sparse grids)
+	static constexpr std::size_t tileIdsAlignment{ 64u }; // each grid's tile ids start on this boundary (from the start of the file)
+
+	MapFile();
+	~MapFile();
+	MapFile(const MapFile&) = delete;
+	MapFile& operator=(const MapFile&) = delete;
+
+	static void save(const Map& map, const std::string& filename); // throws Exception if the file can't be written
+	void load(Map& map, const std::string& filename); // replaces the map's texture atlas (and its texture pages), tile templates, animations, grids, layers and sparse grids (and updates the map) after completing any asynchronous update. a previously loaded file is unloaded. throws Exception (leaving the map unchanged) if the file can't be mapped or isn't a valid map file
+	void unload(); // any grids that use the file's tile ids must be changed (or removed) first
+	bool isLoaded() const;
+
+private:
+	class Writer;
+	class Reader;
+
+	static constexpr char identifier[8]{ 'C', 'H', 'E', 'E', 'S', 'E', 'M', 'F' };
+	static constexpr std::uint32_t byteOrderMark{ 0x01020304u };
+
+	const unsigned char* m_data;
+	std::size_t m_size;
+
+	static const unsigned char* priv_map(const std::string& filename, std::size_t& size);
+	static void priv_unmap(const unsigned char* data, std::size_t size);
+};
+
+} // namespace cheesemap
+#include "MapFile.inl"
@@ -0,0 +1,552 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Map File
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MapFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace cheesemap
+{
+
+// values are written in the byte order of the machine (which is checked when loading); bools as one byte and sizes as 64 bits
+class MapFile::Writer
+{
+public:
+	std::vector<unsigned char> bytes;
+
+	template <class T>
+	void write(const T value)
+	{
+		const std::size_t position{ bytes.size() };
+		bytes.resize(position + sizeof(T));
+		std::memcpy(bytes.data() + position, &value, sizeof(T));
+	}
+	template <class T>
+	void writeAt(const std::size_t position, const T value)
+	{
+		std::memcpy(bytes.data() + position, &value, sizeof(T));
+	}
+	void writeBool(const bool value) { write<std::uint8_t>(value ? 1u : 0u); }
+	void writeSize(const std::size_t value) { write<std::uint64_t>(value); }
+	void writeVector(const sf::Vector2f value) { write(value.x); write(value.y); }
+	void writeColor(const sf::Color value) { write(value.r); write(value.g); write(value.b); write(value.a); }
+	void writeTextureTransform(const TextureTransform& value) { writeBool(value.flipX); writeBool(value.flipY); writeBool(value.turn); writeVector(value.texInset); }
+};
+
+class MapFile::Reader
+{
+public:
+	Reader(const unsigned char* const data, const std::size_t size) : m_data{ data }, m_size{ size }, m_position{ 0u } { }
+
+	template <class T>
+	T read()
+	{
+		if (sizeof(T) > m_size - m_position)
+			throw Exception("Map file is truncated.");
+		T value;
+		std::memcpy(&value, m_data + m_position, sizeof(T));
+		m_position += sizeof(T);
+		return value;
+	}
+	bool readBool() { return read<std::uint8_t>() != 0u; }
+	std::size_t readSize()
+	{
+		const std::uint64_t value{ read<std::uint64_t>() };
+		if (value > static_cast<std::uint64_t>(static_cast<std::size_t>(-1)))
+			throw Exception("Map file has a size that is too large.");
+		return static_cast<std::size_t>(value);
+	}
+	std::size_t readCount()
+	{
+		// every counted item takes at least one byte so a larger count can't be valid (and isn't allocated)
+		const std::size_t count{ readSize() };
+		if (count > m_size - m_position)
+			throw Exception("Map file is truncated.");
+		return count;
+	}
+	TileIdType readTileId(const std::uint32_t tileIdSize)
+	{
+		// tile ids saved with a different tile id type are converted
+		switch (tileIdSize)
+		{
+		case 1u:
+			return static_cast<TileIdType>(read<std::uint8_t>());
+		case 2u:
+			return static_cast<TileIdType>(read<std::uint16_t>());
+		case 4u:
+			return static_cast<TileIdType>(read<std::uint32_t>());
+		default:
+		case 8u:
+			return static_cast<TileIdType>(read<std::uint64_t>());
+		}
+	}
+	sf::Vector2f readVector() { const float x{ read<float>() }; return{ x, read<float>() }; }
+	sf::Color readColor() { sf::Color value{}; value.r = read<std::uint8_t>(); value.g = read<std::uint8_t>(); value.b = read<std::uint8_t>(); value.a = read<std::uint8_t>(); return value; }
+	TextureTransform readTextureTransform() { TextureTransform value{}; value.flipX = readBool(); value.flipY = readBool(); value.turn = readBool(); value.texInset = readVector(); return value; }
+
+private:
+	const unsigned char* m_data;
+	std::size_t m_size;
+	std::size_t m_position;
+};
+
+inline MapFile::MapFile()
+	: m_data{ nullptr }
+	, m_size{ 0u }
+{
+
+}
+
+inline MapFile::~MapFile()
+{
+	unload();
+}
+
+inline void MapFile::save(const Map& map, const std::string& filename)
+{
+	// everything except the grids' tile ids is written first and then each grid's tile ids (aligned) so that they can be used directly from the mapped file
+	Writer writer{};
+	for (const char c : identifier)
+		writer.write(c);
+	writer.write(version);
+	writer.write(static_cast<std::uint32_t>(sizeof(TileIdType)));
+	writer.write(byteOrderMark);
+	writer.write(std::uint32_t{ 0u }); // reserved
+
+	writer.writeSize(map.textureAtlas.size());
+	for (const sf::FloatRect& textureAtlasRectangle : map.textureAtlas)
+	{
+		writer.writeVector(textureAtlasRectangle.position);
+		writer.writeVector(textureAtlasRectangle.size);
+	}
+	writer.writeSize(map.textureAtlasPages.size());
+	for (const std::size_t texturePage : map.textureAtlasPages)
+		writer.writeSize(texturePage);
+
+	writer.writeSize(map.tileTemplates.size());
+	for (const TileTemplate& tileTemplate : map.tileTemplates)
+	{
+		writer.writeBool(tileTemplate.isActive);
+		writer.writeSize(tileTemplate.id);
+		writer.writeVector(tileTemplate.size);
+		writer.writeVector(tileTemplate.expand);
+	}
+
+	writer.writeSize(map.animations.size());
+	for (const Animation& animation : map.animations)
+	{
+		writer.writeSize(animation.id);
+		writer.writeSize(animation.frames.size());
+		for (const Animation::Frame& frame : animation.frames)
+		{
+			writer.writeSize(frame.id);
+			writer.write(frame.duration);
+		}
+	}
+
+	std::vector<std::size_t> tileIdsOffsetPositions{};
+	writer.writeSize(map.grids.size());
+	for (const Grid& grid : map.grids)
+	{
+		writer.writeBool(grid.isActive);
+		writer.writeSize(grid.zOrder);
+		writer.write(grid.depth);
+		writer.writeVector(grid.tileSize);
+		writer.writeVector(grid.position);
+		writer.writeSize(grid.rowWidth);
+		writer.writeVector(grid.texInset);
+		writer.writeVector(grid.tileExpand);
+		writer.writeSize(grid.invisibleId);
+		writer.writeColor(grid.color);
+		writer.writeSize(grid.tileTextureTransforms.size());
+		for (const Grid::TileTextureTransform& tileTextureTransform : grid.tileTextureTransforms)
+		{
+			writer.writeSize(tileTextureTransform.tileIndex);
+			writer.writeVector(tileTextureTransform.tileExpand);
+			writer.writeTextureTransform(tileTextureTransform.textureTransform);
+		}
+		writer.writeSize(grid.getNumberOfTiles());
+		tileIdsOffsetPositions.push_back(writer.bytes.size());
+		writer.writeSize(0u); // tile ids offset (set below)
+	}
+
+	writer.writeSize(map.layers.size());
+	for (const Layer& layer : map.layers)
+	{
+		writer.writeBool(layer.isActive);
+		writer.writeSize(layer.zOrder);
+		writer.write(layer.depth);
+		writer.writeVector(layer.offset);
+		writer.writeVector(layer.texInset);
+		writer.writeVector(layer.tileExpand);
+		writer.writeColor(layer.color);
+		writer.writeBool(layer.useSpatialIndex);
+		writer.writeSize(layer.tiles.size());
+		for (const Tile& tile : layer.tiles)
+		{
+			writer.writeBool(tile.isActive);
+			writer.writeBool(tile.isTemplate);
+			writer.writeSize(tile.id);
+			writer.writeVector(tile.position);
+			writer.writeVector(tile.size);
+			writer.writeVector(tile.expand);
+			writer.writeTextureTransform(tile.textureTransform);
+		}
+	}
+
+	// sparse grids' chunks are written with their tile ids (in order of location so that the same map is always written the same way)
+	writer.writeSize(map.sparseGrids.size());
+	for (const SparseGrid& sparseGrid : map.sparseGrids)
+	{
+		writer.writeBool(sparseGrid.isActive);
+		writer.writeSize(sparseGrid.zOrder);
+		writer.write(sparseGrid.depth);
+		writer.writeVector(sparseGrid.tileSize);
+		writer.writeVector(sparseGrid.position);
+		writer.writeVector(sparseGrid.texInset);
+		writer.writeVector(sparseGrid.tileExpand);
+		writer.writeSize(sparseGrid.invisibleId);
+		writer.writeColor(sparseGrid.color);
+		std::vector<std::pair<sf::Vector2<std::size_t>, const TileIdType*>> chunks{};
+		sparseGrid.forEachChunk([&](const sf::Vector2<std::size_t> chunkLocation, const TileIdType* const tileIds) { chunks.push_back({ chunkLocation, tileIds }); });
+		std::sort(chunks.begin(), chunks.end(), [](const auto& lhs, const auto& rhs) { return (lhs.first.y != rhs.first.y) ? (lhs.first.y < rhs.first.y) : (lhs.first.x < rhs.first.x); });
+		writer.writeSize(chunks.size());
+		for (const auto& chunk : chunks)
+		{
+			writer.writeSize(chunk.first.x);
+			writer.writeSize(chunk.first.y);
+			for (std::size_t t{ 0u }; t < SparseGrid::numberOfTilesPerChunk; ++t)
+				writer.write(chunk.second[t]);
+		}
+	}
+
+	auto align = [](const std::size_t position) { return ((position + tileIdsAlignment - 1u) / tileIdsAlignment) * tileIdsAlignment; };
+	std::vector<std::size_t> tileIdsOffsets{};
+	for (std::size_t g{ 0u }, numberOfGrids{ map.grids.size() }, offset{ align(writer.bytes.size()) }; g < numberOfGrids; ++g)
+	{
+		tileIdsOffsets.push_back(offset);
+		writer.writeAt<std::uint64_t>(tileIdsOffsetPositions[g], offset);
+		offset = align(offset + (map.grids[g].getNumberOfTiles() * sizeof(TileIdType)));
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw Exception("Unable to open map file for writing: " + filename);
+	file.write(reinterpret_cast<const char*>(writer.bytes.data()), static_cast<std::streamsize>(writer.bytes.size()));
+	std::size_t position{ writer.bytes.size() };
+	const char padding[tileIdsAlignment]{};
+	for (std::size_t g{ 0u }, numberOfGrids{ map.grids.size() }; g < numberOfGrids; ++g)
+	{
+		file.write(padding, static_cast<std::streamsize>(tileIdsOffsets[g] - position));
+		const std::size_t numberOfBytes{ map.grids[g].getNumberOfTiles() * sizeof(TileIdType) };
+		file.write(reinterpret_cast<const char*>(map.grids[g].getTileIds()), static_cast<std::streamsize>(numberOfBytes));
+		position = tileIdsOffsets[g] + numberOfBytes;
+	}
+	file.flush();
+	if (!file)
+		throw Exception("Unable to write map file: " + filename);
+}
+
+inline void MapFile::load(Map& map, const std::string& filename)
+{
+	std::size_t size{ 0u };
+	const unsigned char* const data{ priv_map(filename, size) };
+
+	std::vector<sf::FloatRect> textureAtlas{};
+	std::vector<std::size_t> textureAtlasPages{};
+	std::vector<TileTemplate> tileTemplates{};
+	std::vector<Animation> animations{};
+	std::vector<Grid> grids{};
+	std::vector<Layer> layers{};
+	std::vector<SparseGrid> sparseGrids{};
+	try
+	{
+		Reader reader{ data, size };
+		for (const char c : identifier)
+		{
+			if (reader.read<char>() != c)
+				throw Exception("Not a map file: " + filename);
+		}
+		const std::uint32_t fileVersion{ reader.read<std::uint32_t>() };
+		if ((fileVersion < 1u) || (fileVersion > version))
+			throw Exception("Unsupported map file version: " + filename);
+		const std::uint32_t tileIdSize{ reader.read<std::uint32_t>() };
+		if ((tileIdSize != 1u) && (tileIdSize != 2u) && (tileIdSize != 4u) && (tileIdSize != 8u))
+			throw Exception("Map file has an invalid tile id size: " + filename);
+		if (reader.read<std::uint32_t>() != byteOrderMark)
+			throw Exception("Map file has a different byte order: " + filename);
+		reader.read<std::uint32_t>(); // reserved
+
+		textureAtlas.resize(reader.readCount());
+		for (sf::FloatRect& textureAtlasRectangle : textureAtlas)
+		{
+			textureAtlasRectangle.position = reader.readVector();
+			textureAtlasRectangle.size = reader.readVector();
+		}
+		if (fileVersion >= 2u)
+		{
+			textureAtlasPages.resize(reader.readCount());
+			for (std::size_t& texturePage : textureAtlasPages)
+				texturePage = reader.readSize();
+		}
+
+		tileTemplates.resize(reader.readCount());
+		for (TileTemplate& tileTemplate : tileTemplates)
+		{
+			tileTemplate.isActive = reader.readBool();
+			tileTemplate.id = static_cast<TileIdType>(reader.readSize());
+			tileTemplate.size = reader.readVector();
+			tileTemplate.expand = reader.readVector();
+		}
+
+		animations.resize(reader.readCount());
+		for (Animation& animation : animations)
+		{
+			animation.id = static_cast<TileIdType>(reader.readSize());
+			animation.frames.resize(reader.readCount());
+			for (Animation::Frame& frame : animation.frames)
+			{
+				frame.id = static_cast<TileIdType>(reader.readSize());
+				frame.duration = reader.read<float>();
+			}
+		}
+
+		// grids use their tile ids directly from the file unless they were saved with a different tile id type (then they are converted into the grid's own tile ids)
+		grids.resize(reader.readCount());
+		for (Grid& grid : grids)
+		{
+			grid.isActive = reader.readBool();
+			grid.zOrder = reader.readSize();
+			grid.depth = reader.read<float>();
+			grid.tileSize = reader.readVector();
+			grid.position = reader.readVector();
+			grid.rowWidth = reader.readSize();
+			grid.texInset = reader.readVector();
+			grid.tileExpand = reader.readVector();
+			grid.invisibleId = static_cast<TileIdType>(reader.readSize());
+			grid.color = reader.readColor();
+			grid.tileTextureTransforms.resize(reader.readCount());
+			for (Grid::TileTextureTransform& tileTextureTransform : grid.tileTextureTransforms)
+			{
+				tileTextureTransform.tileIndex = reader.readSize();
+				tileTextureTransform.tileExpand = reader.readVector();
+				tileTextureTransform.textureTransform = reader.readTextureTransform();
+			}
+			const std::size_t numberOfTileIds{ reader.readSize() };
+			const std::size_t tileIdsOffset{ reader.readSize() };
+			if ((tileIdsOffset % tileIdsAlignment != 0u) || (tileIdsOffset > size) || (numberOfTileIds > (size - tileIdsOffset) / tileIdSize))
+				throw Exception("Map file has invalid grid tile ids: " + filename);
+			if (numberOfTileIds == 0u)
+				continue;
+
+			const unsigned char* const tileIds{ data + tileIdsOffset };
+			if (tileIdSize == sizeof(TileIdType))
+			{
+				grid.externalTileIds = reinterpret_cast<const TileIdType*>(tileIds);
+				grid.numberOfExternalTileIds = numberOfTileIds;
+				continue;
+			}
+			grid.tileIds.resize(numberOfTileIds);
+			Reader tileIdsReader{ tileIds, numberOfTileIds * tileIdSize };
+			for (TileIdType& tileId : grid.tileIds)
+				tileId = tileIdsReader.readTileId(tileIdSize);
+		}
+
+		layers.resize(reader.readCount());
+		for (Layer& layer : layers)
+		{
+			layer.isActive = reader.readBool();
+			layer.zOrder = reader.readSize();
+			layer.depth = reader.read<float>();
+			layer.offset = reader.readVector();
+			layer.texInset = reader.readVector();
+			layer.tileExpand = reader.readVector();
+			layer.color = reader.readColor();
+			layer.useSpatialIndex = reader.readBool();
+			layer.tiles.resize(reader.readCount());
+			for (Tile& tile : layer.tiles)
+			{
+				tile.isActive = reader.readBool();
+				tile.isTemplate = reader.readBool();
+				tile.id = static_cast<TileIdType>(reader.readSize());
+				tile.position = reader.readVector();
+				tile.size = reader.readVector();
+				tile.expand = reader.readVector();
+				tile.textureTransform = reader.readTextureTransform();
+			}
+		}
+
+		if (fileVersion >= 3u)
+		{
+			constexpr std::size_t chunkSize{ SparseGrid::chunkSize };
+			constexpr std::size_t numberOfChunksPerRow{ SparseGrid::rowWidth / chunkSize };
+			sparseGrids.resize(reader.readCount());
+			for (SparseGrid& sparseGrid : sparseGrids)
+			{
+				sparseGrid.isActive = reader.readBool();
+				sparseGrid.zOrder = reader.readSize();
+				sparseGrid.depth = reader.read<float>();
+				sparseGrid.tileSize = reader.readVector();
+				sparseGrid.position = reader.readVector();
+				sparseGrid.texInset = reader.readVector();
+				sparseGrid.tileExpand = reader.readVector();
+				sparseGrid.invisibleId = static_cast<TileIdType>(reader.readSize());
+				sparseGrid.color = reader.readColor();
+				for (std::size_t c{ 0u }, numberOfChunks{ reader.readCount() }; c < numberOfChunks; ++c)
+				{
+					const std::size_t chunkX{ reader.readSize() };
+					const std::size_t chunkY{ reader.readSize() };
+					if ((chunkX >= numberOfChunksPerRow) || (chunkY >= numberOfChunksPerRow))
+						throw Exception("Map file has an invalid sparse grid chunk: " + filename);
+					for (std::size_t y{ 0u }; y < chunkSize; ++y)
+					{
+						for (std::size_t x{ 0u }; x < chunkSize; ++x)
+							sparseGrid.setTileId((((chunkY * chunkSize) + y) * SparseGrid::rowWidth) + (chunkX * chunkSize) + x, reader.readTileId(tileIdSize));
+					}
+				}
+			}
+		}
+
+		// an asynchronous update may still be reading the map (and the previously loaded file). only that update is completed (the map's old data isn't built again)
+		map.waitForAsyncUpdate();
+	}
+	catch (...)
+	{
+		priv_unmap(data, size);
+		throw;
+	}
+
+	map.textureAtlas.swap(textureAtlas);
+	map.textureAtlasPages.swap(textureAtlasPages);
+	map.tileTemplates.swap(tileTemplates);
+	map.animations.swap(animations);
+	map.grids.swap(grids);
+	map.layers.swap(layers);
+	map.sparseGrids.swap(sparseGrids);
+	unload();
+	m_data = data;
+	m_size = size;
+	map.update();
+}
+
+inline void MapFile::unload()
+{
+	if (m_data == nullptr)
+		return;
+
+	priv_unmap(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0u;
+}
+
+inline bool MapFile::isLoaded() const
+{
+	return m_data != nullptr;
+}
+
+
+
+// PRIVATE
+
+inline const unsigned char* MapFile::priv_map(const std::string& filename, std::size_t& size)
+{
+#ifdef _WIN32
+	const HANDLE file{ ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE)
+		throw Exception("Unable to open map file: " + filename);
+	LARGE_INTEGER fileSize{};
+	if ((!::GetFileSizeEx(file, &fileSize)) || (fileSize.QuadPart <= 0) || (static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<std::size_t>(-1)))
+	{
+		::CloseHandle(file);
+		throw Exception("Unable to map map file: " + filename);
+	}
+	// the view keeps the file (and its mapping) open so neither handle is required once the view exists
+	const HANDLE mapping{ ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	::CloseHandle(file);
+	if (mapping == nullptr)
+		throw Exception("Unable to map map file: " + filename);
+	const void* const data{ ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) };
+	::CloseHandle(mapping);
+	if (data == nullptr)
+		throw Exception("Unable to map map file: " + filename);
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const int file{ ::open(filename.c_str(), O_RDONLY) };
+	if (file == -1)
+		throw Exception("Unable to open map file: " + filename);
+	struct stat fileStatus{};
+	if ((::fstat(file, &fileStatus) != 0) || (fileStatus.st_size <= 0))
+	{
+		::close(file);
+		throw Exception("Unable to map map file: " + filename);
+	}
+	// the mapping keeps the file open so it can be closed once it is mapped
+	void* const data{ ::mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, file, 0) };
+	::close(file);
+	if (data == MAP_FAILED)
+		throw Exception("Unable to map map file: " + filename);
+	size = static_cast<std::size_t>(fileStatus.st_size);
+#endif // _WIN32
+	return static_cast<const unsigned char*>(data);
+}
+
+inline void MapFile::priv_unmap(const unsigned char* const data, const std::size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	::UnmapViewOfFile(data);
+#else
+	::munmap(const_cast<unsigned char*>(data), size);
+#endif // _WIN32
+}
+
+} // namespace cheesemap
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Sparse Grid
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Color.hpp>
+
+#include <unordered_map>
+
+namespace cheesemap
+{
+
+// a grid of (up to) rowWidth x rowWidth cells that only stores the chunks (of chunkSize x chunkSize cells) that have had tiles set.
+// tile indices are the same as a grid's: (y * rowWidth) + x
+class SparseGrid
+{
+public:
+	static constexpr std::size_t rowWidth{ static_cast<std::size_t>(1u) << ((sizeof(std::size_t) * 4u) - 1u) }; // every tile index fits in a std::size_t (with room to spare)
+	static constexpr std::size_t chunkSize{ 32u };
+	static constexpr std::size_t numberOfTilesPerChunk{ chunkSize * chunkSize };
+
+	bool isActive{ true };
+	std::size_t zOrder{ 0u };
+	float depth{ 1.f };
+	sf::Vector2f tileSize{ 1.f, 1.f };
+	sf::Vector2f position{ 0.f, 0.f };
+	sf::Vector2f texInset{ 0.f, 0.f };
+	sf::Vector2f tileExpand{ 0.f, 0.f };
+	TileIdType invisibleId{ 0u }; // cells in chunks that aren't stored are also invisible
+	sf::Color color{ sf::Color::White };
+
+	TileIdType getTileId(std::size_t tileIndex) const;
+	void setTileId(std::size_t tileIndex, TileIdType tileId); // stores the tile's chunk if required (unless the tile is invisible)
+	void removeEmptyChunks(); // chunks are not removed automatically when all of their tiles become invisible
+	void clear();
+
+	std::size_t getNumberOfChunks() const;
+	const TileIdType* getChunkTileIds(sf::Vector2<std::size_t> chunkLocation) const; // the tile ids (row by row) of a chunk or nullptr if it isn't stored
+	template <class ChunkFunction> // ChunkFunction: void(sf::Vector2<std::size_t> chunkLocation, const TileIdType* tileIds)
+	void forEachChunk(ChunkFunction chunkFunction) const; // in no particular order
+
+private:
+	static constexpr std::size_t numberOfChunksPerRow{ rowWidth / chunkSize };
+
+	std::unordered_map<std::size_t, std::vector<TileIdType>> m_chunks; // keyed by chunk index: (chunk y * numberOfChunksPerRow) + chunk x
+
+	static std::size_t priv_getChunkIndex(std::size_t tileIndex);
+	static std::size_t priv_getTileIndexInChunk(std::size_t tileIndex);
+};
+
+} // namespace cheesemap
+#include "SparseGrid.inl"
@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Sparse Grid
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SparseGrid.hpp"
+
+#include <algorithm>
+
+namespace cheesemap
+{
+
+inline TileIdType SparseGrid::getTileId(const std::size_t tileIndex) const
+{
+	const auto chunk{ m_chunks.find(priv_getChunkIndex(tileIndex)) };
+	if (chunk == m_chunks.end())
+		return invisibleId;
+
+	return chunk->second[priv_getTileIndexInChunk(tileIndex)];
+}
+
+inline void SparseGrid::setTileId(const std::size_t tileIndex, const TileIdType tileId)
+{
+	if (tileIndex >= rowWidth * rowWidth)
+		return;
+
+	const std::size_t chunkIndex{ priv_getChunkIndex(tileIndex) };
+	auto chunk{ m_chunks.find(chunkIndex) };
+	if (chunk == m_chunks.end())
+	{
+		if (tileId == invisibleId)
+			return;
+		chunk = m_chunks.emplace(chunkIndex, std::vector<TileIdType>(numberOfTilesPerChunk, invisibleId)).first;
+	}
+	chunk->second[priv_getTileIndexInChunk(tileIndex)] = tileId;
+}
+
+inline void SparseGrid::removeEmptyChunks()
+{
+	for (auto chunk{ m_chunks.begin() }; chunk != m_chunks.end();)
+	{
+		if (std::all_of(chunk->second.begin(), chunk->second.end(), [&](const TileIdType tileId) { return tileId == invisibleId; }))
+			chunk = m_chunks.erase(chunk);
+		else
+			++chunk;
+	}
+}
+
+inline void SparseGrid::clear()
+{
+	m_chunks.clear();
+}
+
+inline std::size_t SparseGrid::getNumberOfChunks() const
+{
+	return m_chunks.size();
+}
+
+inline const TileIdType* SparseGrid::getChunkTileIds(const sf::Vector2<std::size_t> chunkLocation) const
+{
+	if ((chunkLocation.x >= numberOfChunksPerRow) || (chunkLocation.y >= numberOfChunksPerRow))
+		return nullptr;
+
+	const auto chunk{ m_chunks.find((chunkLocation.y * numberOfChunksPerRow) + chunkLocation.x) };
+	return (chunk != m_chunks.end()) ? chunk->second.data() : nullptr;
+}
+
+template <class ChunkFunction>
+inline void SparseGrid::forEachChunk(ChunkFunction chunkFunction) const
+{
+	for (const auto& chunk : m_chunks)
+		chunkFunction(sf::Vector2<std::size_t>{ chunk.first % numberOfChunksPerRow, chunk.first / numberOfChunksPerRow }, chunk.second.data());
+}
+
+
+
+// PRIVATE
+
+inline std::size_t SparseGrid::priv_getChunkIndex(const std::size_t tileIndex)
+{
+	return (((tileIndex / rowWidth) / chunkSize) * numberOfChunksPerRow) + ((tileIndex % rowWidth) / chunkSize);
+}
+
+inline std::size_t SparseGrid::priv_getTileIndexInChunk(const std::size_t tileIndex)
+{
+	return (((tileIndex / rowWidth) % chunkSize) * chunkSize) + ((tileIndex % rowWidth) % chunkSize);
+}
+
+} // namespace cheesemap
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Spatial Index
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+namespace cheesemap
+{
+
+// uniform bucket grid covering the bounds of all of its items.
+// queries return (in ascending order) the ids of all items in the buckets that are touched; it is up to the caller to test those items exactly.
+class SpatialIndex
+{
+public:
+	SpatialIndex();
+
+	template <class BoundsFunction> // BoundsFunction: sf::FloatRect(std::size_t id)
+	void build(std::size_t numberOfItems, BoundsFunction getBounds);
+	void clear();
+
+	void query(sf::FloatRect rectangle, std::vector<std::size_t>& ids) const; // appends ids
+	void query(sf::Vector2f point, std::vector<std::size_t>& ids) const; // appends ids
+
+private:
+	struct Entry
+	{
+		std::size_t id{};
+		sf::Vector2<std::size_t> firstCell{}; // used to report an item only once when it spans multiple cells
+	};
+
+	sf::Vector2f m_position;
+	sf::Vector2f m_cellSize;
+	sf::Vector2<std::size_t> m_numberOfCells;
+	std::vector<std::size_t> m_cellStarts; // index of the first entry of each cell (with an extra one at the end)
+	std::vector<Entry> m_entries;
+
+	sf::Vector2<std::size_t> priv_getCell(sf::Vector2f point) const;
+};
+
+} // namespace cheesemap
+#include "SpatialIndex.inl"
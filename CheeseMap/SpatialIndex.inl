@@ -0,0 +1,209 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Spatial Index
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cheesemap
+{
+
+inline SpatialIndex::SpatialIndex()
+	: m_position{ 0.f, 0.f }
+	, m_cellSize{ 1.f, 1.f }
+	, m_numberOfCells{ 0u, 0u }
+	, m_cellStarts{}
+	, m_entries{}
+{
+
+}
+
+template <class BoundsFunction>
+inline void SpatialIndex::build(const std::size_t numberOfItems, BoundsFunction getBounds)
+{
+	clear();
+	if (numberOfItems == 0u)
+		return;
+
+	auto getNormalizedBounds = [&](const std::size_t id)
+	{
+		const sf::FloatRect bounds{ getBounds(id) };
+		const sf::Vector2f topLeft{ std::min(bounds.position.x, bounds.position.x + bounds.size.x), std::min(bounds.position.y, bounds.position.y + bounds.size.y) };
+		return sf::FloatRect{ topLeft, { std::abs(bounds.size.x), std::abs(bounds.size.y) } };
+	};
+
+	// bounds of all items together and their average size
+	sf::Vector2f min{ getNormalizedBounds(0u).position };
+	sf::Vector2f max{ min };
+	sf::Vector2f totalSize{ 0.f, 0.f };
+	for (std::size_t i{ 0u }; i < numberOfItems; ++i)
+	{
+		const sf::FloatRect bounds{ getNormalizedBounds(i) };
+		min.x = std::min(min.x, bounds.position.x);
+		min.y = std::min(min.y, bounds.position.y);
+		max.x = std::max(max.x, bounds.position.x + bounds.size.x);
+		max.y = std::max(max.y, bounds.position.y + bounds.size.y);
+		totalSize += bounds.size;
+	}
+	const sf::Vector2f extent{ max - min };
+	const sf::Vector2f averageSize{ totalSize / static_cast<float>(numberOfItems) };
+
+	// aim for around one item per cell but don't let cells become (much) smaller than the items so that each item only touches a few cells
+	constexpr float maximumNumberOfCellsPerAxis{ 4096.f };
+	auto calculateNumberOfCells = [&](const float length, const float otherLength, const float itemLength)
+	{
+		if (!(length > 0.f))
+			return 1.f;
+		float numberOfCells{ static_cast<float>(numberOfItems) };
+		if (otherLength > 0.f)
+			numberOfCells = std::sqrt(numberOfCells * length / otherLength);
+		if (itemLength > 0.f)
+			numberOfCells = std::min(numberOfCells, length / itemLength);
+		return std::min(std::max(std::floor(numberOfCells), 1.f), maximumNumberOfCellsPerAxis);
+	};
+	const sf::Vector2f numberOfCells{ calculateNumberOfCells(extent.x, extent.y, averageSize.x), calculateNumberOfCells(extent.y, extent.x, averageSize.y) };
+
+	m_position = min;
+	m_cellSize = { (extent.x > 0.f) ? (extent.x / numberOfCells.x) : 1.f, (extent.y > 0.f) ? (extent.y / numberOfCells.y) : 1.f };
+	m_numberOfCells = { static_cast<std::size_t>(numberOfCells.x), static_cast<std::size_t>(numberOfCells.y) };
+
+	// count the items in each cell, convert the counts into starting indices and then fill the cells
+	m_cellStarts.assign((m_numberOfCells.x * m_numberOfCells.y) + 1u, 0u);
+	for (std::size_t i{ 0u }; i < numberOfItems; ++i)
+	{
+		const sf::FloatRect bounds{ getNormalizedBounds(i) };
+		const sf::Vector2<std::size_t> firstCell{ priv_getCell(bounds.position) };
+		const sf::Vector2<std::size_t> lastCell{ priv_getCell(bounds.position + bounds.size) };
+		for (std::size_t y{ firstCell.y }; y <= lastCell.y; ++y)
+		{
+			for (std::size_t x{ firstCell.x }; x <= lastCell.x; ++x)
+				++m_cellStarts[(y * m_numberOfCells.x) + x + 1u];
+		}
+	}
+	for (std::size_t c{ 1u }, numberOfCellStarts{ m_cellStarts.size() }; c < numberOfCellStarts; ++c)
+		m_cellStarts[c] += m_cellStarts[c - 1u];
+	m_entries.resize(m_cellStarts.back());
+	std::vector<std::size_t> cellFills(m_cellStarts.begin(), m_cellStarts.end() - 1);
+	for (std::size_t i{ 0u }; i < numberOfItems; ++i)
+	{
+		const sf::FloatRect bounds{ getNormalizedBounds(i) };
+		const sf::Vector2<std::size_t> firstCell{ priv_getCell(bounds.position) };
+		const sf::Vector2<std::size_t> lastCell{ priv_getCell(bounds.position + bounds.size) };
+		for (std::size_t y{ firstCell.y }; y <= lastCell.y; ++y)
+		{
+			for (std::size_t x{ firstCell.x }; x <= lastCell.x; ++x)
+				m_entries[cellFills[(y * m_numberOfCells.x) + x]++] = { i, firstCell };
+		}
+	}
+}
+
+inline void SpatialIndex::clear()
+{
+	m_numberOfCells = { 0u, 0u };
+	m_cellStarts.clear();
+	m_entries.clear();
+}
+
+inline void SpatialIndex::query(sf::FloatRect rectangle, std::vector<std::size_t>& ids) const
+{
+	if (m_entries.empty())
+		return;
+
+	if (rectangle.size.x < 0.f)
+	{
+		rectangle.position.x += rectangle.size.x;
+		rectangle.size.x = -rectangle.size.x;
+	}
+	if (rectangle.size.y < 0.f)
+	{
+		rectangle.position.y += rectangle.size.y;
+		rectangle.size.y = -rectangle.size.y;
+	}
+
+	const sf::Vector2f max{ m_position.x + (m_cellSize.x * m_numberOfCells.x), m_position.y + (m_cellSize.y * m_numberOfCells.y) };
+	if ((rectangle.position.x > max.x) || (rectangle.position.y > max.y) || (rectangle.position.x + rectangle.size.x < m_position.x) || (rectangle.position.y + rectangle.size.y < m_position.y))
+		return;
+
+	const std::size_t firstId{ ids.size() };
+	const sf::Vector2<std::size_t> firstCell{ priv_getCell(rectangle.position) };
+	const sf::Vector2<std::size_t> lastCell{ priv_getCell(rectangle.position + rectangle.size) };
+	for (std::size_t y{ firstCell.y }; y <= lastCell.y; ++y)
+	{
+		for (std::size_t x{ firstCell.x }; x <= lastCell.x; ++x)
+		{
+			const std::size_t cell{ (y * m_numberOfCells.x) + x };
+			for (std::size_t e{ m_cellStarts[cell] }, end{ m_cellStarts[cell + 1u] }; e < end; ++e)
+			{
+				// an item that spans multiple cells is only reported from the first of its cells that is inside the query
+				const Entry& entry{ m_entries[e] };
+				if ((std::max(entry.firstCell.x, firstCell.x) == x) && (std::max(entry.firstCell.y, firstCell.y) == y))
+					ids.push_back(entry.id);
+			}
+		}
+	}
+	std::sort(ids.begin() + firstId, ids.end());
+}
+
+inline void SpatialIndex::query(const sf::Vector2f point, std::vector<std::size_t>& ids) const
+{
+	if (m_entries.empty())
+		return;
+
+	const sf::Vector2f max{ m_position.x + (m_cellSize.x * m_numberOfCells.x), m_position.y + (m_cellSize.y * m_numberOfCells.y) };
+	if ((point.x < m_position.x) || (point.y < m_position.y) || (point.x > max.x) || (point.y > max.y))
+		return;
+
+	// items are stored in each cell in ascending order so no sorting is required
+	const sf::Vector2<std::size_t> cellLocation{ priv_getCell(point) };
+	const std::size_t cell{ (cellLocation.y * m_numberOfCells.x) + cellLocation.x };
+	for (std::size_t e{ m_cellStarts[cell] }, end{ m_cellStarts[cell + 1u] }; e < end; ++e)
+		ids.push_back(m_entries[e].id);
+}
+
+
+
+// PRIVATE
+
+inline sf::Vector2<std::size_t> SpatialIndex::priv_getCell(const sf::Vector2f point) const
+{
+	const sf::Vector2f cell{ (point.x - m_position.x) / m_cellSize.x, (point.y - m_position.y) / m_cellSize.y };
+	return
+	{
+		(cell.x > 0.f) ? std::min(static_cast<std::size_t>(std::min(cell.x, static_cast<float>(m_numberOfCells.x))), m_numberOfCells.x - 1u) : 0u,
+		(cell.y > 0.f) ? std::min(static_cast<std::size_t>(std::min(cell.y, static_cast<float>(m_numberOfCells.y))), m_numberOfCells.y - 1u) : 0u
+	};
+}
+
+} // namespace cheesemap
@@ -32,6 +32,8 @@
 
 #pragma once
 
+#include <SFML/System/Vector2.hpp>
+
 namespace cheesemap
 {
 
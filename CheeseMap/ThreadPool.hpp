@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Thread Pool
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+namespace cheesemap
+{
+
+// a fixed set of worker threads that run a number of tasks together with the calling thread.
+// run() returns once all of its tasks have finished; runs from different threads take turns.
+// if a task throws, no more of the run's tasks are started and run() rethrows the first exception once the tasks that already started have finished.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(std::size_t numberOfThreads); // includes the calling thread
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	std::size_t getNumberOfThreads() const;
+
+	template <class TaskFunction> // TaskFunction: void(std::size_t taskIndex)
+	void run(std::size_t numberOfTasks, TaskFunction task);
+
+private:
+	std::vector<std::thread> m_threads;
+	std::mutex m_runMutex;
+	std::mutex m_mutex;
+	std::condition_variable m_startCondition;
+	std::condition_variable m_finishCondition;
+	std::function<void(std::size_t)> m_task;
+	std::size_t m_numberOfTasks;
+	std::atomic<std::size_t> m_nextTask;
+	std::size_t m_numberOfBusyThreads;
+	std::size_t m_runNumber;
+	bool m_isStopping;
+	std::exception_ptr m_exception; // the first exception thrown by a task of the current run
+
+	void priv_work();
+	void priv_runTasks();
+};
+
+} // namespace cheesemap
+#include "ThreadPool.inl"
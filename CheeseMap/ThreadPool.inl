@@ -0,0 +1,155 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Thread Pool
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ThreadPool.hpp"
+
+namespace cheesemap
+{
+
+inline ThreadPool::ThreadPool(const std::size_t numberOfThreads)
+	: m_threads{}
+	, m_runMutex{}
+	, m_mutex{}
+	, m_startCondition{}
+	, m_finishCondition{}
+	, m_task{}
+	, m_numberOfTasks{ 0u }
+	, m_nextTask{ 0u }
+	, m_numberOfBusyThreads{ 0u }
+	, m_runNumber{ 0u }
+	, m_isStopping{ false }
+	, m_exception{}
+{
+	for (std::size_t i{ 1u }; i < numberOfThreads; ++i)
+		m_threads.emplace_back(&ThreadPool::priv_work, this);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_isStopping = true;
+	}
+	m_startCondition.notify_all();
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+inline std::size_t ThreadPool::getNumberOfThreads() const
+{
+	return m_threads.size() + 1u;
+}
+
+template <class TaskFunction>
+inline void ThreadPool::run(const std::size_t numberOfTasks, TaskFunction task)
+{
+	if ((numberOfTasks < 2u) || m_threads.empty())
+	{
+		for (std::size_t t{ 0u }; t < numberOfTasks; ++t)
+			task(t);
+		return;
+	}
+
+	std::lock_guard<std::mutex> runLock{ m_runMutex };
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_task = [&task](const std::size_t t) { task(t); };
+		m_numberOfTasks = numberOfTasks;
+		m_nextTask = 0u;
+		m_numberOfBusyThreads = m_threads.size();
+		++m_runNumber;
+	}
+	m_startCondition.notify_all();
+
+	priv_runTasks();
+
+	// the workers use task (through m_task) so this always waits for them, even if a task has thrown
+	std::exception_ptr exception{};
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_finishCondition.wait(lock, [&]() { return m_numberOfBusyThreads == 0u; });
+		m_task = nullptr;
+		std::swap(exception, m_exception);
+	}
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+
+
+// PRIVATE
+
+inline void ThreadPool::priv_work()
+{
+	std::size_t runNumber{ 0u };
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_startCondition.wait(lock, [&]() { return m_isStopping || (m_runNumber != runNumber); });
+			if (m_isStopping)
+				return;
+			runNumber = m_runNumber;
+		}
+
+		priv_runTasks();
+
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			--m_numberOfBusyThreads;
+		}
+		m_finishCondition.notify_one();
+	}
+}
+
+inline void ThreadPool::priv_runTasks()
+{
+	// tasks are taken in order by whichever thread is free. a task that throws stops any more tasks being taken (only its exception is kept if several throw)
+	for (std::size_t t{ m_nextTask++ }; t < m_numberOfTasks; t = m_nextTask++)
+	{
+		try
+		{
+			m_task(t);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			if (!m_exception)
+				m_exception = std::current_exception();
+			m_nextTask = m_numberOfTasks;
+		}
+	}
+}
+
+} // namespace cheesemap
@@ -0,0 +1,134 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Tiled Importer
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Common.hpp"
+#include "Map.hpp"
+
+#include <string>
+
+namespace cheesemap
+{
+
+// imports orthogonal Tiled maps (TMX or JSON, with TSX or JSON tilesets) without building a document: the file is scanned once and each tile layer's data (CSV, base64, zlib, gzip or, if CHEESEMAP_USE_ZSTD is defined, zstd) is decoded straight into its grid's tile ids.
+// texture atlas ids are Tiled's global tile ids (id 0 is Tiled's empty cell and is each grid's invisible id); each texture atlas rectangle is within its own tileset's image and each tileset is a texture page (in the order of getTilesets) so each tileset's texture can be set with Map::setTexture(texture, texturePage).
+// Tiled's flip flags become texture transforms. infinite maps' chunks are decoded into a grid that covers all of the layer's chunks
+class TiledImporter
+{
+public:
+	struct Tileset
+	{
+		std::size_t firstId{ 0u }; // the id (Tiled's first global tile id) of the tileset's first tile
+		std::size_t numberOfTiles{ 0u };
+		sf::Vector2f tileSize{ 0.f, 0.f };
+		std::string imageSource{}; // includes the directory of the file that refers to it
+		sf::Vector2f imageSize{ 0.f, 0.f };
+	};
+
+	TiledImporter();
+
+	void setNumberOfThreads(std::size_t numberOfThreads); // tile layers (and chunks) are decoded on this many threads (0 uses the number of hardware threads). default is 1
+	void setMaxNumberOfCells(std::size_t maxNumberOfCells); // importing a tile layer whose grid would have more cells than this throws Exception (compressed data is never inflated beyond its layer's size). default is 8192 x 8192
+
+	// replaces the map's texture atlas (and its texture pages), grids (one for each tile layer) and layers (one for each object layer, containing its tile objects) and updates the map.
+	// completes any asynchronous update first. throws Exception (leaving the map unchanged) if a file can't be read or uses something that isn't supported (non-orthogonal maps, image collection tilesets and, unless CHEESEMAP_USE_ZSTD is defined, zstd compression)
+	void import(Map& map, const std::string& filename);
+	const std::vector<Tileset>& getTilesets() const; // of the most recent import
+
+private:
+	class XmlReader;
+	class JsonReader;
+	class Inflater;
+	enum class Encoding
+	{
+		Xml,
+		Csv,
+		Base64,
+	};
+	enum class Compression
+	{
+		None,
+		Zlib,
+		Gzip,
+		Zstd,
+	};
+	struct DecodeTask
+	{
+		std::size_t gridIndex{ 0u };
+		sf::Vector2i location{ 0, 0 }; // of the first cell (in the layer's cells; infinite maps' chunks can be negative)
+		sf::Vector2<std::size_t> size{ 0u, 0u }; // in cells
+		Encoding encoding{ Encoding::Xml };
+		Compression compression{ Compression::None };
+		const char* text{ nullptr };
+		std::size_t textLength{ 0u };
+		std::vector<std::uint32_t> gids{}; // XML data
+	};
+	struct ImportedMap // everything that is read before it replaces the map's
+	{
+		std::vector<Tileset> tilesets{};
+		std::vector<sf::FloatRect> textureAtlas{ sf::FloatRect{} }; // id 0 is Tiled's empty cell
+		std::vector<std::size_t> textureAtlasPages{ 0u };
+		std::vector<Grid> grids{};
+		std::vector<Layer> layers{};
+		std::vector<DecodeTask> decodeTasks{};
+		std::size_t zOrder{ 0u };
+		std::size_t maxNumberOfCells{ 0u };
+	};
+
+	std::size_t m_numberOfThreads;
+	std::size_t m_maxNumberOfCells;
+	std::vector<Tileset> m_tilesets;
+
+	static std::string priv_readFile(const std::string& filename);
+	static std::string priv_getDirectory(const std::string& filename);
+	static bool priv_isJson(const std::string& file);
+	static void priv_readXmlMap(const std::string& file, const std::string& filename, ImportedMap& importedMap);
+	static void priv_readJsonMap(const std::string& file, const std::string& filename, ImportedMap& importedMap);
+	static void priv_readJsonLayers(const char* text, std::size_t textLength, sf::Vector2f groupOffset, sf::Vector2f tileSize, bool isInfinite, const std::string& filename, ImportedMap& importedMap);
+	static void priv_readTilesetFile(const std::string& filename, std::size_t firstId, ImportedMap& importedMap);
+	static void priv_readTileset(XmlReader& reader, std::size_t firstId, const std::string& directory, ImportedMap& importedMap);
+	static void priv_readJsonTileset(JsonReader& reader, std::size_t firstId, const std::string& directory, ImportedMap& importedMap);
+	static void priv_addTileset(Tileset tileset, std::size_t numberOfColumns, float spacing, float margin, const std::string& name, ImportedMap& importedMap);
+	static const Tileset* priv_getTileset(const std::vector<Tileset>& tilesets, std::size_t id);
+	static void priv_setGridBounds(Grid& grid, ImportedMap& importedMap, std::size_t firstDecodeTask, sf::Vector2f tileSize);
+	static Encoding priv_getEncoding(const std::string& encodingName);
+	static Compression priv_getCompression(const std::string& compressionName, const std::string& filename);
+	static sf::Color priv_getColor(const std::string& tintColor, float opacity);
+	static void priv_decode(const DecodeTask& task, Grid& grid, std::vector<Grid::TileTextureTransform>& tileTextureTransforms);
+	static void priv_decodeBase64(const char* text, std::size_t textLength, std::vector<unsigned char>& bytes);
+	static TileIdType priv_getTileId(std::uint32_t gid);
+	static TextureTransform priv_getTextureTransform(std::uint32_t gid);
+};
+
+} // namespace cheesemap
+#include "TiledImporter.inl"
@@ -0,0 +1,1593 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Tiled Importer
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TiledImporter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#ifdef CHEESEMAP_USE_ZSTD
+#include <zstd.h>
+#endif // CHEESEMAP_USE_ZSTD
+
+namespace cheesemap
+{
+
+// a minimal XML scanner: moves from tag to tag (skipping comments, declarations and text) and reads the current tag's attributes
+class TiledImporter::XmlReader
+{
+public:
+	std::string name{};
+	bool isEndTag{ false };
+	bool isEmptyElement{ false };
+
+	XmlReader(const char* const data, const std::size_t size) : m_position{ data }, m_end{ data + size }, m_attributes{} { }
+
+	bool next()
+	{
+		while (true)
+		{
+			m_position = std::find(m_position, m_end, '<');
+			if (m_position == m_end)
+				return false;
+			if (priv_skipPast("<!--", "-->") || priv_skipPast("<?", "?>") || priv_skipPast("<!", ">"))
+				continue;
+			break;
+		}
+
+		++m_position;
+		isEndTag = (m_position != m_end) && (*m_position == '/');
+		if (isEndTag)
+			++m_position;
+		name = priv_readName();
+		m_attributes.clear();
+		while (true)
+		{
+			priv_skipSpace();
+			if (m_position == m_end)
+				throw Exception("Tiled file has an unfinished tag.");
+			if (*m_position == '>')
+			{
+				isEmptyElement = false;
+				++m_position;
+				return true;
+			}
+			if ((*m_position == '/') && (m_position + 1 != m_end) && (m_position[1] == '>'))
+			{
+				isEmptyElement = true;
+				m_position += 2;
+				return true;
+			}
+			std::string attributeName{ priv_readName() };
+			priv_skipSpace();
+			if ((attributeName.empty()) || (m_position == m_end) || (*m_position != '='))
+				throw Exception("Tiled file has an invalid attribute.");
+			++m_position;
+			priv_skipSpace();
+			if ((m_position == m_end) || ((*m_position != '"') && (*m_position != '\'')))
+				throw Exception("Tiled file has an invalid attribute.");
+			const char* const valueEnd{ std::find(m_position + 1, m_end, *m_position) };
+			if (valueEnd == m_end)
+				throw Exception("Tiled file has an unfinished attribute.");
+			m_attributes.push_back({ std::move(attributeName), priv_unescape(m_position + 1, valueEnd) });
+			m_position = valueEnd + 1;
+		}
+	}
+	bool isStartOf(const char* const elementName) const { return !isEndTag && (name == elementName); }
+	bool isEndOf(const char* const elementName) const { return isEndTag && (name == elementName); }
+	const std::string* getAttribute(const char* const attributeName) const
+	{
+		for (const auto& attribute : m_attributes)
+		{
+			if (attribute.first == attributeName)
+				return &attribute.second;
+		}
+		return nullptr;
+	}
+	std::string getString(const char* const attributeName) const
+	{
+		const std::string* const value{ getAttribute(attributeName) };
+		return (value != nullptr) ? *value : std::string{};
+	}
+	float getFloat(const char* const attributeName, const float defaultValue) const
+	{
+		const std::string* const value{ getAttribute(attributeName) };
+		return (value != nullptr) ? std::strtof(value->c_str(), nullptr) : defaultValue;
+	}
+	long long getInteger(const char* const attributeName, const long long defaultValue) const
+	{
+		const std::string* const value{ getAttribute(attributeName) };
+		return (value != nullptr) ? std::strtoll(value->c_str(), nullptr, 10) : defaultValue;
+	}
+	std::size_t getSize(const char* const attributeName, const std::size_t defaultValue) const
+	{
+		const long long value{ getInteger(attributeName, static_cast<long long>(defaultValue)) };
+		return (value > 0) ? static_cast<std::size_t>(value) : 0u;
+	}
+	void getText(const char*& text, std::size_t& textLength) const
+	{
+		// the text that follows the current tag (up to the next tag)
+		const char* const textEnd{ std::find(m_position, m_end, '<') };
+		text = m_position;
+		textLength = static_cast<std::size_t>(textEnd - m_position);
+	}
+	void skipElement()
+	{
+		// moves to the end tag of the current element
+		if (isEndTag || isEmptyElement)
+			return;
+		for (std::size_t depth{ 1u }; depth > 0u;)
+		{
+			if (!next())
+				throw Exception("Tiled file has an unfinished element.");
+			if (isEndTag)
+				--depth;
+			else if (!isEmptyElement)
+				++depth;
+		}
+	}
+
+private:
+	const char* m_position;
+	const char* m_end;
+	std::vector<std::pair<std::string, std::string>> m_attributes;
+
+	bool priv_skipPast(const char* const begin, const char* const end)
+	{
+		const std::size_t beginLength{ std::strlen(begin) };
+		if ((static_cast<std::size_t>(m_end - m_position) < beginLength) || (std::strncmp(m_position, begin, beginLength) != 0))
+			return false;
+		const char* const found{ std::search(m_position + beginLength, m_end, end, end + std::strlen(end)) };
+		m_position = (found == m_end) ? m_end : found + std::strlen(end);
+		return true;
+	}
+	void priv_skipSpace()
+	{
+		while ((m_position != m_end) && ((*m_position == ' ') || (*m_position == '\t') || (*m_position == '\r') || (*m_position == '\n')))
+			++m_position;
+	}
+	std::string priv_readName()
+	{
+		const char* const nameBegin{ m_position };
+		while ((m_position != m_end) && (*m_position != '=') && (*m_position != '>') && (*m_position != '/') && (*m_position != ' ') && (*m_position != '\t') && (*m_position != '\r') && (*m_position != '\n'))
+			++m_position;
+		return{ nameBegin, m_position };
+	}
+	static std::string priv_unescape(const char* begin, const char* const end)
+	{
+		std::string value{};
+		value.reserve(static_cast<std::size_t>(end - begin));
+		while (begin != end)
+		{
+			if (*begin != '&')
+			{
+				value += *begin++;
+				continue;
+			}
+			static const std::pair<const char*, char> entities[]{ { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' } };
+			bool isEntity{ false };
+			for (const auto& entity : entities)
+			{
+				const std::size_t entityLength{ std::strlen(entity.first) };
+				if ((static_cast<std::size_t>(end - begin) >= entityLength) && (std::strncmp(begin, entity.first, entityLength) == 0))
+				{
+					value += entity.second;
+					begin += entityLength;
+					isEntity = true;
+					break;
+				}
+			}
+			if (!isEntity)
+				value += *begin++;
+		}
+		return value;
+	}
+};
+
+// a minimal JSON scanner: reads values in order (objects and arrays through callbacks) without storing them. values that are needed later can be located (as text) and read with their own reader
+class TiledImporter::JsonReader
+{
+public:
+	JsonReader(const char* const data, const std::size_t size) : m_position{ data }, m_end{ data + size }
+	{
+		if ((size >= 3u) && (std::strncmp(data, "\xEF\xBB\xBF", 3u) == 0))
+			m_position += 3u;
+	}
+
+	template <class MemberFunction>
+	void readObject(MemberFunction memberFunction)
+	{
+		// calls memberFunction(const std::string& key) for each member, which must read (or skip) the member's value
+		priv_expect('{');
+		if (priv_accept('}'))
+			return;
+		do
+		{
+			const std::string key{ readString() };
+			priv_expect(':');
+			memberFunction(key);
+		} while (priv_accept(','));
+		priv_expect('}');
+	}
+	template <class ElementFunction>
+	void readArray(ElementFunction elementFunction)
+	{
+		// calls elementFunction() for each element, which must read (or skip) the element
+		priv_expect('[');
+		if (priv_accept(']'))
+			return;
+		do
+			elementFunction();
+		while (priv_accept(','));
+		priv_expect(']');
+	}
+	char peek()
+	{
+		// the first character of the next value
+		priv_skipSpace();
+		if (m_position == m_end)
+			throw Exception("Tiled file has unfinished JSON.");
+		return *m_position;
+	}
+	std::string readString()
+	{
+		priv_expect('"');
+		std::string value{};
+		while (true)
+		{
+			if (m_position == m_end)
+				throw Exception("Tiled file has an unfinished JSON string.");
+			const char c{ *m_position++ };
+			if (c == '"')
+				return value;
+			if (c != '\\')
+			{
+				value += c;
+				continue;
+			}
+			if (m_position == m_end)
+				throw Exception("Tiled file has an unfinished JSON string.");
+			switch (const char escaped{ *m_position++ })
+			{
+			case 'b':
+				value += '\b';
+				break;
+			case 'f':
+				value += '\f';
+				break;
+			case 'n':
+				value += '\n';
+				break;
+			case 'r':
+				value += '\r';
+				break;
+			case 't':
+				value += '\t';
+				break;
+			case 'u':
+				priv_appendCodePoint(value);
+				break;
+			default: // '"', '\\' and '/'
+				value += escaped;
+				break;
+			}
+		}
+	}
+	double readNumber()
+	{
+		peek();
+		char* numberEnd{ nullptr };
+		const double value{ std::strtod(m_position, &numberEnd) };
+		if ((numberEnd == m_position) || (numberEnd > m_end))
+			throw Exception("Tiled file has an invalid JSON number.");
+		m_position = numberEnd;
+		return value;
+	}
+	float readFloat() { return static_cast<float>(readNumber()); }
+	long long readInteger() { return static_cast<long long>(readNumber()); }
+	std::size_t readSize()
+	{
+		const long long value{ readInteger() };
+		return (value > 0) ? static_cast<std::size_t>(value) : 0u;
+	}
+	bool readBool()
+	{
+		peek();
+		if (priv_acceptLiteral("true"))
+			return true;
+		if (priv_acceptLiteral("false"))
+			return false;
+		throw Exception("Tiled file has an invalid JSON value.");
+	}
+	void getValueText(const char*& text, std::size_t& textLength)
+	{
+		// the text of the next value (a string's without its quotes), which is then skipped
+		const bool isString{ peek() == '"' };
+		const char* const valueBegin{ m_position };
+		skipValue();
+		text = isString ? valueBegin + 1 : valueBegin;
+		textLength = static_cast<std::size_t>((isString ? m_position - 1 : m_position) - text);
+	}
+	void skipValue()
+	{
+		const char first{ peek() };
+		const char* const valueBegin{ m_position };
+		if (first == '"')
+			priv_skipString();
+		else if ((first == '{') || (first == '['))
+		{
+			// only brackets have to be matched (strings are skipped so that their brackets aren't counted)
+			for (std::size_t depth{ 0u }; (depth > 0u) || (m_position == valueBegin);)
+			{
+				if (m_position == m_end)
+					throw Exception("Tiled file has unfinished JSON.");
+				const char c{ *m_position };
+				if (c == '"')
+				{
+					priv_skipString();
+					continue;
+				}
+				++m_position;
+				if ((c == '{') || (c == '['))
+					++depth;
+				else if ((c == '}') || (c == ']'))
+					--depth;
+			}
+		}
+		else
+		{
+			// numbers and literals end at the next separator
+			while ((m_position != m_end) && (*m_position != ',') && (*m_position != '}') && (*m_position != ']') && (*m_position != ' ') && (*m_position != '\t') && (*m_position != '\r') && (*m_position != '\n'))
+				++m_position;
+			if (m_position == valueBegin)
+				throw Exception("Tiled file has an invalid JSON value.");
+		}
+	}
+
+private:
+	const char* m_position;
+	const char* m_end;
+
+	void priv_skipSpace()
+	{
+		while ((m_position != m_end) && ((*m_position == ' ') || (*m_position == '\t') || (*m_position == '\r') || (*m_position == '\n')))
+			++m_position;
+	}
+	bool priv_accept(const char c)
+	{
+		priv_skipSpace();
+		if ((m_position == m_end) || (*m_position != c))
+			return false;
+		++m_position;
+		return true;
+	}
+	void priv_expect(const char c)
+	{
+		if (!priv_accept(c))
+			throw Exception("Tiled file has invalid JSON.");
+	}
+	bool priv_acceptLiteral(const char* const literal)
+	{
+		const std::size_t literalLength{ std::strlen(literal) };
+		if ((static_cast<std::size_t>(m_end - m_position) < literalLength) || (std::strncmp(m_position, literal, literalLength) != 0))
+			return false;
+		m_position += literalLength;
+		return true;
+	}
+	void priv_skipString()
+	{
+		++m_position;
+		while (true)
+		{
+			if (m_position == m_end)
+				throw Exception("Tiled file has an unfinished JSON string.");
+			const char c{ *m_position++ };
+			if (c == '"')
+				return;
+			if ((c == '\\') && (m_position != m_end))
+				++m_position;
+		}
+	}
+	std::uint32_t priv_readHexCodeUnit()
+	{
+		if (m_end - m_position < 4)
+			throw Exception("Tiled file has an invalid JSON string.");
+		const char hex[5u]{ m_position[0], m_position[1], m_position[2], m_position[3], '\0' };
+		char* hexEnd{ nullptr };
+		const unsigned long codeUnit{ std::strtoul(hex, &hexEnd, 16) };
+		if (hexEnd != hex + 4)
+			throw Exception("Tiled file has an invalid JSON string.");
+		m_position += 4;
+		return static_cast<std::uint32_t>(codeUnit);
+	}
+	void priv_appendCodePoint(std::string& value)
+	{
+		// appends an escaped code point (the UTF-16 code units after "\u", combining a surrogate pair) as UTF-8
+		std::uint32_t codePoint{ priv_readHexCodeUnit() };
+		if ((codePoint >= 0xD800u) && (codePoint < 0xDC00u) && (m_end - m_position >= 6) && (m_position[0] == '\\') && (m_position[1] == 'u'))
+		{
+			m_position += 2;
+			const std::uint32_t lowSurrogate{ priv_readHexCodeUnit() };
+			if ((lowSurrogate >= 0xDC00u) && (lowSurrogate < 0xE000u))
+				codePoint = 0x10000u + ((codePoint - 0xD800u) << 10u) + (lowSurrogate - 0xDC00u);
+		}
+		if (codePoint < 0x80u)
+			value += static_cast<char>(codePoint);
+		else if (codePoint < 0x800u)
+		{
+			value += static_cast<char>(0xC0u | (codePoint >> 6u));
+			value += static_cast<char>(0x80u | (codePoint & 0x3Fu));
+		}
+		else if (codePoint < 0x10000u)
+		{
+			value += static_cast<char>(0xE0u | (codePoint >> 12u));
+			value += static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+			value += static_cast<char>(0x80u | (codePoint & 0x3Fu));
+		}
+		else
+		{
+			value += static_cast<char>(0xF0u | (codePoint >> 18u));
+			value += static_cast<char>(0x80u | ((codePoint >> 12u) & 0x3Fu));
+			value += static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+			value += static_cast<char>(0x80u | (codePoint & 0x3Fu));
+		}
+	}
+};
+
+// a raw deflate (RFC 1951) decoder. it throws as soon as its output would be larger than the maximum (so small crafted data can't inflate without limit)
+class TiledImporter::Inflater
+{
+public:
+	Inflater(const unsigned char* const data, const std::size_t size, const std::size_t maxOutputSize, std::vector<unsigned char>& output) : m_data{ data }, m_size{ size }, m_position{ 0u }, m_bitBuffer{ 0u }, m_numberOfBits{ 0u }, m_maxOutputSize{ maxOutputSize }, m_output(output) { }
+
+	std::size_t inflate()
+	{
+		// returns the size of the deflate data (any data after it, such as a checksum, starts there)
+		bool isLastBlock{ false };
+		while (!isLastBlock)
+		{
+			isLastBlock = (priv_readBits(1u) != 0u);
+			switch (priv_readBits(2u))
+			{
+			case 0u:
+				priv_inflateStoredBlock();
+				break;
+			case 1u:
+				priv_inflateFixedBlock();
+				break;
+			case 2u:
+				priv_inflateDynamicBlock();
+				break;
+			default:
+				throw Exception("Tiled file has invalid compressed data.");
+			}
+		}
+		return m_position;
+	}
+
+	static std::uint32_t getAdler32(const unsigned char* const data, const std::size_t size)
+	{
+		std::uint32_t a{ 1u };
+		std::uint32_t b{ 0u };
+		for (std::size_t i{ 0u }; i < size; ++i)
+		{
+			a = (a + data[i]) % 65521u;
+			b = (b + a) % 65521u;
+		}
+		return (b << 16u) | a;
+	}
+	static std::uint32_t getCrc32(const unsigned char* const data, const std::size_t size)
+	{
+		static const std::array<std::uint32_t, 256u> table{ []()
+		{
+			std::array<std::uint32_t, 256u> crcs{};
+			for (std::uint32_t i{ 0u }; i < 256u; ++i)
+			{
+				std::uint32_t crc{ i };
+				for (std::size_t bit{ 0u }; bit < 8u; ++bit)
+					crc = ((crc & 1u) != 0u) ? (0xEDB88320u ^ (crc >> 1u)) : (crc >> 1u);
+				crcs[i] = crc;
+			}
+			return crcs;
+		}() };
+		std::uint32_t crc{ 0xFFFFFFFFu };
+		for (std::size_t i{ 0u }; i < size; ++i)
+			crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8u);
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+private:
+	static constexpr std::size_t maxCodeLength{ 15u };
+	struct Huffman
+	{
+		std::uint16_t counts[maxCodeLength + 1u]; // number of codes of each length
+		std::uint16_t symbols[288u]; // ordered by code
+	};
+
+	const unsigned char* m_data;
+	std::size_t m_size;
+	std::size_t m_position;
+	std::uint32_t m_bitBuffer;
+	std::size_t m_numberOfBits;
+	std::size_t m_maxOutputSize;
+	std::vector<unsigned char>& m_output;
+
+	void priv_reserveOutput(const std::size_t size) const
+	{
+		if (size > m_maxOutputSize - m_output.size())
+			throw Exception("Tiled layer has too much data.");
+	}
+
+	std::uint32_t priv_readBits(const std::size_t numberOfBits)
+	{
+		while (m_numberOfBits < numberOfBits)
+		{
+			if (m_position == m_size)
+				throw Exception("Tiled file has truncated compressed data.");
+			m_bitBuffer |= static_cast<std::uint32_t>(m_data[m_position++]) << m_numberOfBits;
+			m_numberOfBits += 8u;
+		}
+		const std::uint32_t value{ m_bitBuffer & ((static_cast<std::uint32_t>(1u) << numberOfBits) - 1u) };
+		m_bitBuffer >>= numberOfBits;
+		m_numberOfBits -= numberOfBits;
+		return value;
+	}
+	void priv_inflateStoredBlock()
+	{
+		m_bitBuffer = 0u;
+		m_numberOfBits = 0u;
+		if (m_size - m_position < 4u)
+			throw Exception("Tiled file has truncated compressed data.");
+		const std::size_t length{ static_cast<std::size_t>(m_data[m_position] | (m_data[m_position + 1u] << 8u)) };
+		const std::size_t lengthComplement{ static_cast<std::size_t>(m_data[m_position + 2u] | (m_data[m_position + 3u] << 8u)) };
+		m_position += 4u;
+		if ((length != (~lengthComplement & 0xFFFFu)) || (m_size - m_position < length))
+			throw Exception("Tiled file has invalid compressed data.");
+		priv_reserveOutput(length);
+		m_output.insert(m_output.end(), m_data + m_position, m_data + m_position + length);
+		m_position += length;
+	}
+	void priv_inflateFixedBlock()
+	{
+		std::uint8_t lengths[288u + 30u];
+		std::fill(lengths, lengths + 144u, std::uint8_t{ 8u });
+		std::fill(lengths + 144u, lengths + 256u, std::uint8_t{ 9u });
+		std::fill(lengths + 256u, lengths + 280u, std::uint8_t{ 7u });
+		std::fill(lengths + 280u, lengths + 288u, std::uint8_t{ 8u });
+		std::fill(lengths + 288u, lengths + 318u, std::uint8_t{ 5u });
+		Huffman lengthCodes{};
+		Huffman distanceCodes{};
+		priv_buildHuffman(lengthCodes, lengths, 288u);
+		priv_buildHuffman(distanceCodes, lengths + 288u, 30u);
+		priv_inflateCodes(lengthCodes, distanceCodes);
+	}
+	void priv_inflateDynamicBlock()
+	{
+		static constexpr std::uint8_t codeLengthOrder[19u]{ 16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u, 11u, 4u, 12u, 3u, 13u, 2u, 14u, 1u, 15u };
+		const std::size_t numberOfLengthCodes{ priv_readBits(5u) + 257u };
+		const std::size_t numberOfDistanceCodes{ priv_readBits(5u) + 1u };
+		const std::size_t numberOfCodeLengthCodes{ priv_readBits(4u) + 4u };
+		if ((numberOfLengthCodes > 286u) || (numberOfDistanceCodes > 30u))
+			throw Exception("Tiled file has invalid compressed data.");
+
+		std::uint8_t lengths[288u + 30u]{};
+		for (std::size_t i{ 0u }; i < numberOfCodeLengthCodes; ++i)
+			lengths[codeLengthOrder[i]] = static_cast<std::uint8_t>(priv_readBits(3u));
+		Huffman codeLengthCodes{};
+		priv_buildHuffman(codeLengthCodes, lengths, 19u);
+
+		std::fill(std::begin(lengths), std::end(lengths), std::uint8_t{ 0u });
+		for (std::size_t i{ 0u }; i < numberOfLengthCodes + numberOfDistanceCodes;)
+		{
+			const std::uint16_t symbol{ priv_decodeSymbol(codeLengthCodes) };
+			if (symbol < 16u)
+			{
+				lengths[i++] = static_cast<std::uint8_t>(symbol);
+				continue;
+			}
+			std::uint8_t length{ 0u };
+			std::size_t numberOfRepeats{ 0u };
+			if (symbol == 16u)
+			{
+				if (i == 0u)
+					throw Exception("Tiled file has invalid compressed data.");
+				length = lengths[i - 1u];
+				numberOfRepeats = 3u + priv_readBits(2u);
+			}
+			else if (symbol == 17u)
+				numberOfRepeats = 3u + priv_readBits(3u);
+			else
+				numberOfRepeats = 11u + priv_readBits(7u);
+			if (i + numberOfRepeats > numberOfLengthCodes + numberOfDistanceCodes)
+				throw Exception("Tiled file has invalid compressed data.");
+			for (; numberOfRepeats > 0u; --numberOfRepeats)
+				lengths[i++] = length;
+		}
+		if (lengths[256u] == 0u)
+			throw Exception("Tiled file has invalid compressed data.");
+
+		Huffman lengthCodes{};
+		Huffman distanceCodes{};
+		priv_buildHuffman(lengthCodes, lengths, numberOfLengthCodes);
+		priv_buildHuffman(distanceCodes, lengths + numberOfLengthCodes, numberOfDistanceCodes);
+		priv_inflateCodes(lengthCodes, distanceCodes);
+	}
+	void priv_inflateCodes(const Huffman& lengthCodes, const Huffman& distanceCodes)
+	{
+		static constexpr std::uint16_t lengthBases[29u]{ 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 13u, 15u, 17u, 19u, 23u, 27u, 31u, 35u, 43u, 51u, 59u, 67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u, 258u };
+		static constexpr std::uint8_t lengthExtraBits[29u]{ 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u, 1u, 1u, 1u, 2u, 2u, 2u, 2u, 3u, 3u, 3u, 3u, 4u, 4u, 4u, 4u, 5u, 5u, 5u, 5u, 0u };
+		static constexpr std::uint16_t distanceBases[30u]{ 1u, 2u, 3u, 4u, 5u, 7u, 9u, 13u, 17u, 25u, 33u, 49u, 65u, 97u, 129u, 193u, 257u, 385u, 513u, 769u, 1025u, 1537u, 2049u, 3073u, 4097u, 6145u, 8193u, 12289u, 16385u, 24577u };
+		static constexpr std::uint8_t distanceExtraBits[30u]{ 0u, 0u, 0u, 0u, 1u, 1u, 2u, 2u, 3u, 3u, 4u, 4u, 5u, 5u, 6u, 6u, 7u, 7u, 8u, 8u, 9u, 9u, 10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u };
+		while (true)
+		{
+			std::uint16_t symbol{ priv_decodeSymbol(lengthCodes) };
+			if (symbol < 256u)
+			{
+				priv_reserveOutput(1u);
+				m_output.push_back(static_cast<unsigned char>(symbol));
+				continue;
+			}
+			if (symbol == 256u)
+				return;
+
+			symbol -= 257u;
+			if (symbol >= 29u)
+				throw Exception("Tiled file has invalid compressed data.");
+			const std::size_t length{ lengthBases[symbol] + priv_readBits(lengthExtraBits[symbol]) };
+			const std::uint16_t distanceSymbol{ priv_decodeSymbol(distanceCodes) };
+			if (distanceSymbol >= 30u)
+				throw Exception("Tiled file has invalid compressed data.");
+			const std::size_t distance{ distanceBases[distanceSymbol] + priv_readBits(distanceExtraBits[distanceSymbol]) };
+			if (distance > m_output.size())
+				throw Exception("Tiled file has invalid compressed data.");
+			priv_reserveOutput(length);
+			for (std::size_t i{ 0u }; i < length; ++i)
+				m_output.push_back(m_output[m_output.size() - distance]);
+		}
+	}
+	std::uint16_t priv_decodeSymbol(const Huffman& huffman)
+	{
+		// canonical codes: the codes of each length are consecutive (and follow on from the shorter codes)
+		std::int32_t code{ 0 };
+		std::int32_t first{ 0 };
+		std::int32_t index{ 0 };
+		for (std::size_t length{ 1u }; length <= maxCodeLength; ++length)
+		{
+			code |= static_cast<std::int32_t>(priv_readBits(1u));
+			const std::int32_t count{ huffman.counts[length] };
+			if (code - count < first)
+				return huffman.symbols[index + (code - first)];
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+		throw Exception("Tiled file has invalid compressed data.");
+	}
+	static void priv_buildHuffman(Huffman& huffman, const std::uint8_t* const lengths, const std::size_t numberOfSymbols)
+	{
+		std::fill(std::begin(huffman.counts), std::end(huffman.counts), std::uint16_t{ 0u });
+		for (std::size_t s{ 0u }; s < numberOfSymbols; ++s)
+			++huffman.counts[lengths[s]];
+		std::int32_t numberOfUnusedCodes{ 1 };
+		for (std::size_t length{ 1u }; length <= maxCodeLength; ++length)
+		{
+			numberOfUnusedCodes <<= 1;
+			numberOfUnusedCodes -= huffman.counts[length];
+			if (numberOfUnusedCodes < 0)
+				throw Exception("Tiled file has invalid compressed data.");
+		}
+		std::uint16_t offsets[maxCodeLength + 1u]{};
+		for (std::size_t length{ 1u }; length < maxCodeLength; ++length)
+			offsets[length + 1u] = offsets[length] + huffman.counts[length];
+		for (std::size_t s{ 0u }; s < numberOfSymbols; ++s)
+		{
+			if (lengths[s] != 0u)
+				huffman.symbols[offsets[lengths[s]]++] = static_cast<std::uint16_t>(s);
+		}
+	}
+};
+
+inline TiledImporter::TiledImporter()
+	: m_numberOfThreads{ 1u }
+	, m_maxNumberOfCells{ 8192u * 8192u }
+	, m_tilesets{}
+{
+
+}
+
+inline void TiledImporter::setNumberOfThreads(std::size_t numberOfThreads)
+{
+	if (numberOfThreads == 0u)
+		numberOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	m_numberOfThreads = numberOfThreads;
+}
+
+inline void TiledImporter::setMaxNumberOfCells(const std::size_t maxNumberOfCells)
+{
+	m_maxNumberOfCells = maxNumberOfCells;
+}
+
+inline void TiledImporter::import(Map& map, const std::string& filename)
+{
+	// the file is scanned once. tilesets and object layers are read as they are found; tile layer data is only located and is decoded (on multiple threads) once every layer's size is known
+	const std::string file{ priv_readFile(filename) };
+	ImportedMap importedMap{};
+	importedMap.maxNumberOfCells = m_maxNumberOfCells;
+	if (priv_isJson(file))
+		priv_readJsonMap(file, filename, importedMap);
+	else
+		priv_readXmlMap(file, filename, importedMap);
+
+	// each decode task writes its own cells so they can be decoded together. texture transforms (of flipped tiles) are added afterwards in the same order every time
+	const std::vector<DecodeTask>& decodeTasks{ importedMap.decodeTasks };
+	std::vector<Grid>& grids{ importedMap.grids };
+	std::vector<std::vector<Grid::TileTextureTransform>> decodedTileTextureTransforms(decodeTasks.size());
+	std::vector<std::exception_ptr> decodeExceptions(decodeTasks.size());
+	auto decode = [&](const std::size_t d)
+	{
+		try
+		{
+			priv_decode(decodeTasks[d], grids[decodeTasks[d].gridIndex], decodedTileTextureTransforms[d]);
+		}
+		catch (...)
+		{
+			decodeExceptions[d] = std::current_exception();
+		}
+	};
+	if ((m_numberOfThreads > 1u) && (decodeTasks.size() > 1u))
+		ThreadPool{ std::min(m_numberOfThreads, decodeTasks.size()) }.run(decodeTasks.size(), decode);
+	else
+	{
+		for (std::size_t d{ 0u }; d < decodeTasks.size(); ++d)
+			decode(d);
+	}
+	for (std::size_t d{ 0u }; d < decodeTasks.size(); ++d)
+	{
+		if (decodeExceptions[d])
+			std::rethrow_exception(decodeExceptions[d]);
+		std::vector<Grid::TileTextureTransform>& tileTextureTransforms{ grids[decodeTasks[d].gridIndex].tileTextureTransforms };
+		tileTextureTransforms.insert(tileTextureTransforms.end(), decodedTileTextureTransforms[d].begin(), decodedTileTextureTransforms[d].end());
+	}
+
+	// an asynchronous update may still be reading the map. only that update is completed (the map's old data isn't built again)
+	map.waitForAsyncUpdate();
+	map.textureAtlas.swap(importedMap.textureAtlas);
+	map.textureAtlasPages.swap(importedMap.textureAtlasPages);
+	map.grids.swap(grids);
+	map.layers.swap(importedMap.layers);
+	m_tilesets.swap(importedMap.tilesets);
+	map.update();
+}
+
+inline const std::vector<TiledImporter::Tileset>& TiledImporter::getTilesets() const
+{
+	return m_tilesets;
+}
+
+
+
+// PRIVATE
+
+inline std::string TiledImporter::priv_readFile(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+		throw Exception("Unable to open Tiled file: " + filename);
+	std::ostringstream contents{};
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+inline std::string TiledImporter::priv_getDirectory(const std::string& filename)
+{
+	const std::size_t separator{ filename.find_last_of("/\\") };
+	return (separator == std::string::npos) ? std::string{} : filename.substr(0u, separator + 1u);
+}
+
+inline bool TiledImporter::priv_isJson(const std::string& file)
+{
+	// JSON files start with an object (after any space or byte order mark); TMX and TSX files start with a tag
+	const std::size_t first{ file.find_first_not_of(" \t\r\n\xEF\xBB\xBF") };
+	return (first != std::string::npos) && (file[first] == '{');
+}
+
+inline void TiledImporter::priv_readXmlMap(const std::string& file, const std::string& filename, ImportedMap& importedMap)
+{
+	const std::string directory{ priv_getDirectory(filename) };
+	XmlReader reader{ file.data(), file.size() };
+	std::vector<Grid>& grids{ importedMap.grids };
+	std::vector<DecodeTask>& decodeTasks{ importedMap.decodeTasks };
+	sf::Vector2f tileSize{ 0.f, 0.f };
+	bool isInfinite{ false };
+	std::vector<sf::Vector2f> groupOffsets{ { 0.f, 0.f } };
+
+	auto readLayerCommon = [&](bool& isActive, sf::Vector2f& offset, sf::Color& color)
+	{
+		isActive = (reader.getInteger("visible", 1) != 0);
+		offset = groupOffsets.back() + sf::Vector2f{ reader.getFloat("offsetx", 0.f), reader.getFloat("offsety", 0.f) };
+		color = priv_getColor(reader.getString("tintcolor"), reader.getFloat("opacity", 1.f));
+	};
+
+	while (reader.next())
+	{
+		if (reader.isEndTag)
+		{
+			if ((reader.name == "group") && (groupOffsets.size() > 1u))
+				groupOffsets.pop_back();
+			continue;
+		}
+
+		if (reader.name == "map")
+		{
+			const std::string orientation{ reader.getString("orientation") };
+			if (!orientation.empty() && (orientation != "orthogonal"))
+				throw Exception("Tiled map is not orthogonal: " + filename);
+			tileSize = { reader.getFloat("tilewidth", 0.f), reader.getFloat("tileheight", 0.f) };
+			isInfinite = (reader.getInteger("infinite", 0) != 0);
+		}
+		else if (reader.name == "tileset")
+		{
+			const std::size_t firstId{ reader.getSize("firstgid", 1u) };
+			const std::string source{ reader.getString("source") };
+			if (source.empty())
+				priv_readTileset(reader, firstId, directory, importedMap);
+			else
+			{
+				reader.skipElement();
+				priv_readTilesetFile(directory + source, firstId, importedMap);
+			}
+		}
+		else if (reader.name == "group")
+		{
+			if (!reader.isEmptyElement)
+				groupOffsets.push_back(groupOffsets.back() + sf::Vector2f{ reader.getFloat("offsetx", 0.f), reader.getFloat("offsety", 0.f) });
+		}
+		else if (reader.name == "layer")
+		{
+			const std::size_t gridIndex{ grids.size() };
+			grids.emplace_back();
+			Grid& grid{ grids.back() };
+			readLayerCommon(grid.isActive, grid.position, grid.color);
+			grid.zOrder = importedMap.zOrder++;
+			grid.tileSize = tileSize;
+			grid.invisibleId = 0u;
+			const sf::Vector2<std::size_t> layerSize{ reader.getSize("width", 0u), reader.getSize("height", 0u) };
+
+			const std::size_t firstDecodeTask{ decodeTasks.size() };
+			Encoding encoding{ Encoding::Xml };
+			Compression compression{ Compression::None };
+			const bool isEmptyLayer{ reader.isEmptyElement };
+			while (!isEmptyLayer && reader.next() && !reader.isEndOf("layer"))
+			{
+				if (reader.isStartOf("data"))
+				{
+					encoding = priv_getEncoding(reader.getString("encoding"));
+					compression = priv_getCompression(reader.getString("compression"), filename);
+					if (!isInfinite)
+					{
+						DecodeTask decodeTask{};
+						decodeTask.gridIndex = gridIndex;
+						decodeTask.size = layerSize;
+						decodeTask.encoding = encoding;
+						decodeTask.compression = compression;
+						if ((encoding != Encoding::Xml) && !reader.isEmptyElement)
+							reader.getText(decodeTask.text, decodeTask.textLength);
+						decodeTasks.push_back(std::move(decodeTask));
+					}
+				}
+				else if (reader.isStartOf("chunk"))
+				{
+					DecodeTask decodeTask{};
+					decodeTask.gridIndex = gridIndex;
+					decodeTask.location = { static_cast<int>(reader.getInteger("x", 0)), static_cast<int>(reader.getInteger("y", 0)) };
+					decodeTask.size = { reader.getSize("width", 0u), reader.getSize("height", 0u) };
+					decodeTask.encoding = encoding;
+					decodeTask.compression = compression;
+					if ((encoding != Encoding::Xml) && !reader.isEmptyElement)
+						reader.getText(decodeTask.text, decodeTask.textLength);
+					decodeTasks.push_back(std::move(decodeTask));
+				}
+				else if (reader.isStartOf("tile") && (encoding == Encoding::Xml) && (decodeTasks.size() > firstDecodeTask))
+					decodeTasks.back().gids.push_back(static_cast<std::uint32_t>(reader.getInteger("gid", 0)));
+			}
+			priv_setGridBounds(grid, importedMap, firstDecodeTask, tileSize);
+		}
+		else if (reader.name == "objectgroup")
+		{
+			importedMap.layers.emplace_back();
+			Layer& layer{ importedMap.layers.back() };
+			readLayerCommon(layer.isActive, layer.offset, layer.color);
+			layer.zOrder = importedMap.zOrder++;
+			const bool isEmptyLayer{ reader.isEmptyElement };
+			while (!isEmptyLayer && reader.next() && !reader.isEndOf("objectgroup"))
+			{
+				// only tile objects are imported. their position is their bottom-left corner
+				if (!reader.isStartOf("object") || (reader.getAttribute("gid") == nullptr))
+					continue;
+				const std::uint32_t gid{ static_cast<std::uint32_t>(reader.getInteger("gid", 0)) };
+				Tile tile{};
+				tile.id = priv_getTileId(gid);
+				const Tileset* const tileset{ priv_getTileset(importedMap.tilesets, tile.id) };
+				const sf::Vector2f defaultSize{ (tileset != nullptr) ? tileset->tileSize : tileSize };
+				tile.size = { reader.getFloat("width", defaultSize.x), reader.getFloat("height", defaultSize.y) };
+				tile.position = { reader.getFloat("x", 0.f), reader.getFloat("y", 0.f) - tile.size.y };
+				tile.isActive = (reader.getInteger("visible", 1) != 0);
+				tile.textureTransform = priv_getTextureTransform(gid);
+				layer.tiles.push_back(tile);
+			}
+		}
+	}
+}
+
+inline void TiledImporter::priv_readJsonMap(const std::string& file, const std::string& filename, ImportedMap& importedMap)
+{
+	// members can be in any order so the map's tilesets and layers are only located at first. the tilesets are read once the rest of the map is known and then the layers
+	JsonReader reader{ file.data(), file.size() };
+	std::string orientation{};
+	sf::Vector2f tileSize{ 0.f, 0.f };
+	bool isInfinite{ false };
+	const char* tilesetsText{ nullptr };
+	std::size_t tilesetsTextLength{ 0u };
+	const char* layersText{ nullptr };
+	std::size_t layersTextLength{ 0u };
+	reader.readObject([&](const std::string& key)
+	{
+		if (key == "orientation")
+			orientation = reader.readString();
+		else if (key == "tilewidth")
+			tileSize.x = reader.readFloat();
+		else if (key == "tileheight")
+			tileSize.y = reader.readFloat();
+		else if (key == "infinite")
+			isInfinite = reader.readBool();
+		else if (key == "tilesets")
+			reader.getValueText(tilesetsText, tilesetsTextLength);
+		else if (key == "layers")
+			reader.getValueText(layersText, layersTextLength);
+		else
+			reader.skipValue();
+	});
+	if (!orientation.empty() && (orientation != "orthogonal"))
+		throw Exception("Tiled map is not orthogonal: " + filename);
+
+	if (tilesetsText != nullptr)
+	{
+		const std::string directory{ priv_getDirectory(filename) };
+		JsonReader tilesetsReader{ tilesetsText, tilesetsTextLength };
+		tilesetsReader.readArray([&]() { priv_readJsonTileset(tilesetsReader, 1u, directory, importedMap); });
+	}
+	if (layersText != nullptr)
+		priv_readJsonLayers(layersText, layersTextLength, { 0.f, 0.f }, tileSize, isInfinite, filename, importedMap);
+}
+
+inline void TiledImporter::priv_readJsonLayers(const char* const text, const std::size_t textLength, const sf::Vector2f groupOffset, const sf::Vector2f tileSize, const bool isInfinite, const std::string& filename, ImportedMap& importedMap)
+{
+	// reads an array of layers (in order, including the layers of groups). each layer's members are read before it is added as they can be in any order (a group's layers are read once its offset is known)
+	JsonReader reader{ text, textLength };
+	reader.readArray([&]()
+	{
+		std::string type{};
+		bool isActive{ true };
+		sf::Vector2f offset{ 0.f, 0.f };
+		std::string tintColor{};
+		float opacity{ 1.f };
+		sf::Vector2<std::size_t> layerSize{ 0u, 0u };
+		std::string encodingName{};
+		std::string compressionName{};
+		std::vector<DecodeTask> layerDecodeTasks{}; // the layer's data (if the map isn't infinite) or its chunks
+		std::vector<Tile> tiles{};
+		const char* layersText{ nullptr };
+		std::size_t layersTextLength{ 0u };
+
+		// data is either an array of global tile ids (which is decoded as CSV) or a base64 string
+		auto readData = [&](DecodeTask& decodeTask)
+		{
+			decodeTask.encoding = (reader.peek() == '"') ? Encoding::Base64 : Encoding::Csv;
+			reader.getValueText(decodeTask.text, decodeTask.textLength);
+		};
+		reader.readObject([&](const std::string& key)
+		{
+			if (key == "type")
+				type = reader.readString();
+			else if (key == "visible")
+				isActive = reader.readBool();
+			else if (key == "offsetx")
+				offset.x = reader.readFloat();
+			else if (key == "offsety")
+				offset.y = reader.readFloat();
+			else if (key == "tintcolor")
+				tintColor = reader.readString();
+			else if (key == "opacity")
+				opacity = reader.readFloat();
+			else if (key == "width")
+				layerSize.x = reader.readSize();
+			else if (key == "height")
+				layerSize.y = reader.readSize();
+			else if (key == "encoding")
+				encodingName = reader.readString();
+			else if (key == "compression")
+				compressionName = reader.readString();
+			else if ((key == "data") && !isInfinite)
+			{
+				layerDecodeTasks.emplace(layerDecodeTasks.begin());
+				readData(layerDecodeTasks.front());
+			}
+			else if (key == "chunks")
+			{
+				reader.readArray([&]()
+				{
+					DecodeTask decodeTask{};
+					reader.readObject([&](const std::string& chunkKey)
+					{
+						if (chunkKey == "x")
+							decodeTask.location.x = static_cast<int>(reader.readInteger());
+						else if (chunkKey == "y")
+							decodeTask.location.y = static_cast<int>(reader.readInteger());
+						else if (chunkKey == "width")
+							decodeTask.size.x = reader.readSize();
+						else if (chunkKey == "height")
+							decodeTask.size.y = reader.readSize();
+						else if (chunkKey == "data")
+							readData(decodeTask);
+						else
+							reader.skipValue();
+					});
+					layerDecodeTasks.push_back(std::move(decodeTask));
+				});
+			}
+			else if (key == "objects")
+			{
+				// only tile objects are imported. their position is their bottom-left corner
+				reader.readArray([&]()
+				{
+					bool hasGid{ false };
+					std::uint32_t gid{ 0u };
+					sf::Vector2f position{ 0.f, 0.f };
+					sf::Vector2f size{ 0.f, 0.f };
+					sf::Vector2<bool> hasSize{ false, false };
+					bool isVisible{ true };
+					reader.readObject([&](const std::string& objectKey)
+					{
+						if (objectKey == "gid")
+						{
+							hasGid = true;
+							gid = static_cast<std::uint32_t>(reader.readInteger());
+						}
+						else if (objectKey == "x")
+							position.x = reader.readFloat();
+						else if (objectKey == "y")
+							position.y = reader.readFloat();
+						else if (objectKey == "width")
+						{
+							hasSize.x = true;
+							size.x = reader.readFloat();
+						}
+						else if (objectKey == "height")
+						{
+							hasSize.y = true;
+							size.y = reader.readFloat();
+						}
+						else if (objectKey == "visible")
+							isVisible = reader.readBool();
+						else
+							reader.skipValue();
+					});
+					if (!hasGid)
+						return;
+					Tile tile{};
+					tile.id = priv_getTileId(gid);
+					const Tileset* const tileset{ priv_getTileset(importedMap.tilesets, tile.id) };
+					const sf::Vector2f defaultSize{ (tileset != nullptr) ? tileset->tileSize : tileSize };
+					tile.size = { hasSize.x ? size.x : defaultSize.x, hasSize.y ? size.y : defaultSize.y };
+					tile.position = { position.x, position.y - tile.size.y };
+					tile.isActive = isVisible;
+					tile.textureTransform = priv_getTextureTransform(gid);
+					tiles.push_back(tile);
+				});
+			}
+			else if (key == "layers")
+				reader.getValueText(layersText, layersTextLength);
+			else
+				reader.skipValue();
+		});
+
+		if (type == "tilelayer")
+		{
+			importedMap.grids.emplace_back();
+			Grid& grid{ importedMap.grids.back() };
+			grid.isActive = isActive;
+			grid.position = groupOffset + offset;
+			grid.color = priv_getColor(tintColor, opacity);
+			grid.zOrder = importedMap.zOrder++;
+			grid.tileSize = tileSize;
+			grid.invisibleId = 0u;
+
+			const bool isBase64{ priv_getEncoding(encodingName) == Encoding::Base64 };
+			const Compression compression{ priv_getCompression(compressionName, filename) };
+			const std::size_t firstDecodeTask{ importedMap.decodeTasks.size() };
+			for (DecodeTask& decodeTask : layerDecodeTasks)
+			{
+				if ((decodeTask.encoding == Encoding::Base64) != isBase64)
+					throw Exception("Tiled layer's data doesn't match its encoding: " + filename);
+				decodeTask.gridIndex = importedMap.grids.size() - 1u;
+				decodeTask.compression = compression;
+				if (!isInfinite)
+					decodeTask.size = layerSize;
+				importedMap.decodeTasks.push_back(std::move(decodeTask));
+			}
+			priv_setGridBounds(grid, importedMap, firstDecodeTask, tileSize);
+		}
+		else if (type == "objectgroup")
+		{
+			importedMap.layers.emplace_back();
+			Layer& layer{ importedMap.layers.back() };
+			layer.isActive = isActive;
+			layer.offset = groupOffset + offset;
+			layer.color = priv_getColor(tintColor, opacity);
+			layer.zOrder = importedMap.zOrder++;
+			layer.tiles.swap(tiles);
+		}
+		else if ((type == "group") && (layersText != nullptr))
+			priv_readJsonLayers(layersText, layersTextLength, groupOffset + offset, tileSize, isInfinite, filename, importedMap);
+	});
+}
+
+inline void TiledImporter::priv_readTilesetFile(const std::string& filename, const std::size_t firstId, ImportedMap& importedMap)
+{
+	// tileset files can be TSX or JSON (whichever the map is)
+	const std::string file{ priv_readFile(filename) };
+	const std::string directory{ priv_getDirectory(filename) };
+	if (priv_isJson(file))
+	{
+		JsonReader reader{ file.data(), file.size() };
+		priv_readJsonTileset(reader, firstId, directory, importedMap);
+		return;
+	}
+
+	XmlReader reader{ file.data(), file.size() };
+	while (reader.next() && !reader.isStartOf("tileset")) { }
+	if (!reader.isStartOf("tileset"))
+		throw Exception("Tiled tileset file has no tileset: " + filename);
+	priv_readTileset(reader, firstId, directory, importedMap);
+}
+
+inline void TiledImporter::priv_readTileset(XmlReader& reader, const std::size_t firstId, const std::string& directory, ImportedMap& importedMap)
+{
+	// reads a tileset element (up to its end tag). only tilesets that use a single image are supported
+	Tileset tileset{};
+	tileset.firstId = firstId;
+	tileset.tileSize = { reader.getFloat("tilewidth", 0.f), reader.getFloat("tileheight", 0.f) };
+	tileset.numberOfTiles = reader.getSize("tilecount", 0u);
+	const std::size_t numberOfColumns{ reader.getSize("columns", 0u) };
+	const float spacing{ reader.getFloat("spacing", 0.f) };
+	const float margin{ reader.getFloat("margin", 0.f) };
+	const std::string name{ reader.getString("name") };
+
+	std::size_t depth{ reader.isEmptyElement ? 0u : 1u };
+	while (depth > 0u)
+	{
+		if (!reader.next())
+			throw Exception("Tiled tileset is unfinished: " + name);
+		if (reader.isEndTag)
+		{
+			--depth;
+			continue;
+		}
+		if (reader.name == "image")
+		{
+			if (depth > 1u)
+				throw Exception("Tiled image collection tilesets are not supported: " + name);
+			tileset.imageSource = directory + reader.getString("source");
+			tileset.imageSize = { reader.getFloat("width", 0.f), reader.getFloat("height", 0.f) };
+		}
+		if (!reader.isEmptyElement)
+			++depth;
+	}
+	if (tileset.imageSource.empty() || (tileset.imageSource == directory))
+		throw Exception("Tiled tileset has no image: " + name);
+	priv_addTileset(tileset, numberOfColumns, spacing, margin, name, importedMap);
+}
+
+inline void TiledImporter::priv_readJsonTileset(JsonReader& reader, std::size_t firstId, const std::string& directory, ImportedMap& importedMap)
+{
+	// reads a tileset object: either a map's reference to a tileset file or the tileset itself (in a map or in a tileset file). only tilesets that use a single image are supported
+	Tileset tileset{};
+	std::string source{};
+	std::string image{};
+	std::string name{};
+	std::size_t numberOfColumns{ 0u };
+	float spacing{ 0.f };
+	float margin{ 0.f };
+	bool hasTileImages{ false };
+	reader.readObject([&](const std::string& key)
+	{
+		if (key == "firstgid")
+			firstId = reader.readSize();
+		else if (key == "source")
+			source = reader.readString();
+		else if (key == "name")
+			name = reader.readString();
+		else if (key == "tilewidth")
+			tileset.tileSize.x = reader.readFloat();
+		else if (key == "tileheight")
+			tileset.tileSize.y = reader.readFloat();
+		else if (key == "tilecount")
+			tileset.numberOfTiles = reader.readSize();
+		else if (key == "columns")
+			numberOfColumns = reader.readSize();
+		else if (key == "spacing")
+			spacing = reader.readFloat();
+		else if (key == "margin")
+			margin = reader.readFloat();
+		else if (key == "image")
+			image = reader.readString();
+		else if (key == "imagewidth")
+			tileset.imageSize.x = reader.readFloat();
+		else if (key == "imageheight")
+			tileset.imageSize.y = reader.readFloat();
+		else if ((key == "tiles") && (reader.peek() == '['))
+		{
+			// tiles that have their own images are in image collection tilesets
+			reader.readArray([&]()
+			{
+				reader.readObject([&](const std::string& tileKey)
+				{
+					hasTileImages = hasTileImages || (tileKey == "image");
+					reader.skipValue();
+				});
+			});
+		}
+		else
+			reader.skipValue();
+	});
+
+	if (!source.empty())
+	{
+		priv_readTilesetFile(directory + source, firstId, importedMap);
+		return;
+	}
+	if (hasTileImages)
+		throw Exception("Tiled image collection tilesets are not supported: " + name);
+	if (image.empty())
+		throw Exception("Tiled tileset has no image: " + name);
+	tileset.firstId = firstId;
+	tileset.imageSource = directory + image;
+	priv_addTileset(tileset, numberOfColumns, spacing, margin, name, importedMap);
+}
+
+inline void TiledImporter::priv_addTileset(Tileset tileset, std::size_t numberOfColumns, const float spacing, const float margin, const std::string& name, ImportedMap& importedMap)
+{
+	// sets the tileset's tiles' texture atlas rectangles (on the tileset's texture page). the number of columns and tiles are found from the image size if they aren't given
+	if ((tileset.tileSize.x <= 0.f) || (tileset.tileSize.y <= 0.f))
+		throw Exception("Tiled tileset has an invalid tile size: " + name);
+
+	if (numberOfColumns == 0u)
+		numberOfColumns = static_cast<std::size_t>(std::max((tileset.imageSize.x - (margin * 2.f) + spacing) / (tileset.tileSize.x + spacing), 0.f));
+	if (tileset.numberOfTiles == 0u)
+		tileset.numberOfTiles = numberOfColumns * static_cast<std::size_t>(std::max((tileset.imageSize.y - (margin * 2.f) + spacing) / (tileset.tileSize.y + spacing), 0.f));
+	const std::size_t firstId{ tileset.firstId };
+	const std::size_t numberOfTiles{ tileset.numberOfTiles };
+	if ((numberOfColumns == 0u) || (numberOfTiles == 0u) || (firstId + numberOfTiles - 1u > static_cast<std::size_t>(std::numeric_limits<TileIdType>::max())))
+		throw Exception("Tiled tileset has invalid tiles: " + name);
+
+	std::vector<sf::FloatRect>& textureAtlas{ importedMap.textureAtlas };
+	std::vector<std::size_t>& textureAtlasPages{ importedMap.textureAtlasPages };
+	if (textureAtlas.size() < firstId + numberOfTiles)
+	{
+		textureAtlas.resize(firstId + numberOfTiles);
+		textureAtlasPages.resize(firstId + numberOfTiles, 0u);
+	}
+	for (std::size_t t{ 0u }; t < numberOfTiles; ++t)
+	{
+		textureAtlas[firstId + t] = { { margin + ((t % numberOfColumns) * (tileset.tileSize.x + spacing)), margin + ((t / numberOfColumns) * (tileset.tileSize.y + spacing)) }, tileset.tileSize };
+		textureAtlasPages[firstId + t] = importedMap.tilesets.size();
+	}
+	importedMap.tilesets.push_back(tileset);
+}
+
+inline const TiledImporter::Tileset* TiledImporter::priv_getTileset(const std::vector<Tileset>& tilesets, const std::size_t id)
+{
+	// the tileset that the id is in (the one with the highest first id that isn't after it)
+	const Tileset* found{ nullptr };
+	for (const Tileset& tileset : tilesets)
+	{
+		if ((tileset.firstId <= id) && ((found == nullptr) || (tileset.firstId > found->firstId)))
+			found = &tileset;
+	}
+	return found;
+}
+
+inline void TiledImporter::priv_setGridBounds(Grid& grid, ImportedMap& importedMap, const std::size_t firstDecodeTask, const sf::Vector2f tileSize)
+{
+	// the grid covers all of its data (for infinite maps, the bounds of all of its chunks). its decode tasks' locations are moved to be within the grid.
+	// sizes are checked before the grid is allocated so a file can't claim a grid that overflows (or is larger than the maximum number of cells)
+	std::vector<DecodeTask>& decodeTasks{ importedMap.decodeTasks };
+	if (decodeTasks.size() == firstDecodeTask)
+		return;
+	constexpr std::int64_t maxInt{ std::numeric_limits<int>::max() };
+	sf::Vector2<std::int64_t> firstCell{ decodeTasks[firstDecodeTask].location.x, decodeTasks[firstDecodeTask].location.y };
+	sf::Vector2<std::int64_t> endCell{ firstCell };
+	for (std::size_t d{ firstDecodeTask }; d < decodeTasks.size(); ++d)
+	{
+		const DecodeTask& decodeTask{ decodeTasks[d] };
+		if ((decodeTask.size.x > static_cast<std::size_t>(maxInt)) || (decodeTask.size.y > static_cast<std::size_t>(maxInt)))
+			throw Exception("Tiled layer is too large.");
+		firstCell = { std::min<std::int64_t>(firstCell.x, decodeTask.location.x), std::min<std::int64_t>(firstCell.y, decodeTask.location.y) };
+		endCell = { std::max<std::int64_t>(endCell.x, decodeTask.location.x + static_cast<std::int64_t>(decodeTask.size.x)), std::max<std::int64_t>(endCell.y, decodeTask.location.y + static_cast<std::int64_t>(decodeTask.size.y)) };
+	}
+	const sf::Vector2<std::int64_t> numberOfCells{ endCell.x - firstCell.x, endCell.y - firstCell.y };
+	if ((endCell.x > maxInt) || (endCell.y > maxInt) || (numberOfCells.x > maxInt) || (numberOfCells.y > maxInt) || ((numberOfCells.y > 0) && (static_cast<std::uint64_t>(numberOfCells.x) > importedMap.maxNumberOfCells / static_cast<std::uint64_t>(numberOfCells.y))))
+		throw Exception("Tiled layer is too large.");
+
+	for (std::size_t d{ firstDecodeTask }; d < decodeTasks.size(); ++d)
+		decodeTasks[d].location -= sf::Vector2i{ static_cast<int>(firstCell.x), static_cast<int>(firstCell.y) };
+	grid.position += { static_cast<float>(firstCell.x) * tileSize.x, static_cast<float>(firstCell.y) * tileSize.y };
+	grid.rowWidth = static_cast<std::size_t>(std::max<std::int64_t>(numberOfCells.x, 1));
+	grid.tileIds.assign(static_cast<std::size_t>(numberOfCells.x) * static_cast<std::size_t>(numberOfCells.y), TileIdType{ 0u });
+}
+
+inline TiledImporter::Encoding TiledImporter::priv_getEncoding(const std::string& encodingName)
+{
+	// no encoding is XML in TMX files (and an array in JSON files)
+	if (encodingName.empty())
+		return Encoding::Xml;
+	if (encodingName == "csv")
+		return Encoding::Csv;
+	if (encodingName == "base64")
+		return Encoding::Base64;
+	throw Exception("Tiled layer has an unknown encoding: " + encodingName);
+}
+
+inline TiledImporter::Compression TiledImporter::priv_getCompression(const std::string& compressionName, const std::string& filename)
+{
+	if (compressionName.empty())
+		return Compression::None;
+	if (compressionName == "zlib")
+		return Compression::Zlib;
+	if (compressionName == "gzip")
+		return Compression::Gzip;
+	if (compressionName == "zstd")
+	{
+#ifdef CHEESEMAP_USE_ZSTD
+		return Compression::Zstd;
+#else
+		throw Exception("Tiled layer uses zstd compression, which requires CHEESEMAP_USE_ZSTD: " + filename);
+#endif // CHEESEMAP_USE_ZSTD
+	}
+	throw Exception("Tiled layer has an unknown compression (" + compressionName + "): " + filename);
+}
+
+inline sf::Color TiledImporter::priv_getColor(const std::string& tintColor, const float opacity)
+{
+	// a layer's tint colour (#RRGGBB or #AARRGGBB) with its opacity as alpha
+	sf::Color color{ sf::Color::White };
+	if ((tintColor.size() == 7u) || (tintColor.size() == 9u))
+	{
+		const unsigned long argb{ std::strtoul(tintColor.c_str() + 1u, nullptr, 16) };
+		color = { static_cast<std::uint8_t>(argb >> 16u), static_cast<std::uint8_t>(argb >> 8u), static_cast<std::uint8_t>(argb) };
+	}
+	color.a = static_cast<std::uint8_t>(std::min(std::max(opacity, 0.f), 1.f) * 255.f);
+	return color;
+}
+
+inline void TiledImporter::priv_decode(const DecodeTask& decodeTask, Grid& grid, std::vector<Grid::TileTextureTransform>& tileTextureTransforms)
+{
+	// writes the task's cells of the grid (and the texture transforms of its flipped tiles)
+	const std::size_t numberOfCells{ decodeTask.size.x * decodeTask.size.y };
+	std::size_t cell{ 0u };
+	auto setCell = [&](const std::uint32_t gid)
+	{
+		if (cell == numberOfCells)
+			throw Exception("Tiled layer has too much data.");
+		const std::size_t tileIndex{ ((static_cast<std::size_t>(decodeTask.location.y) + (cell / decodeTask.size.x)) * grid.rowWidth) + static_cast<std::size_t>(decodeTask.location.x) + (cell % decodeTask.size.x) };
+		grid.tileIds[tileIndex] = priv_getTileId(gid);
+		if ((gid & 0xE0000000u) != 0u)
+			tileTextureTransforms.push_back({ tileIndex, { 0.f, 0.f }, priv_getTextureTransform(gid) });
+		++cell;
+	};
+
+	switch (decodeTask.encoding)
+	{
+	case Encoding::Xml:
+		for (const std::uint32_t gid : decodeTask.gids)
+			setCell(gid);
+		break;
+	case Encoding::Csv:
+	{
+		const char* text{ decodeTask.text };
+		const char* const textEnd{ text + decodeTask.textLength };
+		while (text != textEnd)
+		{
+			if ((*text < '0') || (*text > '9'))
+			{
+				++text;
+				continue;
+			}
+			std::uint64_t gid{ 0u };
+			for (; (text != textEnd) && (*text >= '0') && (*text <= '9'); ++text)
+				gid = (gid * 10u) + static_cast<std::uint64_t>(*text - '0');
+			if (gid > 0xFFFFFFFFu)
+				throw Exception("Tiled layer has an invalid tile id.");
+			setCell(static_cast<std::uint32_t>(gid));
+		}
+	}
+		break;
+	default:
+	case Encoding::Base64:
+	{
+		std::vector<unsigned char> bytes{};
+		priv_decodeBase64(decodeTask.text, decodeTask.textLength, bytes);
+#ifdef CHEESEMAP_USE_ZSTD
+		if (decodeTask.compression == Compression::Zstd)
+		{
+			std::vector<unsigned char> decompressedBytes(numberOfCells * 4u);
+			const std::size_t numberOfDecompressedBytes{ ZSTD_decompress(decompressedBytes.data(), decompressedBytes.size(), bytes.data(), bytes.size()) };
+			if (ZSTD_isError(numberOfDecompressedBytes))
+				throw Exception("Tiled layer has invalid zstd data.");
+			decompressedBytes.resize(numberOfDecompressedBytes);
+			bytes.swap(decompressedBytes);
+		}
+		else
+#endif // CHEESEMAP_USE_ZSTD
+		if (decodeTask.compression != Compression::None)
+		{
+			// skip the zlib (or gzip) header and then inflate its raw deflate data
+			std::size_t headerSize{ 2u };
+			if (decodeTask.compression == Compression::Zlib)
+			{
+				if ((bytes.size() < 2u) || ((bytes[0u] & 0x0Fu) != 8u) || ((((bytes[0u] << 8u) | bytes[1u]) % 31u) != 0u) || ((bytes[1u] & 0x20u) != 0u))
+					throw Exception("Tiled layer has invalid zlib data.");
+			}
+			else
+			{
+				if ((bytes.size() < 10u) || (bytes[0u] != 0x1Fu) || (bytes[1u] != 0x8Bu) || (bytes[2u] != 8u))
+					throw Exception("Tiled layer has invalid gzip data.");
+				const unsigned char flags{ bytes[3u] };
+				headerSize = 10u;
+				if ((flags & 0x04u) != 0u)
+					headerSize += 2u + ((headerSize + 2u <= bytes.size()) ? (bytes[headerSize] | (bytes[headerSize + 1u] << 8u)) : 0u);
+				for (const unsigned char stringFlag : { 0x08u, 0x10u })
+				{
+					if ((flags & stringFlag) == 0u)
+						continue;
+					while ((headerSize < bytes.size()) && (bytes[headerSize] != 0u))
+						++headerSize;
+					++headerSize;
+				}
+				if ((flags & 0x02u) != 0u)
+					headerSize += 2u;
+				if (headerSize > bytes.size())
+					throw Exception("Tiled layer has invalid gzip data.");
+			}
+			std::vector<unsigned char> inflatedBytes{};
+			inflatedBytes.reserve(numberOfCells * 4u);
+			const std::size_t trailer{ headerSize + Inflater{ bytes.data() + headerSize, bytes.size() - headerSize, numberOfCells * 4u, inflatedBytes }.inflate() };
+
+			// zlib data ends with the (big-endian) Adler-32 of the data; gzip data ends with the (little-endian) CRC-32 and size
+			auto readTrailer = [&](const std::size_t position, const bool isBigEndian)
+			{
+				std::uint32_t value{ 0u };
+				for (std::size_t b{ 0u }; b < 4u; ++b)
+					value |= static_cast<std::uint32_t>(bytes[position + b]) << (isBigEndian ? (24u - (b * 8u)) : (b * 8u));
+				return value;
+			};
+			if (decodeTask.compression == Compression::Zlib)
+			{
+				if ((bytes.size() - trailer < 4u) || (readTrailer(trailer, true) != Inflater::getAdler32(inflatedBytes.data(), inflatedBytes.size())))
+					throw Exception("Tiled layer has invalid zlib data.");
+			}
+			else if ((bytes.size() - trailer < 8u) || (readTrailer(trailer, false) != Inflater::getCrc32(inflatedBytes.data(), inflatedBytes.size())) || (readTrailer(trailer + 4u, false) != static_cast<std::uint32_t>(inflatedBytes.size())))
+				throw Exception("Tiled layer has invalid gzip data.");
+			bytes.swap(inflatedBytes);
+		}
+		if (bytes.size() % 4u != 0u)
+			throw Exception("Tiled layer has invalid data.");
+		for (std::size_t b{ 0u }, numberOfBytes{ bytes.size() }; b < numberOfBytes; b += 4u)
+			setCell(static_cast<std::uint32_t>(bytes[b]) | (static_cast<std::uint32_t>(bytes[b + 1u]) << 8u) | (static_cast<std::uint32_t>(bytes[b + 2u]) << 16u) | (static_cast<std::uint32_t>(bytes[b + 3u]) << 24u));
+	}
+		break;
+	}
+
+	if (cell != numberOfCells)
+		throw Exception("Tiled layer has too little data.");
+}
+
+inline void TiledImporter::priv_decodeBase64(const char* text, const std::size_t textLength, std::vector<unsigned char>& bytes)
+{
+	bytes.reserve((textLength / 4u) * 3u);
+	std::uint32_t bitBuffer{ 0u };
+	std::size_t numberOfBits{ 0u };
+	for (const char* const textEnd{ text + textLength }; text != textEnd; ++text)
+	{
+		const char c{ *text };
+		std::uint32_t value{ 0u };
+		if ((c >= 'A') && (c <= 'Z'))
+			value = static_cast<std::uint32_t>(c - 'A');
+		else if ((c >= 'a') && (c <= 'z'))
+			value = static_cast<std::uint32_t>(c - 'a') + 26u;
+		else if ((c >= '0') && (c <= '9'))
+			value = static_cast<std::uint32_t>(c - '0') + 52u;
+		else if (c == '+')
+			value = 62u;
+		else if (c == '/')
+			value = 63u;
+		else if (c == '=')
+			break;
+		else if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\\'))
+			continue; // JSON can escape '/' as "\/"
+		else
+			throw Exception("Tiled layer has invalid base64 data.");
+
+		bitBuffer = (bitBuffer << 6u) | value;
+		numberOfBits += 6u;
+		if (numberOfBits >= 8u)
+		{
+			numberOfBits -= 8u;
+			bytes.push_back(static_cast<unsigned char>(bitBuffer >> numberOfBits));
+		}
+	}
+}
+
+inline TileIdType TiledImporter::priv_getTileId(const std::uint32_t gid)
+{
+	// the top four bits of a global tile id are flags
+	const std::uint32_t id{ gid & 0x0FFFFFFFu };
+	if (id > std::numeric_limits<TileIdType>::max())
+		throw Exception("Tiled tile id is too large for the tile id type.");
+	return static_cast<TileIdType>(id);
+}
+
+inline TextureTransform TiledImporter::priv_getTextureTransform(const std::uint32_t gid)
+{
+	// Tiled flips diagonally (swapping x and y) first and then horizontally and vertically.
+	// a diagonal flip is a turn (clockwise) with the texture flipped vertically beforehand, which also swaps which of the other flips is applied before the turn
+	const bool flipHorizontally{ (gid & 0x80000000u) != 0u };
+	const bool flipVertically{ (gid & 0x40000000u) != 0u };
+	const bool flipDiagonally{ (gid & 0x20000000u) != 0u };
+	TextureTransform textureTransform{};
+	textureTransform.turn = flipDiagonally;
+	textureTransform.flipX = flipDiagonally ? flipVertically : flipHorizontally;
+	textureTransform.flipY = flipDiagonally ? !flipHorizontally : flipVertically;
+	return textureTransform;
+}
+
+} // namespace cheesemap
@@ -0,0 +1,423 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Benchmark
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// builds synthetic maps and times their rebuilds and picking (and packing a texture atlas) without opening a window (updates are completed with Map::waitForUpdate() instead of drawing).
+// results are written to the standard output as JSON so that they can be compared across versions (and with CheeseMapBenchmarkScalar, which is the same benchmark built with CHEESEMAP_NO_SIMD).
+//
+// usage: CheeseMapBenchmark [--repeats n] [--threads n] [--filter text]
+
+#include <CheeseMap.hpp>
+#include <CheeseMap/AtlasPacker.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef CHEESEMAP_VERSION
+#define CHEESEMAP_VERSION "unknown"
+#endif // CHEESEMAP_VERSION
+
+namespace
+{
+
+volatile std::size_t pickingResult{ 0u }; // keeps picking results from being optimised away
+
+#ifdef CHEESEMAP_SSE2
+constexpr const char* simd{ "sse2" };
+#else // CHEESEMAP_SSE2
+constexpr const char* simd{ "none" }; // CHEESEMAP_NO_SIMD is defined (or SSE2 isn't available)
+#endif // CHEESEMAP_SSE2
+
+struct Options
+{
+	std::size_t numberOfRepeats{ 10u };
+	std::size_t numberOfThreads{ 1u };
+	std::string filter{};
+};
+
+struct Result
+{
+	std::string name;
+	std::size_t numberOfRepeats;
+	std::size_t numberOfOperations; // per repeat
+	double minMilliseconds;
+	double medianMilliseconds;
+	double meanMilliseconds;
+	double maxMilliseconds;
+};
+
+class Benchmark
+{
+public:
+	explicit Benchmark(const Options& options)
+		: m_options{ options }
+		, m_results{}
+	{
+	}
+
+	// times body (which does numberOfOperations operations) once for each repeat, after running it once to warm up
+	void run(const std::string& name, const std::size_t numberOfOperations, const std::function<void()>& body)
+	{
+		if (!m_options.filter.empty() && (name.find(m_options.filter) == std::string::npos))
+			return;
+
+		body();
+		std::vector<double> milliseconds{};
+		for (std::size_t r{ 0u }; r < m_options.numberOfRepeats; ++r)
+		{
+			const auto start{ std::chrono::steady_clock::now() };
+			body();
+			milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		std::sort(milliseconds.begin(), milliseconds.end());
+		double total{ 0.0 };
+		for (const double m : milliseconds)
+			total += m;
+		const std::size_t n{ milliseconds.size() };
+		const double median{ (n % 2u == 1u) ? milliseconds[n / 2u] : (milliseconds[(n / 2u) - 1u] + milliseconds[n / 2u]) * 0.5 };
+		m_results.push_back({ name, n, numberOfOperations, milliseconds.front(), median, total / static_cast<double>(n), milliseconds.back() });
+		std::fprintf(stderr, "%-40s median %10.3f ms\n", name.c_str(), median);
+	}
+
+	void write(std::FILE* const file) const
+	{
+		std::fprintf(file, "{\n\t\"cheeseMapVersion\": \"%s\",\n\t\"simd\": \"%s\",\n\t\"numberOfThreads\": %zu,\n\t\"results\": [\n", CHEESEMAP_VERSION, simd, m_options.numberOfThreads);
+		for (std::size_t i{ 0u }; i < m_results.size(); ++i)
+		{
+			const Result& result{ m_results[i] };
+			std::fprintf(file, "\t\t{ \"name\": \"%s\", \"repeats\": %zu, \"operations\": %zu, \"minMs\": %.6f, \"medianMs\": %.6f, \"meanMs\": %.6f, \"maxMs\": %.6f, \"medianNsPerOperation\": %.3f }%s\n",
+				result.name.c_str(),
+				result.numberOfRepeats,
+				result.numberOfOperations,
+				result.minMilliseconds,
+				result.medianMilliseconds,
+				result.meanMilliseconds,
+				result.maxMilliseconds,
+				(result.medianMilliseconds * 1000000.0) / static_cast<double>(std::max(result.numberOfOperations, static_cast<std::size_t>(1u))),
+				(i + 1u < m_results.size()) ? "," : "");
+		}
+		std::fprintf(file, "\t]\n}\n");
+	}
+
+private:
+	Options m_options;
+	std::vector<Result> m_results;
+};
+
+// a 16 x 16 texture atlas of 16 x 16 pixel tiles
+void setTextureAtlas(cm::Map& map)
+{
+	map.textureAtlas.clear();
+	for (std::size_t i{ 0u }; i < 256u; ++i)
+		map.textureAtlas.push_back({ { static_cast<float>((i % 16u) * 16u), static_cast<float>((i / 16u) * 16u) }, { 16.f, 16.f } });
+}
+
+// a size x size grid of 16 x 16 tiles (about one in eight invisible). every transformInterval-th tile has a texture transform (0 for none)
+cm::Grid makeDenseGrid(const std::size_t size, const std::size_t transformInterval, std::mt19937& random)
+{
+	cm::Grid grid{};
+	grid.tileSize = { 16.f, 16.f };
+	grid.rowWidth = size;
+	grid.invisibleId = 0u;
+	grid.tileIds.resize(size * size);
+	for (auto& tileId : grid.tileIds)
+		tileId = static_cast<cm::TileIdType>(random() % 256u);
+	for (std::size_t t{ 0u }; (transformInterval != 0u) && (t < grid.tileIds.size()); t += transformInterval)
+	{
+		cm::Grid::TileTextureTransform tileTextureTransform{};
+		tileTextureTransform.tileIndex = t;
+		tileTextureTransform.textureTransform.flipX = ((t / transformInterval) % 2u == 0u);
+		tileTextureTransform.textureTransform.turn = ((t / transformInterval) % 3u == 0u);
+		grid.tileTextureTransforms.push_back(tileTextureTransform);
+	}
+	return grid;
+}
+
+// numberOfTiles tiles spread over a (worldSize x worldSize) square; every other tile uses one of the map's tile templates
+cm::Layer makeLayer(const std::size_t numberOfTiles, const float worldSize, const bool useSpatialIndex, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> position{ 0.f, worldSize };
+	std::uniform_real_distribution<float> size{ 8.f, 48.f };
+	cm::Layer layer{};
+	layer.useSpatialIndex = useSpatialIndex;
+	layer.tiles.resize(numberOfTiles);
+	for (std::size_t t{ 0u }; t < numberOfTiles; ++t)
+	{
+		cm::Tile& tile{ layer.tiles[t] };
+		tile.isTemplate = (t % 2u == 0u);
+		tile.id = static_cast<cm::TileIdType>(tile.isTemplate ? (random() % 4u) : (random() % 256u));
+		tile.position = { position(random), position(random) };
+		tile.size = tile.isTemplate ? sf::Vector2f{ 1.f, 1.f } : sf::Vector2f{ size(random), size(random) };
+		tile.textureTransform.flipY = (t % 5u == 0u);
+	}
+	return layer;
+}
+
+void setTileTemplates(cm::Map& map)
+{
+	map.tileTemplates.resize(4u);
+	for (std::size_t i{ 0u }; i < 4u; ++i)
+	{
+		map.tileTemplates[i].id = static_cast<cm::TileIdType>(i * 3u);
+		map.tileTemplates[i].size = { 16.f * static_cast<float>(i + 1u), 16.f };
+	}
+}
+
+std::vector<sf::Vector2f> makePoints(const std::size_t numberOfPoints, const float worldSize, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> coord{ 0.f, worldSize };
+	std::vector<sf::Vector2f> points(numberOfPoints);
+	for (auto& point : points)
+		point = { coord(random), coord(random) };
+	return points;
+}
+
+// the rebuild of the map for a view and for a sequence of moving views. picking is timed for grids and layers (if the map has them)
+void runMap(Benchmark& benchmark, const std::string& name, cm::Map& map, const float worldSize, const sf::Vector2f viewSize)
+{
+	std::mt19937 random{ 1u };
+	const sf::View view{ { worldSize * 0.5f, worldSize * 0.5f }, viewSize };
+	sf::View rotatedView{ view };
+	rotatedView.setRotation(sf::degrees(30.f));
+
+	benchmark.run(name + "/rebuild", 1u, [&]() { map.update(); map.update(view); map.waitForUpdate(); });
+	benchmark.run(name + "/rebuildRotated", 1u, [&]() { map.update(); map.update(rotatedView); map.waitForUpdate(); });
+
+	constexpr std::size_t numberOfViewMoves{ 16u };
+	benchmark.run(name + "/viewMoves", numberOfViewMoves, [&]()
+	{
+		for (std::size_t i{ 0u }; i < numberOfViewMoves; ++i)
+		{
+			sf::View movedView{ view };
+			movedView.move({ static_cast<float>(i) * 7.f, static_cast<float>(i) * 5.f });
+			map.update(movedView);
+			map.waitForUpdate();
+		}
+	});
+
+	constexpr std::size_t numberOfPoints{ 10000u };
+	const std::vector<sf::Vector2f> points{ makePoints(numberOfPoints, worldSize, random) };
+	if (!map.grids.empty())
+	{
+		std::vector<cm::Map::GridTileId> gridTileIds{};
+		benchmark.run(name + "/pickGrid", numberOfPoints, [&]()
+		{
+			std::size_t result{ 0u };
+			for (const auto& point : points)
+				result += map.getGridTileIdAtLocalCoord(point).tileIndex;
+			pickingResult = result;
+		});
+		benchmark.run(name + "/pickGridBatched", numberOfPoints, [&]() { map.getGridTileIdsAtLocalCoords(points.data(), points.size(), gridTileIds); });
+		benchmark.run(name + "/gridRectangle", 1u, [&]() { map.getGridTileIdsInLocalRectangle({ { worldSize * 0.25f, worldSize * 0.25f }, viewSize }, gridTileIds); });
+	}
+	if (!map.layers.empty())
+	{
+		// single queries of layers without spatial indices test every tile for every point so fewer points are used (the batched query only tests each tile once)
+		constexpr std::size_t numberOfLayerPoints{ 250u };
+		const std::vector<sf::Vector2f> layerPoints{ points.begin(), points.begin() + numberOfLayerPoints };
+		std::vector<cm::Map::LayerTileId> layerTileIds{};
+		benchmark.run(name + "/pickLayer", numberOfLayerPoints, [&]()
+		{
+			std::size_t result{ 0u };
+			for (const auto& point : layerPoints)
+				result += map.getLayerTileIdAtLocalCoord(point).tileIndex;
+			pickingResult = result;
+		});
+		benchmark.run(name + "/pickLayerBatched", numberOfLayerPoints, [&]() { map.getLayerTileIdsAtLocalCoords(layerPoints.data(), layerPoints.size(), layerTileIds); });
+		benchmark.run(name + "/layerRectangle", 1u, [&]() { map.getLayerTileIdsInLocalRectangle({ { worldSize * 0.25f, worldSize * 0.25f }, viewSize }, layerTileIds); });
+	}
+}
+
+bool readOptions(const int argc, char** const argv, Options& options)
+{
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const bool hasValue{ i + 1 < argc };
+		if ((std::strcmp(argv[i], "--repeats") == 0) && hasValue)
+			options.numberOfRepeats = std::max(static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10)), static_cast<std::size_t>(1u));
+		else if ((std::strcmp(argv[i], "--threads") == 0) && hasValue)
+			options.numberOfThreads = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if ((std::strcmp(argv[i], "--filter") == 0) && hasValue)
+			options.filter = argv[++i];
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--repeats n] [--threads n] [--filter text]\n", argv[0]);
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+int main(const int argc, char** const argv)
+{
+	Options options{};
+	if (!readOptions(argc, argv, options))
+		return EXIT_FAILURE;
+	Benchmark benchmark{ options };
+	std::mt19937 random{ 12345u };
+
+	auto setUpMap = [&](cm::Map& map)
+	{
+		map.setNumberOfThreads(options.numberOfThreads);
+		setTextureAtlas(map);
+		setTileTemplates(map);
+	};
+
+	// dense grids of increasing size (a 1920 x 1080 view shows 120 x 68 tiles)
+	for (const std::size_t size : { 256u, 1024u, 2048u })
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.grids.push_back(makeDenseGrid(size, 0u, random));
+		runMap(benchmark, "denseGrid" + std::to_string(size), map, static_cast<float>(size) * 16.f, { 1920.f, 1080.f });
+	}
+
+	// a whole dense grid in view (the most vertices)
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.grids.push_back(makeDenseGrid(512u, 0u, random));
+		runMap(benchmark, "denseGrid512Zoomed", map, 512.f * 16.f, { 8192.f, 8192.f });
+	}
+
+	// texture transforms on every 10th tile
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.grids.push_back(makeDenseGrid(1024u, 10u, random));
+		runMap(benchmark, "textureTransforms1024", map, 1024.f * 16.f, { 1920.f, 1080.f });
+	}
+
+	// layers (half of their tiles using tile templates), with and without spatial indices
+	for (const bool useSpatialIndex : { false, true })
+	{
+		cm::Map map{};
+		setUpMap(map);
+		for (std::size_t l{ 0u }; l < 4u; ++l)
+			map.layers.push_back(makeLayer(50000u, 16384.f, useSpatialIndex, random));
+		runMap(benchmark, useSpatialIndex ? "layersSpatialIndex" : "layers", map, 16384.f, { 1920.f, 1080.f });
+	}
+
+	// parallax: grids and layers at different depths
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.setDepthScale(1.5f);
+		for (std::size_t g{ 0u }; g < 4u; ++g)
+		{
+			map.grids.push_back(makeDenseGrid(512u, 0u, random));
+			map.grids.back().depth = 0.75f + (static_cast<float>(g) * 0.5f);
+			map.grids.back().zOrder = 4u - g;
+		}
+		for (std::size_t l{ 0u }; l < 2u; ++l)
+		{
+			map.layers.push_back(makeLayer(20000u, 8192.f, true, random));
+			map.layers.back().depth = 1.25f + static_cast<float>(l);
+		}
+		runMap(benchmark, "parallax", map, 8192.f, { 1920.f, 1080.f });
+	}
+
+	// the texture atlas split over four texture pages (the grid's quads are sorted by page; the layer's tiles stay in order so they are split wherever the page changes)
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.textureAtlasPages.resize(map.textureAtlas.size());
+		for (std::size_t i{ 0u }, numberOfTextureAtlasRectangles{ map.textureAtlas.size() }; i < numberOfTextureAtlasRectangles; ++i)
+			map.textureAtlasPages[i] = i % 4u;
+		map.grids.push_back(makeDenseGrid(1024u, 0u, random));
+		map.layers.push_back(makeLayer(50000u, 16384.f, true, random));
+		runMap(benchmark, "texturePages", map, 1024.f * 16.f, { 1920.f, 1080.f });
+	}
+
+	// two players and a minimap: each view has its own view slot so drawing them all again (without changes) doesn't rebuild
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.grids.push_back(makeDenseGrid(1024u, 0u, random));
+		map.setNumberOfViewSlots(3u);
+		const sf::View views[3u]{ { { 4096.f, 4096.f }, { 960.f, 1080.f } }, { { 12288.f, 12288.f }, { 960.f, 1080.f } }, { { 8192.f, 8192.f }, { 16384.f, 16384.f } } };
+		std::vector<sf::Vertex> vertices{};
+		benchmark.run("viewSlots/rebuild", 3u, [&]()
+		{
+			map.update();
+			for (std::size_t v{ 0u }; v < 3u; ++v)
+			{
+				map.setViewSlot(v);
+				map.update(views[v]);
+				map.waitForUpdate();
+			}
+		});
+		benchmark.run("viewSlots/switch", 3u, [&]()
+		{
+			for (std::size_t v{ 0u }; v < 3u; ++v)
+			{
+				map.setViewSlot(v);
+				map.update(views[v]);
+				map.waitForUpdate();
+			}
+		});
+	}
+
+	// a 4096 x 4096 grid zoomed all the way out, with and without level of detail (blocks of tiles at least 2 pixels wide on a 1920 x 1080 target; each rebuild also chooses the blocks again)
+	for (const bool useLevelOfDetail : { false, true })
+	{
+		cm::Map map{};
+		setUpMap(map);
+		map.grids.push_back(makeDenseGrid(4096u, 0u, random));
+		if (useLevelOfDetail)
+			map.setGridLevelOfDetail({ 1920.f, 1080.f }, 2.f);
+		const sf::View view{ { 32768.f, 32768.f }, { 65536.f * 16.f / 9.f, 65536.f } };
+		benchmark.run(useLevelOfDetail ? "gridLevelOfDetail/rebuild" : "gridZoomedOut/rebuild", 1u, [&]() { map.update(); map.update(view); map.waitForUpdate(); });
+	}
+
+	// packing thousands of tile images of different sizes into 4096 x 4096 pages
+	{
+		std::uniform_int_distribution<unsigned int> imageSize{ 8u, 64u };
+		std::vector<sf::Image> images{};
+		for (std::size_t i{ 0u }; i < 8192u; ++i)
+			images.emplace_back(sf::Vector2u{ imageSize(random), imageSize(random) }, sf::Color::White);
+		cm::AtlasPacker atlasPacker{};
+		atlasPacker.setNumberOfThreads(options.numberOfThreads);
+		benchmark.run("atlasPacker8192", images.size(), [&]() { atlasPacker.pack(images); });
+	}
+
+	benchmark.write(stdout);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Atlas Packer Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests packing images into atlas pages: the rectangles (with their extrusion) don't overlap and stay within the maximum page size, a new page is started when an image doesn't fit,
+// each extruded border repeats its image's edge pixels and applying the pack to a map from a first id and a first page offsets both
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+#include <CheeseMap/AtlasPacker.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+constexpr unsigned int extrusion{ 2u };
+constexpr sf::Vector2u maxPageSize{ 32u, 32u };
+
+// every pixel of every image is different
+std::vector<sf::Image> makeImages()
+{
+	const sf::Vector2u sizes[]{ { 20u, 20u }, { 10u, 6u }, { 20u, 20u }, { 7u, 7u }, { 0u, 0u }, { 12u, 3u }, { 5u, 5u }, { 20u, 18u } };
+	std::vector<sf::Image> images{};
+	for (const sf::Vector2u size : sizes)
+	{
+		images.emplace_back(size);
+		for (unsigned int y{ 0u }; y < size.y; ++y)
+		{
+			for (unsigned int x{ 0u }; x < size.x; ++x)
+				images.back().setPixel({ x, y }, sf::Color(static_cast<std::uint8_t>(images.size() * 30u), static_cast<std::uint8_t>(x * 10u), static_cast<std::uint8_t>(y * 10u)));
+		}
+	}
+	return images;
+}
+
+sf::IntRect getExtrudedRectangle(const sf::FloatRect& rectangle)
+{
+	return { { static_cast<int>(rectangle.position.x) - static_cast<int>(extrusion), static_cast<int>(rectangle.position.y) - static_cast<int>(extrusion) }, { static_cast<int>(rectangle.size.x) + static_cast<int>(extrusion * 2u), static_cast<int>(rectangle.size.y) + static_cast<int>(extrusion * 2u) } };
+}
+
+void testPack()
+{
+	const std::vector<sf::Image> images{ makeImages() };
+	for (const std::size_t numberOfThreads : { 1u, 2u })
+	{
+		cm::AtlasPacker atlasPacker{};
+		atlasPacker.setMaxPageSize(maxPageSize);
+		atlasPacker.setExtrusion(extrusion);
+		atlasPacker.setNumberOfThreads(numberOfThreads);
+		atlasPacker.pack(images);
+		const std::vector<sf::Image>& pages{ atlasPacker.getPages() };
+		const std::vector<sf::FloatRect>& textureAtlas{ atlasPacker.getTextureAtlas() };
+		const std::vector<std::size_t>& textureAtlasPages{ atlasPacker.getTextureAtlasPages() };
+		CHEESEMAP_CHECK(textureAtlas.size() == images.size());
+		CHEESEMAP_CHECK(textureAtlasPages.size() == images.size());
+		if ((textureAtlas.size() != images.size()) || (textureAtlasPages.size() != images.size()))
+			continue;
+
+		// only one of the three large images fits on each page and the 7 x 7 image (the largest of the others) doesn't fit beside or below any of them so it starts a fourth page
+		CHEESEMAP_CHECK(pages.size() == 4u);
+		CHEESEMAP_CHECK((textureAtlasPages[0u] != textureAtlasPages[2u]) && (textureAtlasPages[0u] != textureAtlasPages[7u]) && (textureAtlasPages[2u] != textureAtlasPages[7u]));
+
+		// an empty image has an empty rectangle on page 0
+		CHEESEMAP_CHECK(textureAtlas[4u] == sf::FloatRect{});
+		CHEESEMAP_CHECK(textureAtlasPages[4u] == 0u);
+
+		for (std::size_t i{ 0u }; i < images.size(); ++i)
+		{
+			const sf::Vector2u size{ images[i].getSize() };
+			if (size.x == 0u)
+				continue;
+			CHEESEMAP_CHECK(textureAtlas[i].size == sf::Vector2f(size));
+			CHEESEMAP_CHECK(textureAtlasPages[i] < pages.size());
+			if (textureAtlasPages[i] >= pages.size())
+				continue;
+			const sf::Image& page{ pages[textureAtlasPages[i]] };
+			CHEESEMAP_CHECK((page.getSize().x <= maxPageSize.x) && (page.getSize().y <= maxPageSize.y));
+
+			// the extruded rectangle is within the page and doesn't overlap any other image's extruded rectangle on the same page
+			const sf::IntRect extrudedRectangle{ getExtrudedRectangle(textureAtlas[i]) };
+			CHEESEMAP_CHECK((extrudedRectangle.position.x >= 0) && (extrudedRectangle.position.y >= 0));
+			CHEESEMAP_CHECK((extrudedRectangle.position.x + extrudedRectangle.size.x <= static_cast<int>(page.getSize().x)) && (extrudedRectangle.position.y + extrudedRectangle.size.y <= static_cast<int>(page.getSize().y)));
+			for (std::size_t j{ 0u }; j < i; ++j)
+			{
+				if ((images[j].getSize().x > 0u) && (textureAtlasPages[j] == textureAtlasPages[i]))
+					CHEESEMAP_CHECK(!extrudedRectangle.findIntersection(getExtrudedRectangle(textureAtlas[j])).has_value());
+			}
+
+			// every pixel of the extruded rectangle is its image's nearest pixel (so the border repeats the image's edge)
+			bool isEveryPixelMatching{ true };
+			for (int y{ 0 }; y < extrudedRectangle.size.y; ++y)
+			{
+				for (int x{ 0 }; x < extrudedRectangle.size.x; ++x)
+				{
+					const sf::Vector2u imagePixel{ static_cast<unsigned int>(std::min(std::max(x - static_cast<int>(extrusion), 0), static_cast<int>(size.x) - 1)), static_cast<unsigned int>(std::min(std::max(y - static_cast<int>(extrusion), 0), static_cast<int>(size.y) - 1)) };
+					const sf::Vector2u pagePixel{ static_cast<unsigned int>(extrudedRectangle.position.x + x), static_cast<unsigned int>(extrudedRectangle.position.y + y) };
+					isEveryPixelMatching = isEveryPixelMatching && (page.getPixel(pagePixel) == images[i].getPixel(imagePixel));
+				}
+			}
+			CHEESEMAP_CHECK(isEveryPixelMatching);
+		}
+	}
+}
+
+void testTooLarge()
+{
+	// an image is too large if it doesn't fit on a page with its extrusion
+	cm::AtlasPacker atlasPacker{};
+	atlasPacker.setMaxPageSize(maxPageSize);
+	atlasPacker.setExtrusion(extrusion);
+	bool isThrown{ false };
+	try
+	{
+		atlasPacker.pack(std::vector<sf::Image>{ sf::Image{ sf::Vector2u{ 29u, 4u } } });
+	}
+	catch (const cm::Exception&)
+	{
+		isThrown = true;
+	}
+	CHEESEMAP_CHECK(isThrown);
+}
+
+void testApply()
+{
+	// applying from id 2 and page 1 keeps the map's first two rectangles (on page 0); each image's id and page are offset
+	cm::AtlasPacker atlasPacker{};
+	atlasPacker.setMaxPageSize(maxPageSize);
+	atlasPacker.setExtrusion(extrusion);
+	atlasPacker.pack(makeImages());
+	const std::vector<sf::FloatRect>& textureAtlas{ atlasPacker.getTextureAtlas() };
+	const std::vector<std::size_t>& textureAtlasPages{ atlasPacker.getTextureAtlasPages() };
+
+	cm::Map map{};
+	map.textureAtlas.assign(2u, { { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlasPages.assign(2u, 0u);
+	atlasPacker.apply(map, 2u, 1u);
+	CHEESEMAP_CHECK(map.textureAtlas.size() == 2u + textureAtlas.size());
+	CHEESEMAP_CHECK(map.textureAtlasPages.size() == 2u + textureAtlas.size());
+	if ((map.textureAtlas.size() != 2u + textureAtlas.size()) || (map.textureAtlasPages.size() != 2u + textureAtlas.size()))
+		return;
+	for (std::size_t i{ 0u }; i < 2u; ++i)
+	{
+		CHEESEMAP_CHECK(map.textureAtlas[i] == sf::FloatRect({ 0.f, 0.f }, { 16.f, 16.f }));
+		CHEESEMAP_CHECK(map.textureAtlasPages[i] == 0u);
+	}
+	for (std::size_t i{ 0u }; i < textureAtlas.size(); ++i)
+	{
+		CHEESEMAP_CHECK(map.textureAtlas[2u + i] == textureAtlas[i]);
+		CHEESEMAP_CHECK(map.textureAtlasPages[2u + i] == 1u + textureAtlasPages[i]);
+	}
+
+	// applying the whole pack replaces the map's rectangles so that each image's id is its index and its page is its own
+	atlasPacker.apply(map);
+	CHEESEMAP_CHECK(map.textureAtlas == textureAtlas);
+	CHEESEMAP_CHECK(map.textureAtlasPages == textureAtlasPages);
+}
+
+} // namespace
+
+int main()
+{
+	testPack();
+	testTooLarge();
+	testApply();
+	return cheesemap::test::getResult();
+}
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Check
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+// a minimal check for the tests (which are plain executables run by CTest): failed checks are written to the standard error with their file and line
+// and each test's main returns cheesemap::test::getResult()
+namespace cheesemap
+{
+namespace test
+{
+
+inline std::size_t& getNumberOfFailures()
+{
+	static std::size_t numberOfFailures{ 0u };
+	return numberOfFailures;
+}
+
+inline bool check(const bool isPassed, const char* const condition, const char* const file, const int line)
+{
+	if (!isPassed)
+	{
+		std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, condition);
+		++getNumberOfFailures();
+	}
+	return isPassed;
+}
+
+inline int getResult()
+{
+	if (getNumberOfFailures() == 0u)
+		return EXIT_SUCCESS;
+	std::fprintf(stderr, "%zu check(s) failed\n", getNumberOfFailures());
+	return EXIT_FAILURE;
+}
+
+} // namespace test
+} // namespace cheesemap
+
+#define CHEESEMAP_CHECK(condition) cheesemap::test::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,293 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Chunk Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests (without drawing) how grids, sparse grids and layers are split into chunks, which chunks are rebuilt after changes and which chunks are waiting to be uploaded.
+// uploads are only completed when drawing so that part is only tested if CHEESEMAP_TEST_DRAWING is defined (it requires an OpenGL context)
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+
+#include <vector>
+
+#ifdef CHEESEMAP_TEST_DRAWING
+#include <SFML/Graphics/RenderTexture.hpp>
+#endif // CHEESEMAP_TEST_DRAWING
+
+namespace
+{
+
+constexpr std::size_t numberOfVerticesPerChunk{ 16u * 16u * 6u }; // a chunk of 256 x 256 is 16 x 16 tiles of 16 x 16
+
+// a 64 x 64 grid of 16 x 16 tiles (1024 x 1024) in 256 x 256 chunks: 4 x 4 chunks
+void setUpMap(cm::Map& map)
+{
+	map.textureAtlas.push_back({ { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlas.push_back({ { 16.f, 0.f }, { 16.f, 16.f } });
+	cm::Grid grid{};
+	grid.tileSize = { 16.f, 16.f };
+	grid.rowWidth = 64u;
+	grid.invisibleId = 2u;
+	grid.tileIds.assign(64u * 64u, 0u);
+	map.grids.push_back(grid);
+	map.setChunkSize({ 256.f, 256.f });
+}
+
+void testChunkCounts()
+{
+	// only chunks near the view (the chunks that it touches and one chunk around them) are built. chunks whose bounds only touch the view's edge are not visible
+	cm::Map map{};
+	setUpMap(map);
+	map.update(sf::View{ { 384.f, 384.f }, { 256.f, 256.f } }); // exactly chunk (1, 1)
+	const cm::Map::ChunkInfo chunkInfo{ map.getChunkInfo() };
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 9u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVisibleChunks == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksRequiringUpload == 9u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesRequiringUpload == 9u * numberOfVerticesPerChunk);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesUploaded == 0u);
+
+	// moving the view within the same chunks doesn't build anything
+	map.update(sf::View{ { 378.f, 378.f }, { 256.f, 256.f } });
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 0u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfVisibleChunks == 4u);
+}
+
+void testGridTileUpdate()
+{
+	// changing a tile only rebuilds its chunk (even if the tile disappears)
+	cm::Map map{};
+	setUpMap(map);
+	map.update(sf::View{ { 384.f, 384.f }, { 256.f, 256.f } });
+	map.getChunkInfo();
+
+	map.grids[0u].tileIds[(20u * 64u) + 20u] = 1u; // in chunk (1, 1)
+	map.updateGridTile(0u, (20u * 64u) + 20u);
+	cm::Map::ChunkInfo chunkInfo{ map.getChunkInfo() };
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+
+	map.grids[0u].tileIds[(40u * 64u) + 5u] = 2u; // in chunk (0, 2)
+	map.updateGridTile(0u, (40u * 64u) + 5u);
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesRequiringUpload == (9u * numberOfVerticesPerChunk) - 6u);
+
+	// a tile in a chunk that hasn't been built yet doesn't build anything
+	map.grids[0u].tileIds[(60u * 64u) + 60u] = 1u; // in chunk (3, 3)
+	map.updateGridTile(0u, (60u * 64u) + 60u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 0u);
+
+	// updating the whole grid rebuilds every chunk near the view
+	map.updateGrid(0u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 9u);
+}
+
+void testUploadsAcrossViewMove()
+{
+	// moving the view one chunk to the right only builds the new column of chunks. chunks that haven't been drawn are still waiting to be uploaded
+	cm::Map map{};
+	setUpMap(map);
+	map.update(sf::View{ { 384.f, 384.f }, { 256.f, 256.f } });
+	map.getChunkInfo();
+	map.update(sf::View{ { 640.f, 384.f }, { 256.f, 256.f } }); // exactly chunk (2, 1)
+	cm::Map::ChunkInfo chunkInfo{ map.getChunkInfo() };
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 3u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVisibleChunks == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksRequiringUpload == 12u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesRequiringUpload == 12u * numberOfVerticesPerChunk);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesUploaded == 0u);
+
+	// moving back builds nothing
+	map.update(sf::View{ { 384.f, 384.f }, { 256.f, 256.f } });
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 0u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksRequiringUpload == 12u);
+
+#ifdef CHEESEMAP_TEST_DRAWING
+	// drawing uploads only the visible chunk; the others are still waiting. drawing again uploads nothing
+	sf::Texture texture{ sf::Vector2u{ 32u, 16u } };
+	map.setTexture(texture);
+	sf::RenderTexture renderTexture{ sf::Vector2u{ 256u, 256u } };
+	renderTexture.setView(sf::View{ { 384.f, 384.f }, { 256.f, 256.f } });
+	renderTexture.draw(map);
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesUploaded == numberOfVerticesPerChunk);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksRequiringUpload == 11u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesRequiringUpload == 11u * numberOfVerticesPerChunk);
+	renderTexture.draw(map);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfVerticesUploaded == 0u);
+#endif // CHEESEMAP_TEST_DRAWING
+}
+
+void testSparseGridChunks()
+{
+	// sparse grids are built in their own (stored) chunks of 32 x 32 cells: 4 x 4 chunks of 512 x 512
+	cm::Map map{};
+	map.textureAtlas.push_back({ { 0.f, 0.f }, { 16.f, 16.f } });
+	cm::SparseGrid sparseGrid{};
+	sparseGrid.tileSize = { 16.f, 16.f };
+	sparseGrid.invisibleId = 2u;
+	for (std::size_t y{ 0u }; y < 128u; ++y)
+	{
+		for (std::size_t x{ 0u }; x < 128u; ++x)
+			sparseGrid.setTileId((y * cm::SparseGrid::rowWidth) + x, 0u);
+	}
+	map.sparseGrids.push_back(sparseGrid);
+	map.setChunkSize({ 256.f, 256.f });
+
+	map.update(sf::View{ { 768.f, 768.f }, { 512.f, 512.f } }); // exactly chunk (1, 1)
+	cm::Map::ChunkInfo chunkInfo{ map.getChunkInfo() };
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 9u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVisibleChunks == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVerticesRequiringUpload == 9u * 32u * 32u * 6u);
+
+	// a tile far away adds a stored chunk (which is only built when it is near the view)
+	map.sparseGrids[0u].setTileId((1000u * cm::SparseGrid::rowWidth) + 1000u, 0u);
+	map.updateSparseGrid(0u);
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 17u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 9u);
+	map.update(sf::View{ { 16008.f, 16008.f }, { 512.f, 512.f } });
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfVisibleChunks == 1u);
+}
+
+struct LayerQuad
+{
+	std::size_t tileIndex{ 0u };
+	sf::Vector2f position{}; // of the quad's first vertex
+};
+
+std::vector<LayerQuad> getLayerQuads(const cm::Map& map)
+{
+	// the layer's quads in the order that they are drawn
+	std::vector<LayerQuad> layerQuads{};
+	map.forEachVertexRun([&](const cm::Map::VertexRun& vertexRun)
+	{
+		for (std::size_t q{ 0u }; q < vertexRun.numberOfVertices / 6u; ++q)
+			layerQuads.push_back({ vertexRun.quadTiles[q], vertexRun.vertices[q * 6u].position });
+	});
+	return layerQuads;
+}
+
+bool isSameAsRebuilt(const cm::Map& map)
+{
+	// the map's (partly rebuilt) layer draws the same quads as the same layer built from nothing
+	cm::Map rebuiltMap{};
+	rebuiltMap.textureAtlas = map.textureAtlas;
+	rebuiltMap.layers = map.layers;
+	rebuiltMap.setChunkSize({ 256.f, 256.f });
+	rebuiltMap.update(sf::View{ { 512.f, 512.f }, { 1024.f, 1024.f } });
+	const std::vector<LayerQuad> layerQuads{ getLayerQuads(map) };
+	const std::vector<LayerQuad> rebuiltLayerQuads{ getLayerQuads(rebuiltMap) };
+	if (layerQuads.size() != rebuiltLayerQuads.size())
+		return false;
+	for (std::size_t q{ 0u }; q < layerQuads.size(); ++q)
+	{
+		if ((layerQuads[q].tileIndex != rebuiltLayerQuads[q].tileIndex) || (layerQuads[q].position != rebuiltLayerQuads[q].position))
+			return false;
+	}
+	return true;
+}
+
+void testLayerTileUpdate()
+{
+	// a layer with one tile in each of 4 x 4 chunks (all of a layer's chunks are built). changing a tile only rebuilds the chunk it was in and the chunk it is now in
+	cm::Map map{};
+	map.textureAtlas.push_back({ { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlas.push_back({ { 16.f, 0.f }, { 16.f, 16.f } });
+	cm::Layer layer{};
+	layer.tiles.resize(16u);
+	for (std::size_t t{ 0u }; t < 16u; ++t)
+	{
+		layer.tiles[t].id = 1u;
+		layer.tiles[t].position = { ((t % 4u) * 256.f) + 8.f, ((t / 4u) * 256.f) + 8.f };
+		layer.tiles[t].size = { 16.f, 16.f };
+	}
+	map.layers.push_back(layer);
+	map.setChunkSize({ 256.f, 256.f });
+	map.update(sf::View{ { 512.f, 512.f }, { 1024.f, 1024.f } });
+	cm::Map::ChunkInfo chunkInfo{ map.getChunkInfo() };
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 16u);
+
+	map.layers[0u].tiles[5u].id = 0u;
+	map.updateLayerTile(0u, 5u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+
+	// moving a tile into another tile's chunk (under that tile) leaves its previous chunk empty
+	map.layers[0u].tiles[5u].position = map.layers[0u].tiles[6u].position + sf::Vector2f{ 4.f, 4.f };
+	map.updateLayerTile(0u, 5u);
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 2u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+
+	// hiding a tile and showing it again
+	map.layers[0u].tiles[6u].isActive = false;
+	map.updateLayerTile(0u, 6u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+	map.layers[0u].tiles[6u].isActive = true;
+	map.updateLayerTile(0u, 6u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 1u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+
+	// a tile that moves to where there is no chunk (and a tile that is added) rebuilds every chunk (that has a tile)
+	map.layers[0u].tiles[6u].position = { 900.f, -300.f };
+	map.updateLayerTile(0u, 6u);
+	chunkInfo = map.getChunkInfo();
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunksBuilt == 16u);
+	CHEESEMAP_CHECK(chunkInfo.numberOfChunks == 16u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+	map.layers[0u].tiles.push_back(map.layers[0u].tiles[0u]);
+	map.updateLayerTile(0u, 16u);
+	CHEESEMAP_CHECK(map.getChunkInfo().numberOfChunksBuilt == 16u);
+	CHEESEMAP_CHECK(isSameAsRebuilt(map));
+}
+
+} // namespace
+
+int main()
+{
+	testChunkCounts();
+	testGridTileUpdate();
+	testUploadsAcrossViewMove();
+	testSparseGridChunks();
+	testLayerTileUpdate();
+	return cheesemap::test::getResult();
+}
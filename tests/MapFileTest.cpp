@@ -0,0 +1,293 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Map File Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests that a map file keeps the map (saving and loading it again), that grids use their tile ids directly from the file (unless the file was saved with a different tile id type)
+// and that a file that fails to load leaves the map unchanged
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+#include <CheeseMap/MapFile.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+
+constexpr std::size_t rowWidth{ cm::SparseGrid::rowWidth };
+
+void setUpMap(cm::Map& map)
+{
+	map.textureAtlas.push_back({ { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlas.push_back({ { 16.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlasPages = { 0u, 1u };
+	map.tileTemplates.push_back({ true, 1u, { 32.f, 32.f }, { 1.f, 2.f } });
+	cm::Animation animation{};
+	animation.id = 1u;
+	animation.frames = { { 0u, 0.5f }, { 1u, 0.25f } };
+	map.animations.push_back(animation);
+	cm::Grid grid{};
+	grid.tileSize = { 16.f, 16.f };
+	grid.rowWidth = 8u;
+	for (std::size_t t{ 0u }; t < 8u * 8u; ++t)
+		grid.tileIds.push_back(static_cast<cm::TileIdType>((t % 3u) == 0u));
+	map.grids.push_back(grid);
+	cm::Layer layer{};
+	layer.zOrder = 1u;
+	layer.offset = { 4.f, -4.f };
+	layer.useSpatialIndex = true;
+	layer.tiles.resize(2u);
+	layer.tiles[0u].id = 1u;
+	layer.tiles[0u].position = { 24.f, 40.f };
+	layer.tiles[0u].size = { 16.f, 8.f };
+	layer.tiles[0u].textureTransform.flipX = true;
+	layer.tiles[1u].isTemplate = true;
+	layer.tiles[1u].isActive = false;
+	layer.tiles[1u].position = { -8.f, 0.f };
+	map.layers.push_back(layer);
+	cm::SparseGrid sparseGrid{};
+	sparseGrid.zOrder = 2u;
+	sparseGrid.tileSize = { 8.f, 8.f };
+	sparseGrid.position = { -64.f, 32.f };
+	sparseGrid.invisibleId = 7u;
+	sparseGrid.setTileId(5u, 1u);
+	sparseGrid.setTileId((100000u * rowWidth) + 3u, 0u); // a different chunk
+	map.sparseGrids.push_back(sparseGrid);
+	map.sparseGrids.push_back(cm::SparseGrid{}); // without any chunks
+}
+
+void testSparseGrids()
+{
+	cm::Map map{};
+	setUpMap(map);
+	cm::MapFile::save(map, "MapFileTest.cmf");
+
+	cm::Map loadedMap{};
+	loadedMap.sparseGrids.resize(3u);
+	cm::MapFile mapFile{};
+	mapFile.load(loadedMap, "MapFileTest.cmf");
+	CHEESEMAP_CHECK(loadedMap.grids.size() == 1u);
+	CHEESEMAP_CHECK(loadedMap.sparseGrids.size() == 2u);
+	if (loadedMap.sparseGrids.size() != 2u)
+		return;
+
+	const cm::SparseGrid& sparseGrid{ loadedMap.sparseGrids[0u] };
+	CHEESEMAP_CHECK(sparseGrid.zOrder == 2u);
+	CHEESEMAP_CHECK(sparseGrid.tileSize == sf::Vector2f(8.f, 8.f));
+	CHEESEMAP_CHECK(sparseGrid.position == sf::Vector2f(-64.f, 32.f));
+	CHEESEMAP_CHECK(sparseGrid.invisibleId == 7u);
+	CHEESEMAP_CHECK(sparseGrid.getNumberOfChunks() == 2u);
+	CHEESEMAP_CHECK(sparseGrid.getTileId(5u) == 1u);
+	CHEESEMAP_CHECK(sparseGrid.getTileId((100000u * rowWidth) + 3u) == 0u);
+	CHEESEMAP_CHECK(sparseGrid.getTileId(6u) == 7u);
+	CHEESEMAP_CHECK(loadedMap.sparseGrids[1u].getNumberOfChunks() == 0u);
+}
+
+void checkTileIds(const cm::Map& map, const cm::Map& loadedMap)
+{
+	CHEESEMAP_CHECK(loadedMap.grids.size() == 1u);
+	if (loadedMap.grids.size() != 1u)
+		return;
+	const cm::Grid& grid{ loadedMap.grids[0u] };
+	CHEESEMAP_CHECK(grid.rowWidth == 8u);
+	CHEESEMAP_CHECK(grid.getNumberOfTiles() == map.grids[0u].tileIds.size());
+	CHEESEMAP_CHECK(std::equal(map.grids[0u].tileIds.begin(), map.grids[0u].tileIds.end(), grid.getTileIds()));
+}
+
+void testRoundTrip()
+{
+	// everything (other than sparse grids, tested above) is kept and the grid's tile ids are used directly from the (aligned) file
+	cm::Map map{};
+	setUpMap(map);
+	cm::MapFile::save(map, "MapFileTest.cmf");
+
+	cm::Map loadedMap{};
+	cm::MapFile mapFile{};
+	mapFile.load(loadedMap, "MapFileTest.cmf");
+	checkTileIds(map, loadedMap);
+	if (!loadedMap.grids.empty())
+	{
+		const cm::TileIdType* const externalTileIds{ loadedMap.grids[0u].externalTileIds };
+		CHEESEMAP_CHECK(externalTileIds != nullptr);
+		CHEESEMAP_CHECK(reinterpret_cast<std::uintptr_t>(externalTileIds) % cm::MapFile::tileIdsAlignment == 0u);
+		CHEESEMAP_CHECK(loadedMap.grids[0u].tileIds.empty());
+	}
+
+	CHEESEMAP_CHECK(loadedMap.textureAtlas == map.textureAtlas);
+	CHEESEMAP_CHECK(loadedMap.textureAtlasPages == map.textureAtlasPages);
+
+	CHEESEMAP_CHECK(loadedMap.tileTemplates.size() == 1u);
+	if (loadedMap.tileTemplates.size() == 1u)
+	{
+		const cm::TileTemplate& tileTemplate{ loadedMap.tileTemplates[0u] };
+		CHEESEMAP_CHECK(tileTemplate.isActive && (tileTemplate.id == 1u) && (tileTemplate.size == sf::Vector2f(32.f, 32.f)) && (tileTemplate.expand == sf::Vector2f(1.f, 2.f)));
+	}
+
+	CHEESEMAP_CHECK(loadedMap.animations.size() == 1u);
+	if (loadedMap.animations.size() == 1u)
+	{
+		const cm::Animation& animation{ loadedMap.animations[0u] };
+		CHEESEMAP_CHECK(animation.id == 1u);
+		CHEESEMAP_CHECK(animation.frames.size() == 2u);
+		if (animation.frames.size() == 2u)
+		{
+			CHEESEMAP_CHECK((animation.frames[0u].id == 0u) && (animation.frames[0u].duration == 0.5f));
+			CHEESEMAP_CHECK((animation.frames[1u].id == 1u) && (animation.frames[1u].duration == 0.25f));
+		}
+	}
+
+	CHEESEMAP_CHECK(loadedMap.layers.size() == 1u);
+	if (loadedMap.layers.size() != 1u)
+		return;
+	const cm::Layer& layer{ loadedMap.layers[0u] };
+	CHEESEMAP_CHECK(layer.zOrder == 1u);
+	CHEESEMAP_CHECK(layer.offset == sf::Vector2f(4.f, -4.f));
+	CHEESEMAP_CHECK(layer.useSpatialIndex);
+	CHEESEMAP_CHECK(layer.tiles.size() == 2u);
+	if (layer.tiles.size() != 2u)
+		return;
+	CHEESEMAP_CHECK(layer.tiles[0u].isActive && !layer.tiles[0u].isTemplate && (layer.tiles[0u].id == 1u));
+	CHEESEMAP_CHECK((layer.tiles[0u].position == sf::Vector2f(24.f, 40.f)) && (layer.tiles[0u].size == sf::Vector2f(16.f, 8.f)));
+	CHEESEMAP_CHECK(layer.tiles[0u].textureTransform.flipX && !layer.tiles[0u].textureTransform.flipY && !layer.tiles[0u].textureTransform.turn);
+	CHEESEMAP_CHECK(!layer.tiles[1u].isActive && layer.tiles[1u].isTemplate && (layer.tiles[1u].id == 0u));
+	CHEESEMAP_CHECK(layer.tiles[1u].position == sf::Vector2f(-8.f, 0.f));
+}
+
+void testTileIdSizeConversion()
+{
+	// a file saved with a different tile id type (made here by rewriting the header's tile id size and the grid's tile ids, which are at the end of the file) is converted into the grid's own tile ids
+	cm::Map map{};
+	setUpMap(map);
+	map.sparseGrids.clear(); // sparse grids' tile ids would also have to be rewritten
+	cm::MapFile::save(map, "MapFileTest.cmf");
+	std::string bytes{};
+	{
+		std::ifstream file("MapFileTest.cmf", std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	constexpr std::uint32_t otherTileIdSize{ (sizeof(cm::TileIdType) == 2u) ? 4u : 2u };
+	const std::vector<cm::TileIdType>& tileIds{ map.grids[0u].tileIds };
+	const std::size_t tileIdsOffset{ bytes.size() - (tileIds.size() * sizeof(cm::TileIdType)) };
+	std::memcpy(&bytes[12u], &otherTileIdSize, sizeof(otherTileIdSize)); // after the identifier and version
+	bytes.resize(tileIdsOffset);
+	for (const cm::TileIdType tileId : tileIds)
+	{
+		if (otherTileIdSize == 2u)
+		{
+			const std::uint16_t otherTileId{ static_cast<std::uint16_t>(tileId) };
+			bytes.append(reinterpret_cast<const char*>(&otherTileId), sizeof(otherTileId));
+		}
+		else
+		{
+			const std::uint32_t otherTileId{ static_cast<std::uint32_t>(tileId) };
+			bytes.append(reinterpret_cast<const char*>(&otherTileId), sizeof(otherTileId));
+		}
+	}
+	{
+		std::ofstream file("MapFileTestConverted.cmf", std::ios::binary | std::ios::trunc);
+		file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	cm::Map loadedMap{};
+	cm::MapFile mapFile{};
+	mapFile.load(loadedMap, "MapFileTestConverted.cmf");
+	checkTileIds(map, loadedMap);
+	if (!loadedMap.grids.empty())
+	{
+		CHEESEMAP_CHECK(loadedMap.grids[0u].externalTileIds == nullptr);
+		CHEESEMAP_CHECK(loadedMap.grids[0u].tileIds == tileIds);
+	}
+	CHEESEMAP_CHECK(loadedMap.layers.size() == 1u);
+}
+
+void testAsyncUpdate()
+{
+	// loading waits for an update that is being built (which may be using the previously loaded file)
+	cm::Map map{};
+	setUpMap(map);
+	cm::MapFile::save(map, "MapFileTest.cmf");
+
+	cm::Map loadedMap{};
+	loadedMap.setAsyncUpdate(true);
+	cm::MapFile mapFile{};
+	mapFile.load(loadedMap, "MapFileTest.cmf");
+	loadedMap.update(sf::View{ { 0.f, 0.f }, { 256.f, 256.f } });
+	mapFile.load(loadedMap, "MapFileTest.cmf");
+	loadedMap.waitForUpdate();
+	CHEESEMAP_CHECK(loadedMap.grids.size() == 1u);
+}
+
+void testTruncatedFile()
+{
+	cm::Map map{};
+	setUpMap(map);
+	cm::MapFile::save(map, "MapFileTest.cmf");
+	{
+		std::ifstream file("MapFileTest.cmf", std::ios::binary);
+		const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		std::ofstream truncatedFile("MapFileTestTruncated.cmf", std::ios::binary);
+		truncatedFile.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2u));
+	}
+
+	cm::Map loadedMap{};
+	cm::MapFile mapFile{};
+	mapFile.load(loadedMap, "MapFileTest.cmf");
+	bool isThrown{ false };
+	try
+	{
+		mapFile.load(loadedMap, "MapFileTestTruncated.cmf");
+	}
+	catch (const cm::Exception&)
+	{
+		isThrown = true;
+	}
+	CHEESEMAP_CHECK(isThrown);
+	CHEESEMAP_CHECK(mapFile.isLoaded());
+	CHEESEMAP_CHECK(loadedMap.sparseGrids.size() == 2u);
+}
+
+} // namespace
+
+int main()
+{
+	testSparseGrids();
+	testRoundTrip();
+	testTileIdSizeConversion();
+	testAsyncUpdate();
+	testTruncatedFile();
+	return cheesemap::test::getResult();
+}
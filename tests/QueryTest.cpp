@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Query Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests that the batched layer queries find the same tiles as the single queries: layers with and without a spatial index (and with depth, offsets, overlapping and inactive tiles)
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+void setUpMap(cm::Map& map)
+{
+	// three layers (the first and last share the highest z order) with tiles that overlap each other. only the last layer has a spatial index
+	std::mt19937 randomGenerator{ 7u };
+	std::uniform_real_distribution<float> positionDistribution{ 0.f, 256.f };
+	std::uniform_real_distribution<float> sizeDistribution{ 4.f, 48.f };
+	const std::size_t zOrders[]{ 1u, 0u, 1u };
+	const float depths[]{ 1.f, 0.5f, 2.f };
+	const sf::Vector2f offsets[]{ { 0.f, 0.f }, { 3.5f, -7.f }, { -16.f, 8.f } };
+	for (std::size_t l{ 0u }; l < 3u; ++l)
+	{
+		cm::Layer layer{};
+		layer.zOrder = zOrders[l];
+		layer.depth = depths[l];
+		layer.offset = offsets[l];
+		layer.useSpatialIndex = (l == 2u);
+		layer.tiles.resize(200u);
+		for (std::size_t t{ 0u }; t < layer.tiles.size(); ++t)
+		{
+			cm::Tile& tile{ layer.tiles[t] };
+			tile.id = 1u;
+			tile.isActive = ((t % 7u) != 0u);
+			tile.position = { positionDistribution(randomGenerator), positionDistribution(randomGenerator) };
+			tile.size = { sizeDistribution(randomGenerator), sizeDistribution(randomGenerator) };
+		}
+		map.layers.push_back(layer);
+	}
+	map.textureAtlas.push_back({ { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlas.push_back({ { 16.f, 0.f }, { 16.f, 16.f } });
+	map.update(sf::View{ { 100.f, 140.f }, { 256.f, 256.f } });
+}
+
+std::vector<sf::Vector2f> getCoords(const cm::Map& map)
+{
+	// random coords (some outside all of the tiles) and the corners of the first layer's tiles (which has no depth or offset)
+	std::vector<sf::Vector2f> coords{};
+	std::mt19937 randomGenerator{ 11u };
+	std::uniform_real_distribution<float> coordDistribution{ -32.f, 320.f };
+	for (std::size_t i{ 0u }; i < 1000u; ++i)
+		coords.push_back({ coordDistribution(randomGenerator), coordDistribution(randomGenerator) });
+	for (const cm::Tile& tile : map.layers[0u].tiles)
+	{
+		coords.push_back(tile.position);
+		coords.push_back(tile.position + tile.size);
+	}
+	return coords;
+}
+
+void testCoords()
+{
+	cm::Map map{};
+	setUpMap(map);
+	const std::vector<sf::Vector2f> coords{ getCoords(map) };
+	std::vector<cm::Map::LayerTileId> layerTileIds{};
+	map.getLayerTileIdsAtLocalCoords(coords.data(), coords.size(), layerTileIds);
+	CHEESEMAP_CHECK(layerTileIds.size() == coords.size());
+	if (layerTileIds.size() != coords.size())
+		return;
+
+	std::size_t numberOfTilesFound{ 0u };
+	for (std::size_t i{ 0u }; i < coords.size(); ++i)
+	{
+		const cm::Map::LayerTileId layerTileId{ map.getLayerTileIdAtLocalCoord(coords[i]) };
+		CHEESEMAP_CHECK(layerTileIds[i].layerIndex == layerTileId.layerIndex);
+		if (layerTileId.layerIndex < map.layers.size())
+		{
+			CHEESEMAP_CHECK(layerTileIds[i].tileIndex == layerTileId.tileIndex);
+			++numberOfTilesFound;
+		}
+	}
+	CHEESEMAP_CHECK((numberOfTilesFound > 0u) && (numberOfTilesFound < coords.size()));
+
+	// no coords
+	map.getLayerTileIdsAtLocalCoords(coords.data(), 0u, layerTileIds);
+	CHEESEMAP_CHECK(layerTileIds.empty());
+}
+
+void testRectangle()
+{
+	// a layer with a spatial index finds the same tiles (in tile order) as it does without one
+	cm::Map map{};
+	setUpMap(map);
+	const sf::FloatRect rectangle{ { 40.f, 60.f }, { 90.f, 50.f } };
+	std::vector<cm::Map::LayerTileId> layerTileIds{};
+	map.getLayerTileIdsInLocalRectangle(rectangle, layerTileIds);
+	map.layers[2u].useSpatialIndex = false;
+	std::vector<cm::Map::LayerTileId> layerTileIdsWithoutSpatialIndex{};
+	map.getLayerTileIdsInLocalRectangle(rectangle, layerTileIdsWithoutSpatialIndex);
+	CHEESEMAP_CHECK(!layerTileIds.empty());
+	CHEESEMAP_CHECK(layerTileIds.size() == layerTileIdsWithoutSpatialIndex.size());
+	if (layerTileIds.size() != layerTileIdsWithoutSpatialIndex.size())
+		return;
+	for (std::size_t i{ 0u }; i < layerTileIds.size(); ++i)
+		CHEESEMAP_CHECK((layerTileIds[i].layerIndex == layerTileIdsWithoutSpatialIndex[i].layerIndex) && (layerTileIds[i].tileIndex == layerTileIdsWithoutSpatialIndex[i].tileIndex));
+}
+
+} // namespace
+
+int main()
+{
+	testCoords();
+	testRectangle();
+	return cheesemap::test::getResult();
+}
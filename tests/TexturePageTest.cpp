@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Texture Page Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests the order of the vertex runs of groups that use more than one texture page: grid cells are grouped by page
+// but tiles that can overlap (layer tiles and expanded grid cells) stay in their order so that later tiles are still drawn on top
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+
+#include <vector>
+
+namespace
+{
+
+struct Run
+{
+	std::size_t texturePage{ 0u };
+	std::vector<std::size_t> quadTiles{};
+};
+
+std::vector<Run> getRuns(const cm::Map& map)
+{
+	std::vector<Run> runs{};
+	map.forEachVertexRun([&](const cm::Map::VertexRun& vertexRun)
+	{
+		Run run{};
+		run.texturePage = vertexRun.texturePage;
+		run.quadTiles.assign(vertexRun.quadTiles, vertexRun.quadTiles + (vertexRun.numberOfVertices / 6u));
+		runs.push_back(run);
+	});
+	return runs;
+}
+
+// ids 0 and 2 are on page 0 and id 1 is on page 1
+void setUpTextureAtlas(cm::Map& map)
+{
+	map.textureAtlas.assign(3u, { { 0.f, 0.f }, { 16.f, 16.f } });
+	map.textureAtlasPages = { 0u, 1u, 0u };
+}
+
+void testOverlappingLayerTiles()
+{
+	// the first tile (on page 1) is under the second tile (on page 0) so page 1 is drawn first. a third tile on page 0 joins the second tile's run
+	for (const bool isChunked : { false, true })
+	{
+		cm::Map map{};
+		setUpTextureAtlas(map);
+		cm::Layer layer{};
+		layer.tiles.resize(3u);
+		layer.tiles[0u].id = 1u;
+		layer.tiles[0u].size = { 16.f, 16.f };
+		layer.tiles[1u].id = 0u;
+		layer.tiles[1u].position = { 8.f, 8.f };
+		layer.tiles[1u].size = { 16.f, 16.f };
+		layer.tiles[2u].id = 2u;
+		layer.tiles[2u].position = { 32.f, 0.f };
+		layer.tiles[2u].size = { 16.f, 16.f };
+		map.layers.push_back(layer);
+		if (isChunked)
+			map.setChunkSize({ 256.f, 256.f });
+		map.update(sf::View{ { 32.f, 32.f }, { 64.f, 64.f } });
+
+		const std::vector<Run> runs{ getRuns(map) };
+		CHEESEMAP_CHECK(runs.size() == 2u);
+		if (runs.size() != 2u)
+			continue;
+		CHEESEMAP_CHECK(runs[0u].texturePage == 1u);
+		CHEESEMAP_CHECK(runs[0u].quadTiles == std::vector<std::size_t>({ 0u }));
+		CHEESEMAP_CHECK(runs[1u].texturePage == 0u);
+		CHEESEMAP_CHECK(runs[1u].quadTiles == std::vector<std::size_t>({ 1u, 2u }));
+	}
+}
+
+void testGridCells()
+{
+	// a row of cells on pages 0, 1, 0, 1 is drawn as one run for each page. if the cells are expanded (so they overlap), they are drawn in order
+	for (const bool isExpanded : { false, true })
+	{
+		cm::Map map{};
+		setUpTextureAtlas(map);
+		cm::Grid grid{};
+		grid.tileSize = { 16.f, 16.f };
+		grid.rowWidth = 4u;
+		grid.invisibleId = 3u;
+		grid.tileIds = { 0u, 1u, 2u, 1u };
+		if (isExpanded)
+			grid.tileExpand = { 1.f, 1.f };
+		map.grids.push_back(grid);
+		map.update(sf::View{ { 32.f, 8.f }, { 64.f, 16.f } });
+
+		const std::vector<Run> runs{ getRuns(map) };
+		if (isExpanded)
+		{
+			CHEESEMAP_CHECK(runs.size() == 4u);
+			for (std::size_t r{ 0u }; (r < runs.size()) && (r < 4u); ++r)
+			{
+				CHEESEMAP_CHECK(runs[r].texturePage == r % 2u);
+				CHEESEMAP_CHECK(runs[r].quadTiles == std::vector<std::size_t>({ r }));
+			}
+			continue;
+		}
+		CHEESEMAP_CHECK(runs.size() == 2u);
+		if (runs.size() != 2u)
+			continue;
+		CHEESEMAP_CHECK(runs[0u].texturePage == 0u);
+		CHEESEMAP_CHECK(runs[0u].quadTiles == std::vector<std::size_t>({ 0u, 2u }));
+		CHEESEMAP_CHECK(runs[1u].texturePage == 1u);
+		CHEESEMAP_CHECK(runs[1u].quadTiles == std::vector<std::size_t>({ 1u, 3u }));
+	}
+}
+
+} // namespace
+
+int main()
+{
+	testOverlappingLayerTiles();
+	testGridCells();
+	return cheesemap::test::getResult();
+}
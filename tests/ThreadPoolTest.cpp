@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Thread Pool Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests that the thread pool runs every task once and that exceptions thrown by tasks (on any thread) are rethrown by run() after the other tasks have stopped
+
+#include "Check.hpp"
+
+#include <CheeseMap/ThreadPool.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+void testEveryTaskRuns()
+{
+	cm::ThreadPool threadPool{ 4u };
+	std::vector<std::atomic<std::size_t>> runs(1000u);
+	threadPool.run(runs.size(), [&](const std::size_t t) { ++runs[t]; });
+	bool isEveryTaskRunOnce{ true };
+	for (const auto& taskRuns : runs)
+		isEveryTaskRunOnce = isEveryTaskRunOnce && (taskRuns == 1u);
+	CHEESEMAP_CHECK(isEveryTaskRunOnce);
+}
+
+void testExceptions()
+{
+	// every task throws so that tasks on the workers and on the calling thread both throw
+	cm::ThreadPool threadPool{ 4u };
+	for (std::size_t r{ 0u }; r < 100u; ++r)
+	{
+		std::atomic<std::size_t> numberOfTasksStarted{ 0u };
+		bool isThrown{ false };
+		try
+		{
+			threadPool.run(1000u, [&](std::size_t)
+			{
+				++numberOfTasksStarted;
+				throw std::runtime_error("task");
+			});
+		}
+		catch (const std::runtime_error&)
+		{
+			isThrown = true;
+		}
+		CHEESEMAP_CHECK(isThrown);
+		CHEESEMAP_CHECK(numberOfTasksStarted <= threadPool.getNumberOfThreads()); // each thread stops after its first task
+	}
+
+	// one task in the middle throws. the pool is still usable afterwards
+	bool isThrown{ false };
+	try
+	{
+		threadPool.run(1000u, [&](const std::size_t t)
+		{
+			if (t == 500u)
+				throw std::runtime_error("task 500");
+		});
+	}
+	catch (const std::runtime_error&)
+	{
+		isThrown = true;
+	}
+	CHEESEMAP_CHECK(isThrown);
+
+	std::atomic<std::size_t> numberOfTasksRun{ 0u };
+	threadPool.run(1000u, [&](std::size_t) { ++numberOfTasksRun; });
+	CHEESEMAP_CHECK(numberOfTasksRun == 1000u);
+}
+
+} // namespace
+
+int main()
+{
+	testEveryTaskRuns();
+	testExceptions();
+	return cheesemap::test::getResult();
+}
@@ -0,0 +1,254 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Cheese Map (https://github.com/Hapaxia/CheeseMap
+// --
+//
+// Tiled Importer Test
+//
+// Copyright(c) 2023-2026 M.J.Silk
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions :
+//
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software.If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// M.J.Silk
+// MJSilk2@gmail.com
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// tests importing the small Tiled maps in tests/maps (TMX and JSON): each encoding and compression of the same 4 x 3 layer, groups and object layers,
+// infinite maps (with a chunk before the origin), every combination of flips and files that fail to import (which leave the map unchanged)
+
+#include "Check.hpp"
+
+#include <CheeseMap.hpp>
+#include <CheeseMap/TiledImporter.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const std::string mapsDirectory{ CHEESEMAP_TEST_MAPS_DIRECTORY };
+const std::vector<cm::TileIdType> layerTileIds{ 1u, 2u, 0u, 1u, 0u, 1u, 2u, 0u, 2u, 0u, 1u, 2u };
+
+bool import(cm::Map& map, const std::string& filename, const std::size_t numberOfThreads = 1u)
+{
+	// returns false (instead of throwing) if the import fails
+	cm::TiledImporter tiledImporter{};
+	tiledImporter.setNumberOfThreads(numberOfThreads);
+	try
+	{
+		tiledImporter.import(map, mapsDirectory + filename);
+	}
+	catch (const cm::Exception&)
+	{
+		return false;
+	}
+	CHEESEMAP_CHECK(tiledImporter.getTilesets().size() == 1u);
+	if (!tiledImporter.getTilesets().empty())
+	{
+		const cm::TiledImporter::Tileset& tileset{ tiledImporter.getTilesets().front() };
+		CHEESEMAP_CHECK(tileset.firstId == 1u);
+		CHEESEMAP_CHECK(tileset.numberOfTiles == 2u);
+		CHEESEMAP_CHECK(tileset.imageSource == mapsDirectory + "tiles.png");
+		CHEESEMAP_CHECK(tileset.imageSize == sf::Vector2f(32.f, 16.f));
+	}
+	return true;
+}
+
+void checkLayer(const cm::Map& map)
+{
+	CHEESEMAP_CHECK(map.textureAtlas.size() == 3u);
+	if (map.textureAtlas.size() == 3u)
+		CHEESEMAP_CHECK(map.textureAtlas[2u] == sf::FloatRect({ 16.f, 0.f }, { 16.f, 16.f }));
+	CHEESEMAP_CHECK(map.grids.size() == 1u);
+	if (map.grids.empty())
+		return;
+	const cm::Grid& grid{ map.grids.front() };
+	CHEESEMAP_CHECK(grid.rowWidth == 4u);
+	CHEESEMAP_CHECK(grid.tileSize == sf::Vector2f(16.f, 16.f));
+	CHEESEMAP_CHECK(grid.tileIds == layerTileIds);
+	CHEESEMAP_CHECK(grid.tileTextureTransforms.empty());
+}
+
+void testEncodings()
+{
+	for (const char* const filename : { "csv.tmx", "base64.tmx", "zlib.tmx", "gzip.tmx", "xml.tmx", "csv.tmj", "base64.tmj", "zlib.tmj", "gzip.tmj" })
+	{
+		cm::Map map{};
+		CHEESEMAP_CHECK(import(map, filename));
+		checkLayer(map);
+	}
+
+	// zstd is only supported if CHEESEMAP_USE_ZSTD is defined
+	for (const char* const filename : { "zstd.tmx", "zstd.tmj" })
+	{
+		cm::Map map{};
+#ifdef CHEESEMAP_USE_ZSTD
+		CHEESEMAP_CHECK(import(map, filename));
+		checkLayer(map);
+#else // CHEESEMAP_USE_ZSTD
+		CHEESEMAP_CHECK(!import(map, filename));
+#endif // CHEESEMAP_USE_ZSTD
+	}
+}
+
+void testLayers()
+{
+	// a tile layer in a group (offset by the group) with a tint colour and opacity, followed by a hidden object layer containing two tile objects (the other object isn't a tile)
+	for (const char* const filename : { "layers.tmx", "layers.tmj" })
+	{
+		cm::Map map{};
+		CHEESEMAP_CHECK(import(map, filename));
+		CHEESEMAP_CHECK(map.grids.size() == 1u);
+		CHEESEMAP_CHECK(map.layers.size() == 1u);
+		if ((map.grids.size() != 1u) || (map.layers.size() != 1u))
+			continue;
+
+		const cm::Grid& grid{ map.grids.front() };
+		CHEESEMAP_CHECK(grid.tileIds == layerTileIds);
+		CHEESEMAP_CHECK(grid.position == sf::Vector2f(8.f, 4.f));
+		CHEESEMAP_CHECK(grid.color == sf::Color(255u, 128u, 0u, 127u));
+		CHEESEMAP_CHECK(grid.zOrder == 0u);
+
+		const cm::Layer& layer{ map.layers.front() };
+		CHEESEMAP_CHECK(!layer.isActive);
+		CHEESEMAP_CHECK(layer.zOrder == 1u);
+		CHEESEMAP_CHECK(layer.offset == sf::Vector2f(-2.f, 0.f));
+		CHEESEMAP_CHECK(layer.tiles.size() == 2u);
+		if (layer.tiles.size() != 2u)
+			continue;
+
+		// tile objects are positioned by their bottom-left corner and are the size of their tileset's tiles unless they are given a size
+		CHEESEMAP_CHECK(layer.tiles[0u].id == 2u);
+		CHEESEMAP_CHECK(layer.tiles[0u].position == sf::Vector2f(8.f, 24.f));
+		CHEESEMAP_CHECK(layer.tiles[0u].size == sf::Vector2f(16.f, 16.f));
+		CHEESEMAP_CHECK(layer.tiles[1u].id == 1u);
+		CHEESEMAP_CHECK(layer.tiles[1u].position == sf::Vector2f(32.f, 24.f));
+		CHEESEMAP_CHECK(layer.tiles[1u].size == sf::Vector2f(32.f, 8.f));
+		CHEESEMAP_CHECK(layer.tiles[1u].textureTransform.flipX);
+		CHEESEMAP_CHECK(!layer.tiles[1u].textureTransform.flipY);
+		CHEESEMAP_CHECK(!layer.tiles[1u].textureTransform.turn);
+	}
+}
+
+void testInfinite()
+{
+	// chunks at (-16, -16) and (16, 0): the grid covers both (48 x 32 cells), starting at the first chunk
+	for (const char* const filename : { "infinite.tmx", "infinite.tmj" })
+	{
+		for (const std::size_t numberOfThreads : { 1u, 2u })
+		{
+			cm::Map map{};
+			CHEESEMAP_CHECK(import(map, filename, numberOfThreads));
+			CHEESEMAP_CHECK(map.grids.size() == 1u);
+			if (map.grids.empty())
+				continue;
+
+			const cm::Grid& grid{ map.grids.front() };
+			CHEESEMAP_CHECK(grid.rowWidth == 48u);
+			CHEESEMAP_CHECK(grid.tileIds.size() == 48u * 32u);
+			CHEESEMAP_CHECK(grid.position == sf::Vector2f(-256.f, -256.f));
+			if (grid.tileIds.size() != 48u * 32u)
+				continue;
+			std::vector<cm::TileIdType> tileIds(48u * 32u, 0u);
+			tileIds[0u] = 1u;
+			tileIds[(15u * 48u) + 15u] = 2u;
+			tileIds[(17u * 48u) + 33u] = 2u;
+			CHEESEMAP_CHECK(grid.tileIds == tileIds);
+		}
+	}
+}
+
+void testFlips()
+{
+	// tile 2 with each combination of Tiled's flags (x is 4 for horizontal + 2 for vertical + 1 for diagonal). Tiled flips diagonally (swapping x and y) first and then horizontally and vertically
+	// so the corner of a tile at (x, y) (each 0 or 1) shows the texture at (x, y) flipped vertically and horizontally (back) and then swapped
+	for (const char* const filename : { "flips.tmx", "flips.tmj" })
+	{
+		cm::Map map{};
+		CHEESEMAP_CHECK(import(map, filename));
+		CHEESEMAP_CHECK(map.grids.size() == 1u);
+		if (map.grids.empty())
+			continue;
+		CHEESEMAP_CHECK(map.grids.front().tileTextureTransforms.size() == 7u);
+
+		std::vector<sf::Vertex> vertices{};
+		map.build(sf::View{ { 64.f, 8.f }, { 128.f, 16.f } }, vertices);
+		CHEESEMAP_CHECK(vertices.size() == 8u * 6u);
+		for (std::size_t v{ 0u }; v < vertices.size(); ++v)
+		{
+			// each tile is two triangles (6 vertices). tiles are found from their left edge since neighbouring tiles share corners
+			float left{ vertices[v].position.x };
+			for (std::size_t t{ v - (v % 6u) }; t < v - (v % 6u) + 6u; ++t)
+				left = std::min(left, vertices[t].position.x);
+			const std::size_t flags{ static_cast<std::size_t>(left / 16.f) };
+			const sf::Vertex& vertex{ vertices[v] };
+			const sf::Vector2f corner{ (vertex.position.x - left) / 16.f, vertex.position.y / 16.f };
+			sf::Vector2f textureCorner{ ((flags & 4u) != 0u) ? 1.f - corner.x : corner.x, ((flags & 2u) != 0u) ? 1.f - corner.y : corner.y };
+			if ((flags & 1u) != 0u)
+				textureCorner = { textureCorner.y, textureCorner.x };
+			const bool isMatch{ vertex.texCoords == sf::Vector2f(16.f + (textureCorner.x * 16.f), textureCorner.y * 16.f) };
+			CHEESEMAP_CHECK(isMatch);
+			if (!isMatch)
+				std::fprintf(stderr, "flags %zu: corner (%g, %g) has texture coordinates (%g, %g)\n", flags, corner.x, corner.y, vertex.texCoords.x, vertex.texCoords.y);
+		}
+	}
+}
+
+void testInvalidFiles()
+{
+	// a truncated zlib stream, a corrupt deflate stream (in gzip), data that inflates to more than its layer, checksums that don't match,
+	// a layer that is larger than the maximum number of cells, chunks that overflow and a missing file all throw and leave the map unchanged
+	cm::Map map{};
+	CHEESEMAP_CHECK(import(map, "csv.tmx"));
+	for (const char* const filename : { "truncated.tmx", "corrupt.tmx", "inflated.tmx", "adler32.tmx", "crc32.tmx", "large.tmx", "overflow.tmx", "missing.tmx" })
+	{
+		CHEESEMAP_CHECK(!import(map, filename));
+		checkLayer(map);
+	}
+}
+
+void testAsyncUpdate()
+{
+	// importing waits for an update that is being built (which may be using the previous import)
+	cm::Map map{};
+	map.setAsyncUpdate(true);
+	CHEESEMAP_CHECK(import(map, "zlib.tmx"));
+	map.update(sf::View{ { 32.f, 24.f }, { 64.f, 48.f } });
+	CHEESEMAP_CHECK(import(map, "infinite.tmx", 2u));
+	map.waitForUpdate();
+	CHEESEMAP_CHECK(map.grids.size() == 1u);
+}
+
+} // namespace
+
+int main()
+{
+	testEncodings();
+	testLayers();
+	testInfinite();
+	testFlips();
+	testInvalidFiles();
+	testAsyncUpdate();
+	return cheesemap::test::getResult();
+}